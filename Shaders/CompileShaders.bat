@@ -8,5 +8,8 @@ glslc D:\cProjects\SmallVkEngine\Shaders\cubeShadow.vert -o D:\cProjects\SmallVk
 glslc D:\cProjects\SmallVkEngine\Shaders\cubeShadow.frag -o D:\cProjects\SmallVkEngine\Shaders\cubeShadow.frag.spv
 glslc D:\cProjects\SmallVkEngine\Shaders\Skybox.vert -o D:\cProjects\SmallVkEngine\Shaders\Skybox.ver.spv
 glslc D:\cProjects\SmallVkEngine\Shaders\Skybox.frag -o D:\cProjects\SmallVkEngine\Shaders\Skybox.frag.spv
+glslc D:\cProjects\SmallVkEngine\Shaders\cubeShadowMultiview.vert -o D:\cProjects\SmallVkEngine\Shaders\cubeShadowMultiview.ver.spv
+glslc D:\cProjects\SmallVkEngine\Shaders\defaultIndirect.vert -o D:\cProjects\SmallVkEngine\Shaders\defaultIndirect.vert.spv
+glslc D:\cProjects\SmallVkEngine\Shaders\defaultBindless.frag -o D:\cProjects\SmallVkEngine\Shaders\defaultBindless.frag.spv
 
 pause
\ No newline at end of file
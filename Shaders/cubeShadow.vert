@@ -8,11 +8,18 @@ layout (set = 0, binding = 0) uniform ViewProjection {
     mat4 view;
 } viewProjection;
 
-layout (push_constant) uniform Model {
+struct ObjectData {
     mat4 model;
-} model;
+    uint pickId;
+    uint textureIndex;
+};
+
+// Copies of a geometry are the instances of one draw.
+layout (std430, set = 1, binding = 0) readonly buffer InstanceBuffer {
+    ObjectData instances[];
+} instanceBuffer;
 void main() {
-    vec4 worldPos = model.model * vec4(pos, 1.0);
+    vec4 worldPos = instanceBuffer.instances[gl_InstanceIndex].model * vec4(pos, 1.0);
     vWorldPos = worldPos.xyz;
     gl_Position = viewProjection.projection * viewProjection.view * worldPos;
 }
\ No newline at end of file
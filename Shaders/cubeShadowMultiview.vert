@@ -0,0 +1,27 @@
+#version 450
+#extension GL_EXT_multiview : require
+
+layout (location = 0) in vec3 pos;
+layout (location = 0) out vec3 vWorldPos;
+
+// All six cube face views, the face is selected by the multiview view index.
+layout (set = 0, binding = 0) uniform CubeViewProjection {
+    mat4 projection;
+    mat4 view[6];
+} viewProjection;
+
+struct ObjectData {
+    mat4 model;
+    uint pickId;
+    uint textureIndex;
+};
+
+// Copies of a geometry are the instances of one draw.
+layout (std430, set = 1, binding = 0) readonly buffer InstanceBuffer {
+    ObjectData instances[];
+} instanceBuffer;
+void main() {
+    vec4 worldPos = instanceBuffer.instances[gl_InstanceIndex].model * vec4(pos, 1.0);
+    vWorldPos = worldPos.xyz;
+    gl_Position = viewProjection.projection * viewProjection.view[gl_ViewIndex] * worldPos;
+}
\ No newline at end of file
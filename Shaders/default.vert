@@ -9,7 +9,7 @@ vec2(0.5, 0)
 layout (location = 0) in vec3 pos;
 layout (location = 1) in vec4 color;
 layout (location = 2) in vec2 uv;
-layout (location = 3) in vec3 normals;
+layout (location = 3) in vec2 octahedralNormal;
 layout (location = 4) out vec3 vWorldPos;
 layout (location = 5) out vec3 vPos;
 layout (location = 6) flat out uint vPickId;
@@ -19,28 +19,38 @@ layout (set = 0, binding = 0) uniform ViewProjection {
     mat4 view;
 } vp;
 
-layout (set = 0, binding = 1) uniform ModelUBO {
+struct ObjectData {
     mat4 model;
     uint pickId;
-} model;
+    uint textureIndex;
+};
+
+// Objects sharing a geometry are the instances of one draw, firstInstance selects the first one.
+layout (std430, set = 6, binding = 0) readonly buffer InstanceBuffer {
+    ObjectData instances[];
+} instanceBuffer;
 
 layout (location = 0) out vec4 vColor;
 layout (location = 1) out vec2 textureCoords;
 layout (location = 2) out vec3 vNormals;
 
-layout (push_constant) uniform ModelPush {
-    mat4 model;
-} modelPush;
+// Inverse of the octahedral encoding of the geometry arena.
+vec3 DecodeOctahedral(vec2 encoded) {
+    vec3 normal = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+    float fold = max(-normal.z, 0.0);
+    normal.xy += vec2(normal.x >= 0.0 ? -fold : fold, normal.y >= 0.0 ? -fold : fold);
+    return normalize(normal);
+}
 
 void main() {
-    vec4 worldPos = model.model * vec4(pos, 1.0);
+    ObjectData instance = instanceBuffer.instances[gl_InstanceIndex];
+    vec4 worldPos = instance.model * vec4(pos, 1.0);
     gl_Position = vp.projection * vp.view * worldPos;
     vColor = color;
     textureCoords = uv;
-    vNormals = normals;
     vWorldPos = worldPos.xyz;
 
-    vNormals = mat3(transpose(inverse(modelPush.model))) * normals;
+    vNormals = mat3(transpose(inverse(instance.model))) * DecodeOctahedral(octahedralNormal);
     vPos = pos;
-    vPickId = model.pickId;
+    vPickId = instance.pickId;
 }
\ No newline at end of file
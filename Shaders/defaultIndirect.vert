@@ -0,0 +1,52 @@
+#version 450
+
+layout (location = 0) in vec3 pos;
+layout (location = 1) in vec4 color;
+layout (location = 2) in vec2 uv;
+layout (location = 3) in vec2 octahedralNormal;
+layout (location = 4) out vec3 vWorldPos;
+layout (location = 5) out vec3 vPos;
+layout (location = 6) flat out uint vPickId;
+layout (location = 7) flat out uint vTextureIndex;
+
+layout (set = 0, binding = 0) uniform ViewProjection {
+    mat4 projection;
+    mat4 view;
+} vp;
+
+struct ObjectData {
+    mat4 model;
+    uint pickId;
+    uint textureIndex;
+};
+
+// One element per indirect draw, selected by the firstInstance of the draw command.
+layout (std430, set = 6, binding = 0) readonly buffer ObjectBuffer {
+    ObjectData objects[];
+} objectBuffer;
+
+layout (location = 0) out vec4 vColor;
+layout (location = 1) out vec2 textureCoords;
+layout (location = 2) out vec3 vNormals;
+
+// Inverse of the octahedral encoding of the geometry arena.
+vec3 DecodeOctahedral(vec2 encoded) {
+    vec3 normal = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+    float fold = max(-normal.z, 0.0);
+    normal.xy += vec2(normal.x >= 0.0 ? -fold : fold, normal.y >= 0.0 ? -fold : fold);
+    return normalize(normal);
+}
+
+void main() {
+    ObjectData object = objectBuffer.objects[gl_InstanceIndex];
+    vec4 worldPos = object.model * vec4(pos, 1.0);
+    gl_Position = vp.projection * vp.view * worldPos;
+    vColor = color;
+    textureCoords = uv;
+    vWorldPos = worldPos.xyz;
+
+    vNormals = mat3(transpose(inverse(object.model))) * DecodeOctahedral(octahedralNormal);
+    vPos = pos;
+    vPickId = object.pickId;
+    vTextureIndex = object.textureIndex;
+}
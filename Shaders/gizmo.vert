@@ -1,7 +1,7 @@
 #version 450
 
 layout (location = 0) in vec3 pos;
-layout (location = 1) in vec4 color;
+// uv.x holds the axis, 1 for X, 2 for Y and 3 for Z.
 layout (location = 2) in vec2 uv;
 
 layout (location = 0) out vec4 vColor;
@@ -16,10 +16,14 @@ layout (push_constant) uniform Model {
     mat4 model;
     uint pickId;
 } model;
+
+const vec4 axisColors[3] = vec4[](vec4(1.0, 0.2, 0.2, 1.0), vec4(0.2, 1.0, 0.2, 1.0), vec4(0.2, 0.2, 1.0, 1.0));
+
 void main() {
     // The model matrix has to be without rotation or scaling.
     gl_Position = viewProjection.projection * viewProjection.view * model.model * vec4(pos, 1.0);
-    vColor = color;
-    vId = uint(uv.x);
+    uint axis = uint(uv.x + 0.5);
+    vColor = axisColors[axis - 1u];
+    vId = axis * 1001u;
     vPickId = model.pickId;
 }
\ No newline at end of file
@@ -7,10 +7,18 @@ layout (set = 0, binding = 0) uniform ViewProjection {
     mat4 view;
 } viewProjection;
 
-layout (push_constant) uniform Model {
+struct ObjectData {
     mat4 model;
-} model;
+    uint pickId;
+    uint textureIndex;
+};
+
+// Copies of a geometry are the instances of one draw.
+layout (std430, set = 1, binding = 0) readonly buffer InstanceBuffer {
+    ObjectData instances[];
+} instanceBuffer;
 void main() {
-    gl_Position = viewProjection.projection * viewProjection.view * model.model * vec4(pos, 1);
+    mat4 model = instanceBuffer.instances[gl_InstanceIndex].model;
+    gl_Position = viewProjection.projection * viewProjection.view * model * vec4(pos, 1);
     vPos = pos;
 }
\ No newline at end of file
@@ -19,12 +19,15 @@ namespace vk {
         List<rn::Vertex> mVertexList;
         List<std::uint32_t> mIndexList;
         rn::StaticMesh *mStaticMesh;
+        rn::MeshHandle mMeshHandle{};
         std::string mTextureId;
         bool mCalculateNormals;
+        bool mGenerateLods;
         GizmoDragController gizmoDragController{};
     public:
         MeshComponent(GameObject *gameObject, const std::string &id, List<rn::Vertex> &vertices,
-                      List<std::uint32_t> &indices, std::string textureId = "", bool calculateNormals = false);
+                      List<std::uint32_t> &indices, std::string textureId = "", bool calculateNormals = false,
+                      bool generateLods = false);
 
         ~MeshComponent();
 
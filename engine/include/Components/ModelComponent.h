@@ -11,6 +11,7 @@
 
 #include "Component.h"
 #include "Core/Constants.h"
+#include "MeshOptimizer.h"
 
 
 namespace vk {
@@ -21,6 +22,25 @@ namespace vk {
         List<std::shared_ptr<class MeshComponent>> mMeshCompList{};
         List<std::string> mTextureNames{};
         List<std::shared_ptr<class TextureComponent>> mTextures{};
+        // Sums over the meshes of a model, the ACMR and ATVR of the whole model are ratios of them.
+        struct CacheTotals {
+            double invocations = 0.0;
+            double referencedVertices = 0.0;
+            double triangles = 0.0;
+
+            void Add(const rn::VertexCacheStatistics &statistics, size_t triangleCount);
+
+            void Add(const CacheTotals &totals);
+        };
+        CacheTotals mCacheBefore{};
+        CacheTotals mCacheAfter{};
+        double mOptimizationMilliseconds = 0.0;
+
+        // Triangulated vertices and indices of an imported mesh in the order of the file.
+        static void ReadMesh(const aiMesh *mesh, List<rn::Vertex> &vertices, List<std::uint32_t> &indices);
+
+        static void LogCacheTotals(const std::string &fileName, const CacheTotals &before, const CacheTotals &after,
+                                   double milliseconds);
 
     public:
         ModelComponent(class GameObject *gameObject, const std::string &id, const std::string &objectFile);
@@ -44,6 +64,9 @@ namespace vk {
         const std::uint32_t GetMeshCount() const {
             return mMeshCompList.size();
         }
+
+        // Logs the ACMR and ATVR of every .obj below the directory before and after the MeshOptimizer.
+        static void BenchmarkMeshOptimization(const std::string &directory);
     };
 }
 #endif //SMALLVKENGINE_MODELCOMPONENT_H
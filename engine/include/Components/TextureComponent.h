@@ -12,7 +12,7 @@ namespace vk {
     class TextureComponent : public Component {
     protected:
         std::string textureId;
-        rn::Texture *mTexture;
+        rn::TextureHandle mTexture;
         rn::RendererContext *mCtx;
 
     public:
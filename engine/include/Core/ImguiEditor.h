@@ -25,6 +25,8 @@ namespace vk {
 
         void SetupInspectorWindow();
 
+        void SetupStatisticsWindow();
+
     public:
         static ImguiEditor *GetInstance(rn::RendererContext *ctx);
 
@@ -13,7 +13,7 @@ namespace vk {
         std::string mStringId;
         rn::RendererContext *mCtx;
         rn::PointLightInfo mLightInfo{};
-        std::uint32_t mLightId = -1;
+        rn::LightHandle mLight{};
     public:
         PointLight(Scene *scene, std::uint32_t pickId, const std::string &stringId,
                    const rn::PointLightInfo &mLightInfo);
@@ -15,12 +15,14 @@
 
 namespace vk {
     MeshComponent::MeshComponent(vk::GameObject *gameObject, const std::string &id, List<rn::Vertex> &vertices,
-                                 List<std::uint32_t> &indices, std::string textureId, bool calculateNormals)
+                                 List<std::uint32_t> &indices, std::string textureId, bool calculateNormals,
+                                 bool generateLods)
             : Component(gameObject, id), mVertexList{vertices}, mIndexList{indices},
-              mTextureId{std::move(textureId)}, mCalculateNormals{calculateNormals} {
+              mTextureId{std::move(textureId)}, mCalculateNormals{calculateNormals}, mGenerateLods{generateLods} {
     }
 
     MeshComponent::~MeshComponent() {
+        Component::ctx->UnregisterMesh(mMeshHandle);
         delete mStaticMesh;
     }
 
@@ -36,14 +38,14 @@ namespace vk {
             }
         }
         mStaticMesh = new rn::StaticMesh{*Component::ctx, mVertexList, mIndexList, mOwningGameObject->GetPickId(),
-                                         mTextureId, mCalculateNormals};
+                                         mTextureId, mCalculateNormals, mGenerateLods};
         // Register the object with the Rendering Context for the Graphics context
         std::shared_ptr<TransformComponent> transformComponent = mOwningGameObject->GetComponentType<TransformComponent>();
         if (transformComponent != nullptr) {
             mStaticMesh->SetModelMatrix(transformComponent->GetModelMatrix());
         }
 
-        Component::ctx->RegisterMesh(id, mStaticMesh);
+        mMeshHandle = Component::ctx->RegisterMesh(mStaticMesh);
         ImguiEditor::GetInstance(ctx)->GetGuiViewportDelegate()->Register(this, &MeshComponent::ViewportKeyHandler);
     }
 
@@ -2,6 +2,7 @@
 // Created by ghima on 14-09-2025.
 //
 #include <fstream>
+#include <filesystem>
 #include <Components/TransformComponent.h>
 
 #include "Components/ModelComponent.h"
@@ -47,10 +48,85 @@ namespace vk {
         }
         // Loading the textures;
         LoadTextureMaterials(scene, mTextures, mTextureNames);
+        mCacheBefore = CacheTotals{};
+        mCacheAfter = CacheTotals{};
+        mOptimizationMilliseconds = 0.0;
         LoadNode(scene->mRootNode, scene, mMeshCompList);
+        if (rn::OPTIMIZE_IMPORTED_MESHES) {
+            LogCacheTotals(fileName, mCacheBefore, mCacheAfter, mOptimizationMilliseconds);
+        }
         return true;
     }
 
+    void ModelComponent::CacheTotals::Add(const rn::VertexCacheStatistics &statistics, size_t triangleCount) {
+        double meshInvocations = statistics.acmr * static_cast<double>(triangleCount);
+        invocations += meshInvocations;
+        referencedVertices += statistics.atvr > 0.0f ? meshInvocations / statistics.atvr : 0.0;
+        triangles += static_cast<double>(triangleCount);
+    }
+
+    void ModelComponent::CacheTotals::Add(const CacheTotals &totals) {
+        invocations += totals.invocations;
+        referencedVertices += totals.referencedVertices;
+        triangles += totals.triangles;
+    }
+
+    void ModelComponent::LogCacheTotals(const std::string &fileName, const CacheTotals &before,
+                                        const CacheTotals &after, double milliseconds) {
+        if (before.triangles == 0.0) {
+            return;
+        }
+        LOG_INFO("Mesh optimization {} : {} triangles, ACMR {:.3f} -> {:.3f}, ATVR {:.3f} -> {:.3f}, {:.2f} ms",
+                 fileName, static_cast<std::uint64_t>(before.triangles), before.invocations / before.triangles,
+                 after.invocations / after.triangles, before.invocations / before.referencedVertices,
+                 after.invocations / after.referencedVertices, milliseconds);
+    }
+
+    void ModelComponent::BenchmarkMeshOptimization(const std::string &directory) {
+        std::error_code error{};
+        std::filesystem::recursive_directory_iterator iterator{directory, error};
+        if (error) {
+            LOG_WARN("Mesh optimization benchmark can not read {}", directory);
+            return;
+        }
+        CacheTotals allBefore{};
+        CacheTotals allAfter{};
+        double allMilliseconds = 0.0;
+        List<rn::Vertex> vertices{};
+        List<std::uint32_t> indices{};
+        for (const std::filesystem::directory_entry &entry: iterator) {
+            if (!entry.is_regular_file() || entry.path().extension() != ".obj") {
+                continue;
+            }
+            // Same import as LoadModel, without the textures and the upload.
+            Assimp::Importer importer;
+            const aiScene *scene = importer.ReadFile(entry.path().string(), aiProcess_Triangulate |
+                                                                            aiProcess_FlipUVs |
+                                                                            aiProcess_JoinIdenticalVertices);
+            if (!scene) {
+                LOG_WARN("Mesh optimization benchmark failed to load {}", entry.path().string());
+                continue;
+            }
+            CacheTotals before{};
+            CacheTotals after{};
+            double milliseconds = 0.0;
+            for (size_t i = 0; i < scene->mNumMeshes; i++) {
+                ReadMesh(scene->mMeshes[i], vertices, indices);
+                std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+                rn::MeshOptimizationReport report = rn::MeshOptimizer::Optimize(vertices, indices);
+                std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+                milliseconds += elapsed.count();
+                before.Add(report.before, indices.size() / 3);
+                after.Add(report.after, indices.size() / 3);
+            }
+            LogCacheTotals(entry.path().filename().string(), before, after, milliseconds);
+            allBefore.Add(before);
+            allAfter.Add(after);
+            allMilliseconds += milliseconds;
+        }
+        LogCacheTotals(directory, allBefore, allAfter, allMilliseconds);
+    }
+
     void ModelComponent::LoadTextureMaterials(const aiScene *scene,
                                               List<std::shared_ptr<class TextureComponent>> &textureList,
                                               List<std::string> &textureNames) {
@@ -92,6 +168,33 @@ namespace vk {
     void ModelComponent::LoadMesh(aiMesh *mesh, List<std::shared_ptr<MeshComponent>> &meshList) {
         List<rn::Vertex> vertices{};
         List<std::uint32_t> indices{};
+        ReadMesh(mesh, vertices, indices);
+        if (rn::OPTIMIZE_IMPORTED_MESHES) {
+            std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+            rn::MeshOptimizationReport report = rn::MeshOptimizer::Optimize(vertices, indices);
+            std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+            mOptimizationMilliseconds += elapsed.count();
+            mCacheBefore.Add(report.before, indices.size() / 3);
+            mCacheAfter.Add(report.after, indices.size() / 3);
+        }
+        // Getting the texture id;
+        std::string textureId = mTextureNames[mesh->mMaterialIndex];
+        if (textureId.empty()) {
+            textureId = mTextureNames[0];
+        };
+        char buffer[100]{'\0'};
+        std::sprintf(buffer, "%s-mesh-%zu", id.c_str(), mMeshCompList.size() + 1);
+
+        std::string texId = R"(D:\cProjects\SmallVkEngine\textures\colormap.png)";
+        std::shared_ptr<MeshComponent> meshComponent = mOwningGameObject->SpawnComponent<MeshComponent>(
+                std::string{buffer}, vertices,
+                indices, texId, true, true);
+        meshList.push_back(meshComponent);
+    }
+
+    void ModelComponent::ReadMesh(const aiMesh *mesh, List<rn::Vertex> &vertices, List<std::uint32_t> &indices) {
+        vertices.clear();
+        indices.clear();
         vertices.resize(mesh->mNumVertices);
 
         for (int i = 0; i < mesh->mNumVertices; i++) {
@@ -111,19 +214,6 @@ namespace vk {
                 indices.push_back(face.mIndices[j]);
             }
         }
-        // Getting the texture id;
-        std::string textureId = mTextureNames[mesh->mMaterialIndex];
-        if (textureId.empty()) {
-            textureId = mTextureNames[0];
-        };
-        char buffer[100]{'\0'};
-        std::sprintf(buffer, "%s-mesh-%zu", id.c_str(), mMeshCompList.size() + 1);
-
-        std::string texId = R"(D:\cProjects\SmallVkEngine\textures\colormap.png)";
-        std::shared_ptr<MeshComponent> meshComponent = mOwningGameObject->SpawnComponent<MeshComponent>(
-                std::string{buffer}, vertices,
-                indices, texId, true);
-        meshList.push_back(meshComponent);
     }
 
     const std::shared_ptr<MeshComponent> ModelComponent::GetMeshComponent(std::uint32_t index) const {
@@ -6,8 +6,7 @@
 namespace vk {
     TextureComponent::TextureComponent(vk::GameObject *ownerGameObject, const std::string &textureId,
                                        rn::RendererContext *ctx) : Component(ownerGameObject, textureId), mCtx{ctx},
-                                                                   textureId{textureId}, mTexture{
-                    nullptr} {
+                                                                   textureId{textureId}, mTexture{} {
 
     }
 
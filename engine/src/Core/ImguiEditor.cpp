@@ -36,6 +36,7 @@ namespace vk {
         Logger::GetInstance()->SetUpLogConsole();
         SetupViewport();
         SetupInspectorWindow();
+        SetupStatisticsWindow();
         ImGui::Render();
     }
 
@@ -77,4 +78,39 @@ namespace vk {
         mGuiInspectorDelegate->Invoke();
         ImGui::End();
     }
+
+    void ImguiEditor::SetupStatisticsWindow() {
+        ImGui::Begin("Statistics");
+        const rn::LodStatistics *statistics = mCtx->GetLodStatistics();
+        // The shadow LODs are the scene LODs shifted by the bias, so a mesh can show up in two different rows.
+        if (ImGui::BeginTable("Lods", 5, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
+            ImGui::TableSetupColumn("LOD");
+            ImGui::TableSetupColumn("Scene Objects");
+            ImGui::TableSetupColumn("Scene Triangles");
+            ImGui::TableSetupColumn("Shadow Objects");
+            ImGui::TableSetupColumn("Shadow Triangles");
+            ImGui::TableHeadersRow();
+            std::uint64_t sceneTriangles = 0;
+            std::uint64_t shadowTriangles = 0;
+            for (std::uint32_t lod = 0; lod < rn::MAX_MESH_LODS; lod++) {
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::Text("%u", lod);
+                ImGui::TableNextColumn();
+                ImGui::Text("%u", statistics->sceneObjects[lod]);
+                ImGui::TableNextColumn();
+                ImGui::Text("%llu", static_cast<unsigned long long>(statistics->sceneTriangles[lod]));
+                ImGui::TableNextColumn();
+                ImGui::Text("%u", statistics->shadowObjects[lod]);
+                ImGui::TableNextColumn();
+                ImGui::Text("%llu", static_cast<unsigned long long>(statistics->shadowTriangles[lod]));
+                sceneTriangles += statistics->sceneTriangles[lod];
+                shadowTriangles += statistics->shadowTriangles[lod];
+            }
+            ImGui::EndTable();
+            ImGui::Text("Scene triangles: %llu", static_cast<unsigned long long>(sceneTriangles));
+            ImGui::Text("Shadow triangles per view: %llu", static_cast<unsigned long long>(shadowTriangles));
+        }
+        ImGui::End();
+    }
 }
\ No newline at end of file
@@ -91,6 +91,24 @@ namespace vk {
             glfwSetWindowShouldClose(window, true);
             thisWindow->DeleteGraphics();
         }
+        if (key == GLFW_KEY_F7 && action == GLFW_PRESS) {
+            ModelComponent::BenchmarkMeshOptimization(R"(D:\cProjects\SmallVkEngine\models)");
+        }
+        if (key == GLFW_KEY_F8 && action == GLFW_PRESS) {
+            thisWindow->mGraphics->BenchmarkTextureSampling();
+        }
+        if (key == GLFW_KEY_F9 && action == GLFW_PRESS) {
+            thisWindow->mGraphics->BenchmarkSceneRecording();
+        }
+        if (key == GLFW_KEY_F10 && action == GLFW_PRESS) {
+            thisWindow->mGraphics->LogMemoryStatistics();
+        }
+        if (key == GLFW_KEY_F11 && action == GLFW_PRESS) {
+            thisWindow->mGraphics->ToggleDrawSorting();
+        }
+        if (key == GLFW_KEY_F12 && action == GLFW_PRESS) {
+            thisWindow->mGraphics->LogDrawStatistics();
+        }
         InputSystem::GetInstance()->KeyInputHandler(key, code, action, mode);
     }
 
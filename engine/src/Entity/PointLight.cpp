@@ -16,8 +16,8 @@ namespace vk {
     }
 
     void PointLight::BeginPlay() {
-        mLightId = mCtx->AddPointLight(mLightInfo);
-        if (mLightId == -1) {
+        mLight = mCtx->AddPointLight(mLightInfo);
+        if (!mLight.IsValid()) {
             Logger::GetInstance()->WriteLog({LogType::ERROR, "Max Point Lights Reached Cant add more"});
             return;
         }
@@ -60,7 +60,7 @@ namespace vk {
                     4, 5, 1, 4, 1, 0
             };
 
-            std::string meshId = &"Point Light Mesh "[mLightId];
+            std::string meshId = "Point Light Mesh " + std::to_string(mLight.index);
             SpawnComponent<TextureComponent>(R"(D:\cProjects\SmallVkEngine\textures\default.jpg)", mCtx);
             SpawnComponent<MeshComponent>(meshId, cubeVertices, cubeIndices, "", true);
         }
@@ -70,7 +70,7 @@ namespace vk {
     void PointLight::Tick(float delta) {
         std::shared_ptr<TransformComponent> transformComponent = GetComponentType<TransformComponent>();
         mLightInfo.position = glm::vec4(transformComponent->GetPosition(), 1.0);
-        mCtx->UpdateLightInfoPosition(mLightInfo.position, mLightId);
+        mCtx->UpdateLightInfoPosition(mLightInfo.position, mLight);
         GameObject::Tick(delta);
     }
 }
\ No newline at end of file
@@ -0,0 +1,50 @@
+//
+// Created by ghima on 22-10-2025.
+//
+
+#ifndef SMALLVKENGINE_BINDLESSTEXTURETABLE_H
+#define SMALLVKENGINE_BINDLESSTEXTURETABLE_H
+
+#include "Utility.h"
+
+namespace rn {
+    // Update after bind sampler2D array every scene texture keeps a slot in, bound once per frame.
+    class BindlessTextureTable {
+    private:
+        RendererContext *mCtx;
+        std::uint32_t mCapacity;
+        VkDescriptorSetLayout mLayout{};
+        VkDescriptorPool mDescriptorPool{};
+        VkDescriptorSet mDescriptorSet{};
+
+        // Textures can be registered from the engine thread while the renderer records.
+        std::mutex mMutex{};
+        std::uint32_t mNextIndex = 0;
+        List<std::uint32_t> mFreeIndices{};
+
+        void CreateLayout();
+
+        void CreateDescriptorSet();
+
+    public:
+        BindlessTextureTable(RendererContext *ctx, std::uint32_t capacity);
+
+        ~BindlessTextureTable();
+
+        // Returns the slot of the texture in the array.
+        std::uint32_t Register(VkImageView imageView, VkSampler sampler);
+
+        // Rewrites the slot, it must not be used by a frame in flight.
+        void Update(std::uint32_t index, VkImageView imageView, VkSampler sampler);
+
+        // The slot must not be used by a frame in flight, it is handed out again by the next Register.
+        void Release(std::uint32_t index);
+
+        VkDescriptorSetLayout GetLayout() const { return mLayout; }
+
+        VkDescriptorSet GetDescriptorSet() const { return mDescriptorSet; }
+
+        std::uint32_t GetCapacity() const { return mCapacity; }
+    };
+}
+#endif //SMALLVKENGINE_BINDLESSTEXTURETABLE_H
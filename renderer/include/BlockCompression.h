@@ -0,0 +1,40 @@
+//
+// Created by ghima on 22-10-2025.
+//
+
+#ifndef SMALLVKENGINE_BLOCKCOMPRESSION_H
+#define SMALLVKENGINE_BLOCKCOMPRESSION_H
+
+#include "Utility.h"
+
+namespace rn {
+    // BC1 to BC7 encoders for the texture cooker and decoders for devices without BC support.
+    class BlockCompression {
+    private:
+        static void EncodeBC1(const std::uint8_t *texels, std::uint8_t *block);
+
+        static void EncodeSingleChannel(const std::uint8_t *texels, std::uint32_t channel, std::uint8_t *block);
+
+        static void EncodeBC7(const std::uint8_t *texels, std::uint8_t *block);
+
+        static void DecodeBC1(const std::uint8_t *block, std::uint8_t *texels, bool opaqueOnly);
+
+        static void DecodeSingleChannel(const std::uint8_t *block, std::uint32_t channel, std::uint8_t *texels);
+
+        static void DecodeBC7(const std::uint8_t *block, std::uint8_t *texels);
+
+    public:
+        static bool IsBlockCompressed(VkFormat format);
+
+        static VkDeviceSize GetBlockSize(VkFormat format);
+
+        static VkFormat GetFallbackFormat(VkFormat format);
+
+        static void CompressLevel(VkFormat format, const std::uint8_t *rgba, std::uint32_t width, std::uint32_t height,
+                                  std::uint8_t *blocks);
+
+        static void DecompressLevel(VkFormat format, const std::uint8_t *blocks, std::uint32_t width,
+                                    std::uint32_t height, std::uint8_t *rgba);
+    };
+}
+#endif //SMALLVKENGINE_BLOCKCOMPRESSION_H
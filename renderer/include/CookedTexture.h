@@ -0,0 +1,42 @@
+//
+// Created by ghima on 22-10-2025.
+//
+
+#ifndef SMALLVKENGINE_COOKEDTEXTURE_H
+#define SMALLVKENGINE_COOKEDTEXTURE_H
+
+#include "Utility.h"
+
+namespace rn {
+    // KTX2 like cooked texture header, levels stored largest first and unpadded as UploadImage expects.
+    struct CookedTextureHeader {
+        std::array<char, 8> magic;
+        std::uint32_t version;
+        // A VkFormat, block compressed or VK_FORMAT_R8G8B8A8_*.
+        std::uint32_t format;
+        std::uint32_t width;
+        std::uint32_t height;
+        std::uint32_t levelCount;
+        std::uint32_t reserved;
+    };
+    struct CookedTextureLevel {
+        // From the start of the file.
+        std::uint64_t offset;
+        std::uint64_t size;
+    };
+
+    class CookedTexture {
+    public:
+        static constexpr std::array<char, 8> MAGIC = {'S', 'V', 'K', 'T', 'E', 'X', '\r', '\n'};
+        static constexpr std::uint32_t VERSION = 1;
+
+        // Levels go from level 0 down, each one exactly Utility::GetImageLevelSize bytes.
+        static bool Write(const std::string &fileName, VkFormat format, std::uint32_t width, std::uint32_t height,
+                          const List<List<std::uint8_t>> &levels);
+
+        // Leaves the stream at the level data, returns false without logging when the file does not exist.
+        static bool Open(const std::string &fileName, std::ifstream &stream, CookedTextureHeader &header,
+                         List<CookedTextureLevel> &levels);
+    };
+}
+#endif //SMALLVKENGINE_COOKEDTEXTURE_H
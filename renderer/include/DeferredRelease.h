@@ -0,0 +1,40 @@
+//
+// Created by ghima on 22-10-2025.
+//
+
+#ifndef SMALLVKENGINE_DEFERREDRELEASE_H
+#define SMALLVKENGINE_DEFERREDRELEASE_H
+
+#include "Utility.h"
+
+namespace rn {
+    // Keeps replaced buffers and descriptor pools alive for MAX_FRAMES_IN_FLIGHT calls of BeginFrame.
+    class DeferredRelease {
+    private:
+        struct Entry {
+            VkBuffer buffer;
+            MemoryAllocation memory;
+            VkDescriptorPool descriptorPool;
+            std::uint32_t framesLeft;
+        };
+        RendererContext *mCtx;
+        List<Entry> mEntries{};
+
+        void Release(Entry &entry);
+
+    public:
+        explicit DeferredRelease(RendererContext *ctx);
+
+        // Releases everything that is left, the owner waits for the device to be idle before.
+        ~DeferredRelease();
+
+        // The descriptor pool can be VK_NULL_HANDLE, destroying the pool frees the sets pointing at the buffer.
+        void Retire(VkBuffer buffer, const MemoryAllocation &memory, VkDescriptorPool descriptorPool);
+
+        // Only call once the frame's fence has signalled.
+        void BeginFrame();
+
+        size_t GetRetiredCount() const { return mEntries.size(); }
+    };
+}
+#endif //SMALLVKENGINE_DEFERREDRELEASE_H
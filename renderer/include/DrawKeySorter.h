@@ -0,0 +1,32 @@
+//
+// Created by ghima on 22-10-2025.
+//
+
+#ifndef SMALLVKENGINE_DRAWKEYSORTER_H
+#define SMALLVKENGINE_DRAWKEYSORTER_H
+
+#include "Utility.h"
+
+namespace rn {
+    // Radix sorts 64 bit draw keys, most expensive state in the highest bits, depth in the lowest.
+    class DrawKeySorter {
+    private:
+        List<std::uint64_t> mKeys{};
+        List<std::uint64_t> mKeyScratch{};
+        List<std::uint32_t> mOrder{};
+        List<std::uint32_t> mOrderScratch{};
+
+    public:
+        static const std::uint32_t PIPELINE_BITS = 4;
+        static const std::uint32_t INDEX_TYPE_BITS = 1;
+        static const std::uint32_t TEXTURE_BITS = 12;
+        static const std::uint32_t MESH_BITS = 23;
+        static const std::uint32_t DEPTH_BITS = 24;
+
+        static std::uint64_t MakeKey(std::uint32_t pipeline, VkIndexType indexType, std::uint32_t texture,
+                                     std::uint32_t mesh, float depth);
+
+        const List<std::uint32_t> &Sort(const List<std::uint64_t> &keys);
+    };
+}
+#endif //SMALLVKENGINE_DRAWKEYSORTER_H
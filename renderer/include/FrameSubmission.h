@@ -0,0 +1,46 @@
+//
+// Created by ghima on 18-10-2025.
+//
+
+#ifndef SMALLVKENGINE_FRAMESUBMISSION_H
+#define SMALLVKENGINE_FRAMESUBMISSION_H
+
+#include "Utility.h"
+
+namespace rn {
+    // Hands every command buffer recorded for a frame to the queue in a single vkQueueSubmit.
+    class FrameSubmission {
+    private:
+        struct Batch {
+            List<VkCommandBuffer> commandBuffers{};
+            List<VkSemaphore> waitSemaphores{};
+            List<VkPipelineStageFlags> waitStages{};
+            List<VkSemaphore> signalSemaphores{};
+        };
+        // Batches are cleared and reused between frames to keep the allocations.
+        List<Batch> mBatches{};
+        size_t mBatchCount = 0;
+        List<VkSubmitInfo> mSubmitInfos{};
+        std::mutex mMutex{};
+
+        Batch &CurrentBatch();
+
+        void AppendBatch();
+
+    public:
+        void Begin();
+
+        void NextBatch();
+
+        void AddCommandBuffer(VkCommandBuffer commandBuffer);
+
+        void AddCommandBuffers(const List<VkCommandBuffer> &commandBuffers);
+
+        void AddWaitSemaphore(VkSemaphore semaphore, VkPipelineStageFlags waitStage);
+
+        void AddSignalSemaphore(VkSemaphore semaphore);
+
+        VkResult Submit(VkQueue queue, VkFence fence);
+    };
+}
+#endif //SMALLVKENGINE_FRAMESUBMISSION_H
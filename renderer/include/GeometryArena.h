@@ -0,0 +1,108 @@
+//
+// Created by ghima on 22-10-2025.
+//
+
+#ifndef SMALLVKENGINE_GEOMETRYARENA_H
+#define SMALLVKENGINE_GEOMETRYARENA_H
+
+#include "Utility.h"
+
+namespace rn {
+    struct GeometryRange {
+        std::uint32_t firstVertex = 0;
+        std::uint32_t vertexCount = 0;
+        std::uint32_t firstIndex = 0;
+        std::uint32_t indexCount = 0;
+        VkIndexType indexType = VK_INDEX_TYPE_UINT32;
+        std::uint64_t contentHash = 0;
+    };
+
+    enum VertexAttributeFlags : std::uint32_t {
+        VERTEX_ATTRIBUTE_POSITION = 1 << 0,
+        VERTEX_ATTRIBUTE_COLOR = 1 << 1,
+        VERTEX_ATTRIBUTE_UV = 1 << 2,
+        VERTEX_ATTRIBUTE_NORMAL = 1 << 3,
+        VERTEX_ATTRIBUTE_ALL = VERTEX_ATTRIBUTE_POSITION | VERTEX_ATTRIBUTE_COLOR | VERTEX_ATTRIBUTE_UV |
+                               VERTEX_ATTRIBUTE_NORMAL
+    };
+
+    struct VertexInputDescription {
+        List<VkVertexInputBindingDescription> bindings{};
+        List<VkVertexInputAttributeDescription> attributes{};
+
+        VkPipelineVertexInputStateCreateInfo GetCreateInfo() const;
+    };
+
+    // Device local vertex streams and index buffers every mesh gets a range of, shared by meshes of equal content.
+    class GeometryArena {
+    private:
+        struct FreeBlock {
+            std::uint32_t offset;
+            std::uint32_t count;
+        };
+        struct SharedRange {
+            GeometryRange range;
+            std::uint32_t meshCount;
+        };
+        struct PendingFree {
+            GeometryRange range;
+            std::uint32_t framesLeft;
+        };
+        RendererContext *mCtx;
+        VkBuffer mPositionBuffer{};
+        MemoryAllocation mPositionBufferMemory{};
+        VkBuffer mAttributeBuffer{};
+        MemoryAllocation mAttributeBufferMemory{};
+        VkBuffer mColorBuffer{};
+        MemoryAllocation mColorBufferMemory{};
+        VkBuffer mIndexBuffer{};
+        MemoryAllocation mIndexBufferMemory{};
+        VkBuffer mShortIndexBuffer{};
+        MemoryAllocation mShortIndexBufferMemory{};
+        List<FreeBlock> mFreeVertices{};
+        List<FreeBlock> mFreeIndices{};
+        List<FreeBlock> mFreeShortIndices{};
+        // Released ranges the frames in flight may still read.
+        List<PendingFree> mPendingFrees{};
+        Map<std::uint64_t, SharedRange, std::hash<std::uint64_t>> mSharedRanges{};
+        std::mutex mMutex;
+
+        void ReleaseRange(const GeometryRange &range);
+
+        static bool AllocateBlock(List<FreeBlock> &freeBlocks, std::uint32_t count, std::uint32_t &offset);
+
+        static void ReleaseBlock(List<FreeBlock> &freeBlocks, std::uint32_t offset, std::uint32_t count);
+
+        static std::uint64_t HashContent(const List<Vertex> &vertices, const List<std::uint32_t> &indices);
+
+        static std::uint32_t EncodeOctahedral(const glm::vec3 &normal);
+
+    public:
+        GeometryArena(RendererContext *ctx, std::uint32_t vertexCount, std::uint32_t indexCount,
+                      std::uint32_t shortIndexCount);
+
+        ~GeometryArena();
+
+        GeometryRange Allocate(const List<Vertex> &vertices, const List<std::uint32_t> &indices);
+
+        void Free(const GeometryRange &range);
+
+        // Only call once the frame's fence has signalled.
+        void BeginFrame();
+
+        static VertexInputDescription DescribeVertexInput(std::uint32_t attributes);
+
+        void BindVertexBuffers(VkCommandBuffer commandBuffer, std::uint32_t attributes) const;
+
+        VkBuffer GetVertexBuffer() const { return mPositionBuffer; }
+
+        VkBuffer GetIndexBuffer(VkIndexType indexType) const {
+            return indexType == VK_INDEX_TYPE_UINT16 ? mShortIndexBuffer : mIndexBuffer;
+        }
+
+        void BindIndexBuffer(VkCommandBuffer commandBuffer, VkIndexType indexType) const {
+            vkCmdBindIndexBuffer(commandBuffer, GetIndexBuffer(indexType), 0, indexType);
+        }
+    };
+}
+#endif //SMALLVKENGINE_GEOMETRYARENA_H
@@ -37,8 +37,8 @@ namespace rn {
 
         void SetUpMesh();
 
-        void DrawRotationGizmo(std::uint32_t currentImageIndex);
-        void DrawTranslateScaleGizmo(std::uint32_t currentImageIndex);
+        void DrawRotationGizmo(VkCommandBuffer commandBuffer, std::uint32_t currentFrameIndex);
+        void DrawTranslateScaleGizmo(VkCommandBuffer commandBuffer, std::uint32_t currentFrameIndex);
 
         glm::mat4 mModelMatrix{};
 
@@ -57,7 +57,7 @@ namespace rn {
 
         ~Gizmos();
 
-        void DrawGizmos(size_t currentImageIndex);
+        void DrawGizmos(VkCommandBuffer commandBuffer, size_t currentFrameIndex);
 
 
         void SetModelMatrix(const glm::mat4 &modelMatrix) {
@@ -7,6 +7,17 @@
 
 #include "Utility.h"
 #include "BlockingQueue.h"
+#include "FrameSubmission.h"
+#include "UniformRing.h"
+#include "JobSystem.h"
+#include "GeometryArena.h"
+#include "IndirectDrawList.h"
+#include "UploadQueue.h"
+#include "OneShotCommands.h"
+#include "BindlessTextureTable.h"
+#include "SlotMap.h"
+#include "DrawKeySorter.h"
+#include "InstanceBuffer.h"
 
 namespace rn {
     class Graphics {
@@ -27,6 +38,8 @@ namespace rn {
 #pragma endregion
 #pragma region Instance_and_Validations
         VkInstance mInstance;
+        // VK_KHR_multiview needs this instance extension on a Vulkan 1.0 instance.
+        bool mPhysicalDeviceProperties2Enabled = false;
 #pragma endregion
 #pragma region Device_and_Queues
         struct Devices {
@@ -37,6 +50,8 @@ namespace rn {
         struct QueueFamily {
             std::optional<std::uint32_t> graphicsQueueIndex{};
             std::optional<std::uint32_t> presentationQueueIndex{};
+            // A transfer only family, uploads fall back to the graphics queue without one.
+            std::optional<std::uint32_t> transferQueueIndex{};
 
             bool IsValid() {
                 return (graphicsQueueIndex.has_value() && presentationQueueIndex.has_value());
@@ -45,6 +60,22 @@ namespace rn {
 
         VkQueue mGraphicsQueue{};
         VkQueue mPresentationQueue{};
+        VkQueue mTransferQueue{};
+        UploadQueue *mUploadQueue = nullptr;
+        OneShotCommands *mOneShotCommands = nullptr;
+        // Shared with the upload queue and the one shot commands, which may submit from other threads.
+        std::mutex mGraphicsQueueMutex{};
+        bool mMultiviewSupported = false;
+        // drawIndirectFirstInstance is required for the indirect scene path, the other two only make it cheaper.
+        bool mIndirectDrawSupported = false;
+        bool mMultiDrawIndirectSupported = false;
+        bool mTextureCompressionBCSupported = false;
+        // VK_EXT_descriptor_indexing with the features the bindless texture table needs, only used with indirect draws.
+        bool mBindlessTexturesSupported = false;
+        std::uint32_t mBindlessTextureCapacity = 0;
+        PFN_vkCmdDrawIndexedIndirectCountKHR mCmdDrawIndexedIndirectCount = nullptr;
+        // Created with the logical device and destroyed right before it.
+        class MemoryAllocator *mMemoryAllocator = nullptr;
 
 #pragma endregion
 #pragma region Surface_and_Swapchain
@@ -66,31 +97,82 @@ namespace rn {
         VkRenderPass mRenderPass{};
         VkPipeline mPipeline{};
         VkPipelineLayout mPipelineLayout{};
+        // Both read the model data from a storage buffer at set OBJECT_DATA_SET.
+        VkPipeline mIndirectPipeline{};
+        VkPipelineLayout mIndirectPipelineLayout{};
+        static const std::uint32_t OBJECT_DATA_SET = 6;
         VkViewport mViewport{};
         VkRect2D mScissors{};
 #pragma endregion
 #pragma region Draw
         std::uint32_t mCurrentImageIndex;
+        std::uint32_t mCurrentFrame{};
         VkCommandPool mCommandPool;
+        // Command buffer of the frame being recorded, one of mCommandBuffers.
         VkCommandBuffer mCommandBuffer;
-        VkSemaphore mGetImageSemaphore;
-        VkSemaphore mPresentImageSemaphore;
-        VkFence mPresentFinishFence;
-        static Map<std::string, class StaticMesh *, std::hash<std::string>> meshObjectList;
+        // Per frame in flight synchronisation.
+        List<VkCommandBuffer> mCommandBuffers{};
+        List<VkSemaphore> mGetImageSemaphores{};
+        List<VkSemaphore> mPresentImageSemaphores{};
+        List<VkFence> mInFlightFences{};
+        // Fence of the frame that last rendered into each swapchain image.
+        List<VkFence> mImagesInFlight{};
+        FrameSubmission mFrameSubmission{};
+        JobSystem mJobSystem{};
+        // Two timestamps per frame in flight around the off-screen pass, only written while a benchmark runs.
+        VkQueryPool mTimestampQueryPool{};
+        bool mTimestampsSupported = false;
+        float mTimestampPeriod = 0.0f;
+        struct TextureBenchmark {
+            // 0 while idle, 1 while sampling the full mip chains and 2 while sampling only the base levels.
+            std::uint32_t phase = 0;
+            std::uint32_t recordedFrames = 0;
+            // Phase the timestamps of each frame in flight were recorded in, 0 when nothing was written.
+            std::array<std::uint32_t, MAX_FRAMES_IN_FLIGHT> framePhases{};
+            std::array<double, 2> gpuMilliseconds{};
+            std::array<std::uint32_t, 2> resolvedFrames{};
+        } mTextureBenchmark;
+        bool mSceneBenchmarkPending = false;
+
+        // The off-screen pass only executes secondary command buffers, the scene is recorded into them in parallel.
+        struct SceneDrawItem {
+            class StaticMesh *mesh;
+            // Level of detail picked for the frame.
+            std::uint32_t lod;
+            VkDescriptorSet textureDescriptorSet;
+            // Slot of the texture in the bindless texture table.
+            std::uint32_t textureIndex;
+            std::uint64_t sortKey;
+        };
+        class ThreadCommandPools *mSecondaryCommandPools = nullptr;
+        List<SceneDrawItem> mSceneDrawItems{};
+        DrawKeySorter mDrawKeySorter{};
+        List<std::uint64_t> mSortKeys{};
+        List<SceneDrawItem> mSortedDrawItems{};
+        bool mSortSceneDraws = SORT_SCENE_DRAWS;
+        // Commands of the last recorded scene, logged on request.
+        DrawStatistics mDrawStatistics{};
+        GeometryArena *mGeometryArena = nullptr;
+        IndirectDrawList *mIndirectDrawList = nullptr;
+        InstanceBuffer *mInstanceBuffer = nullptr;
+        BindlessTextureTable *mBindlessTextureTable = nullptr;
+        List<VkCommandBuffer> mSecondaryCommandBuffers{};
+        // Packed array of the scene meshes, the draw loops walk it directly.
+        static MeshRegistry mMeshes;
+        // Written by SelectMeshLods, read by the editor statistics window.
+        static LodStatistics mLodStatistics;
+        // Resolves the clicked pick id to the mesh the gizmo is drawn on.
+        static Map<std::uint32_t, MeshHandle, std::hash<std::uint32_t>> mMeshPickIds;
         VkDescriptorPool mImguiDescriptorPool;
 #pragma endregion Draw
 #pragma region Descriptors
-        List<VkDescriptorSet> mViewProjectionDescriptorSets{};
+        // Both bindings are dynamic uniform buffers into the uniform ring, so one set serves every frame.
+        VkDescriptorSet mViewProjectionDescriptorSet{};
         VkDescriptorPool mViewProjectionDescriptorPool{};
         VkDescriptorSetLayout mViewProjectionDescriptorSetLayout{};
-        List<VkBuffer> mViewProjectionBuffers{};
-        List<VkDeviceMemory> mViewProjectionMemory{};
-        // Dynamic Uniform Buffers;
-        List<VkBuffer> mDynamicBuffers{};
-        List<VkDeviceMemory> mDynamicBufferMemory{};
-        size_t mModelMinAlignment{};
+        UniformRing *mUniformRing = nullptr;
+        VkDescriptorSetLayout mObjectDataDescriptorSetLayout{};
         VkDeviceSize mBufferMinAlignment{};
-        ModelUBO *mModelTransferSpace = nullptr;
         // Sampler Descriptor sets;
         VkDescriptorSetLayout mSamplerDescriptorLayout{};
         VkDescriptorPool mSamplerDescriptorPool{};
@@ -107,11 +189,16 @@ namespace rn {
         VkFormat mDepthBufferFormat{};
         List<VkImage> mDepthBufferImages{};
         List<VkImageView> mDepthBufferImageViews{};
-        List<VkDeviceMemory> mDepthBufferImageMemory{};
+        List<MemoryAllocation> mDepthBufferImageMemory{};
 #pragma endregion
 #pragma region Texture
         VkSampler mTextureSampler{};
-        static Map<std::string, class Texture *, std::hash<std::string>> mTextureMap;
+        // Same as mTextureSampler clamped to level 0, only bound while the texture benchmark runs.
+        VkSampler mBaseLevelSampler{};
+        static TextureRegistry mTextures;
+        // Only used when a texture or a mesh is registered, the draws go through the handles.
+        static Map<std::string, TextureHandle, std::hash<std::string>> mTextureIds;
+        static TextureHandle mDefaultTexture;
 
         static class OmniDirectionalLight *mDirectionalLight;
 
@@ -130,7 +217,7 @@ namespace rn {
         VkRenderPass mOffScreenRenderPass{};
         List<VkImage> mOffScreenImages{};
         List<VkImageView> mOffScreenImageViews{};
-        List<VkDeviceMemory> mOffScreenImageMemory{};
+        List<MemoryAllocation> mOffScreenImageMemory{};
         List<VkFramebuffer> mOffScreenFrameBuffers{};
         List<VkFramebuffer> mFrameBuffers;
         VkSampler mOffScreenImageSampler{};
@@ -144,9 +231,16 @@ namespace rn {
 
         List<VkImage> mMousePickingImages{};
         List<VkImageView> mMousePickingImageViews{};
-        List<VkDeviceMemory> mMousePickingImageMemory{};
-        VkBuffer mMousePickingBuffer{};
-        VkDeviceMemory mMousePickingBufferMemory{};
+        List<MemoryAllocation> mMousePickingImageMemory{};
+        // Picking pixel readback, one slot per frame in flight.
+        struct MousePickQuery {
+            VkBuffer buffer{};
+            MemoryAllocation memory{};
+            std::uint32_t *mappedId = nullptr;
+            bool pending = false;
+        };
+        List<MousePickQuery> mMousePickQueries{};
+        std::uint32_t mPendingMousePickCount = 0;
 #pragma endregion
     public:
         // Functions
@@ -188,13 +282,20 @@ namespace rn {
             mRendererContext.logicalDevice = mDevices.logicalDevice;
             mRendererContext.commandPool = mCommandPool;
             mRendererContext.graphicsQueue = mGraphicsQueue;
+            mRendererContext.graphicsQueueMutex = &mGraphicsQueueMutex;
             mRendererContext.graphicsQueueIndex = mQueueFamily.graphicsQueueIndex.value();
             mRendererContext.presentationQueue = mPresentationQueue;
+            mRendererContext.frameSubmission = &mFrameSubmission;
+            mRendererContext.jobSystem = &mJobSystem;
+            mRendererContext.multiviewSupported = mMultiviewSupported;
+            mRendererContext.textureCompressionBCSupported = mTextureCompressionBCSupported;
             mRendererContext.RegisterMesh = &RegisterMeshObject;
+            mRendererContext.UnregisterMesh = &UnregisterMeshObject;
             mRendererContext.UpdateViewAndProjectionMatrix = &SetViewProjection;
             mRendererContext.RegisterTexture = &RegisterTexture;
             mRendererContext.SetUpAsDirectionalLight = &SetUpDirectionalLight;
-            mRendererContext.GetSceneObjectMap = &GetSceneObjectMap;
+            mRendererContext.GetSceneMeshes = &GetSceneMeshes;
+            mRendererContext.GetLodStatistics = &GetLodStatistics;
             mRendererContext.swapChainFormat = mSurfaceFormat.format;
             mRendererContext.swapChainImageViews = &mSwapChainImageViews;
             mRendererContext.swapchain = mSwapChain;
@@ -209,15 +310,17 @@ namespace rn {
             mRendererContext.GetGizmoType = &GetGizmoType;
         }
 
-        static void RegisterMeshObject(std::string &id, class StaticMesh *meshObject) {
-            meshObjectList.insert({id, meshObject});
-        }
+        static MeshHandle RegisterMeshObject(class StaticMesh *meshObject);
+
+        static void UnregisterMeshObject(MeshHandle handle);
 
         RendererContext *GetRendererContext() const { return &mRendererContext; };
 
         void OnViewPortChange(uint32_t newWidth, uint32_t newHeight);
 
-        static Map<std::string, class StaticMesh *, std::hash<std::string>> *GetSceneObjectMap();
+        static MeshRegistry *GetSceneMeshes();
+
+        static const LodStatistics *GetLodStatistics();
 
         static ViewProjection *GetViewProjection() {
             return &mViewProjection;
@@ -267,6 +370,10 @@ namespace rn {
         void GetPhysicalDeviceExtensionProperties(VkPhysicalDevice &physicalDevice,
                                                   List<VkExtensionProperties> &propertiesList);
 
+        // Checks the descriptor indexing features and sets mBindlessTextureCapacity from the device limits.
+        bool QueryBindlessTextureSupport(VkPhysicalDevice &physicalDevice,
+                                         const List<VkExtensionProperties> &availableExtensions);
+
         static bool ComparePropertyNames(const char *name, VkExtensionProperties property) {
             if (std::strcmp(name, property.extensionName) == 0) {
                 return true;
@@ -316,18 +423,72 @@ namespace rn {
 
         void AllocateCommandBuffer();
 
+        void WaitForFramesInFlight();
+
+        void CreateTimestampQueries();
+
+        // Reads the off-screen pass timestamps of the frame once its fence has signalled.
+        void ResolveFrameTimestamps(std::uint32_t frameIndex);
+
+        // Moves the texture sampling benchmark to its next phase once enough frames were recorded.
+        void UpdateTextureBenchmark();
+
+        // Runs between the fence wait and the acquire, it records from the current frame's pools and regions.
+        void RunSceneRecordingBenchmark();
+
         void BeginOffScreenPass(std::uint32_t currentImageIndex);
 
         void BeginSwapchainPass(std::uint32_t currentImageIndex);
 
         void EndOffScreenPass();
 
+        VkCommandBuffer BeginSecondaryCommandBuffer(std::uint32_t slot);
+
+        void SetSceneViewportAndScissor(VkCommandBuffer commandBuffer);
+
+        // Picks the LOD of every scene mesh from its projected bounding sphere.
+        void SelectMeshLods();
+
+        // Resolves the texture, the LOD and the sort key of every scene object, on the calling thread.
+        void CollectSceneDrawItems();
+
+        // Reorders the items by their sort keys.
+        void SortSceneDrawItems(List<SceneDrawItem> &items);
+
+        // Falls back to the default texture for stale and invalid handles.
+        static class Texture *GetSceneTexture(TextureHandle handle);
+
+        // Groups the consecutive items sharing a texture and writes their object data and draw commands for the frame.
+        void BuildIndirectDrawList(List<SceneDrawItem> &items);
+
+        void RecordIndirectScene(VkCommandBuffer commandBuffer, DrawStatistics &statistics);
+
+        void RecordSceneDrawItems(VkCommandBuffer commandBuffer, const SceneDrawItem *items, size_t count,
+                                  DrawStatistics &statistics);
+
+        // Splits the items into chunkCount recording jobs and appends their secondaries in draw order.
+        void RecordSceneChunks(const List<SceneDrawItem> &items, size_t chunkCount,
+                               List<VkCommandBuffer> &commandBuffers, DrawStatistics &statistics);
+
         bool BeginFrame();
 
         void Draw();
 
         void EndFrame();
 
+        void BenchmarkSceneRecording();
+
+        // Logs the used and reserved device memory of every heap and the upload queue counters.
+        void LogMemoryStatistics() const;
+
+        // Switches the sorting of the scene draws on or off, to compare the state changes of both orders.
+        void ToggleDrawSorting();
+
+        // Logs the draw calls and state changes recorded for the scene of the last frame.
+        void LogDrawStatistics() const;
+
+        void BenchmarkTextureSampling();
+
         void Imgui_vulkan_init();
 
 #pragma endregion Draw
@@ -344,10 +505,11 @@ namespace rn {
 
         void CreateUniformBuffers();
 
-        void UpdateMvpUniformBuffers(size_t currentImageIndex, std::uint32_t currentObjectIndex, glm::mat4 model,
-                                     std::uint32_t pickId);
+        // Geometry arena shared by every mesh, the instance buffer and the per frame indirect draw buffers.
+        void CreateSceneBuffers();
 
-        void AllocateDynamicBufferTransferSpace();
+        // Uploads the camera and light data once per frame, before any pass is recorded.
+        void UpdateFrameConstants();
 
 #pragma endregion
 #pragma region Depth_Buffer
@@ -362,7 +524,10 @@ namespace rn {
 
         void CreateTextureDefaultSampler();
 
-        static Texture *RegisterTexture(std::string &textureId);
+        // The descriptor sets of the textures must not be in use by a frame in flight.
+        void SetTextureSamplers(VkSampler sampler);
+
+        static TextureHandle RegisterTexture(std::string &textureId);
 
         void CreateDefaultTexture(const std::string &defaultTexturePath);
 
@@ -380,11 +545,15 @@ namespace rn {
 
         void CreateMousePickingBuffers();
 
+        void DestroyMousePickingBuffers();
+
         void CopyMouseImageToBuffer();
 
         static std::uint32_t GetLastClickedActiveObjectId();
 
-        void SetActiveClickObject();
+        void ResolveMousePickQueries();
+
+        void SetActiveClickObject(std::uint32_t pickId);
 
 #pragma endregion
 
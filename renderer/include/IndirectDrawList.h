@@ -0,0 +1,86 @@
+//
+// Created by ghima on 22-10-2025.
+//
+
+#ifndef SMALLVKENGINE_INDIRECTDRAWLIST_H
+#define SMALLVKENGINE_INDIRECTDRAWLIST_H
+
+#include "Utility.h"
+#include "DeferredRelease.h"
+
+namespace rn {
+    // Per frame indirect draws into the geometry arena, one multi draw per texture batch.
+    class IndirectDrawList {
+    private:
+        struct Batch {
+            VkDescriptorSet textureDescriptorSet;
+            VkIndexType indexType;
+            std::uint32_t firstCommand;
+            std::uint32_t commandCount;
+        };
+        RendererContext *mCtx;
+        VkDescriptorSetLayout mObjectDataLayout;
+        // Objects of one frame region, only grows.
+        std::uint32_t mCapacity;
+        bool mMultiDrawSupported;
+        // Only set when VK_KHR_draw_indirect_count is enabled, the batch sizes are then read from mCountBuffer.
+        PFN_vkCmdDrawIndexedIndirectCountKHR mCmdDrawIndexedIndirectCount;
+
+        // All three buffers are persistently mapped and split into one region per frame in flight.
+        VkBuffer mObjectBuffer{};
+        MemoryAllocation mObjectBufferMemory{};
+        ObjectData *mObjects = nullptr;
+        VkDeviceSize mObjectRegionSize{};
+        VkBuffer mCommandBuffer{};
+        MemoryAllocation mCommandBufferMemory{};
+        VkDrawIndexedIndirectCommand *mCommands = nullptr;
+        VkBuffer mCountBuffer{};
+        MemoryAllocation mCountBufferMemory{};
+        std::uint32_t *mCounts = nullptr;
+
+        VkDescriptorPool mDescriptorPool{};
+        // One set per frame in flight, each one points at the object region of its frame.
+        List<VkDescriptorSet> mDescriptorSets{};
+
+        size_t mFrameIndex = 0;
+        std::uint32_t mObjectCount = 0;
+        std::uint32_t mDrawCount = 0;
+        // Copy of the last written command, to extend it with the next object.
+        VkDrawIndexedIndirectCommand mLastCommand{};
+        List<Batch> mBatches{};
+        DeferredRelease mDeferredRelease;
+
+        void CreateBuffers();
+
+        void CreateDescriptorSets();
+
+        // Replaces every buffer with one holding objectCount objects per frame, the old ones are retired.
+        void Grow(std::uint32_t objectCount);
+
+    public:
+        IndirectDrawList(RendererContext *ctx, VkDescriptorSetLayout objectDataLayout, std::uint32_t capacity,
+                         bool multiDrawSupported, PFN_vkCmdDrawIndexedIndirectCountKHR cmdDrawIndexedIndirectCount);
+
+        ~IndirectDrawList();
+
+        // Only call once the frame's fence has signalled. objectCount is the number of Add calls that follow.
+        void Begin(size_t currentFrameIndex, std::uint32_t objectCount);
+
+        // Objects have to be added grouped by index type and texture set, a change of either starts a new batch.
+        void Add(const class StaticMesh *mesh, std::uint32_t lod, VkDescriptorSet textureDescriptorSet,
+                 std::uint32_t textureIndex);
+
+        // The caller binds the pipeline, the arena vertex buffers and the remaining descriptor sets.
+        void Record(VkCommandBuffer commandBuffer, VkPipelineLayout layout, std::uint32_t textureSet,
+                    std::uint32_t objectDataSet, DrawStatistics &statistics) const;
+
+        std::uint32_t GetDrawCount() const { return mDrawCount; }
+
+        std::uint32_t GetObjectCount() const { return mObjectCount; }
+
+        size_t GetBatchCount() const { return mBatches.size(); }
+
+        std::uint32_t GetCapacity() const { return mCapacity; }
+    };
+}
+#endif //SMALLVKENGINE_INDIRECTDRAWLIST_H
@@ -0,0 +1,66 @@
+//
+// Created by ghima on 22-10-2025.
+//
+
+#ifndef SMALLVKENGINE_INSTANCEBUFFER_H
+#define SMALLVKENGINE_INSTANCEBUFFER_H
+
+#include <atomic>
+#include "Utility.h"
+#include "DeferredRelease.h"
+
+namespace rn {
+    struct InstanceRun {
+        const class StaticMesh *mesh;
+        std::uint32_t lod;
+        std::uint32_t firstInstance;
+        std::uint32_t instanceCount;
+    };
+
+    // Per frame ObjectData regions read through gl_InstanceIndex by the instanced draws.
+    class InstanceBuffer {
+    private:
+        RendererContext *mCtx;
+        VkDescriptorSetLayout mLayout;
+        std::uint32_t mCapacity;
+        VkBuffer mBuffer{};
+        MemoryAllocation mMemory{};
+        std::uint8_t *mMappedData = nullptr;
+        VkDeviceSize mRegionSize{};
+        VkDescriptorPool mDescriptorPool{};
+        List<VkDescriptorSet> mDescriptorSets{};
+        size_t mFrameIndex = 0;
+        std::atomic<std::uint32_t> mFrameHead{0};
+        DeferredRelease mDeferredRelease;
+
+        void CreateBuffer();
+
+        void CreateDescriptorSets();
+
+    public:
+        InstanceBuffer(RendererContext *ctx, VkDescriptorSetLayout objectDataLayout, std::uint32_t capacity);
+
+        ~InstanceBuffer();
+
+        // Only call once the frame's fence has signalled.
+        void BeginFrame(size_t currentFrameIndex);
+
+        void Reserve(std::uint32_t count);
+
+        std::uint32_t Allocate(std::uint32_t count, ObjectData *&instances);
+
+        void BuildRuns(List<const class StaticMesh *> &meshes, List<InstanceRun> &runs, std::uint32_t lodBias);
+
+        static void DrawRuns(VkCommandBuffer commandBuffer, const List<InstanceRun> &runs);
+
+        static bool SameGeometry(const class StaticMesh *a, std::uint32_t lodA, const class StaticMesh *b,
+                                 std::uint32_t lodB);
+
+        VkDescriptorSetLayout GetLayout() const { return mLayout; }
+
+        VkDescriptorSet GetDescriptorSet() const { return mDescriptorSets[mFrameIndex]; }
+
+        std::uint32_t GetCapacity() const { return mCapacity; }
+    };
+}
+#endif //SMALLVKENGINE_INSTANCEBUFFER_H
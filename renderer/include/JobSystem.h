@@ -0,0 +1,61 @@
+//
+// Created by ghima on 20-10-2025.
+//
+
+#ifndef SMALLVKENGINE_JOBSYSTEM_H
+#define SMALLVKENGINE_JOBSYSTEM_H
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include "Utility.h"
+
+namespace rn {
+    // Persistent work stealing workers, the thread calling Wait helps with the remaining jobs.
+    class JobSystem {
+    public:
+        // Only used by one thread at a time, so it can index per thread resources.
+        using Job = std::function<void(std::uint32_t slot)>;
+
+    private:
+        struct WorkerQueue {
+            std::mutex mutex{};
+            std::deque<Job> jobs{};
+        };
+
+        List<std::thread> mWorkers{};
+        // One queue per worker, the last one belongs to the thread calling Wait.
+        List<std::unique_ptr<WorkerQueue>> mQueues{};
+        std::atomic<std::uint32_t> mNextQueue{0};
+        // Queued jobs are not picked up yet, pending jobs are not finished yet.
+        std::atomic<size_t> mQueuedJobs{0};
+        std::atomic<size_t> mPendingJobs{0};
+        std::mutex mMutex{};
+        std::condition_variable mCondition{};
+        bool mStop = false;
+
+        bool TryRunJob(std::uint32_t slot);
+
+        void WorkerLoop(std::uint32_t slot);
+
+    public:
+        // Defaults to one worker per hardware thread, minus the thread that records the frame.
+        explicit JobSystem(std::uint32_t workerCount = 0);
+
+        ~JobSystem();
+
+        JobSystem(const JobSystem &) = delete;
+
+        JobSystem &operator=(const JobSystem &) = delete;
+
+        void Submit(Job &&job);
+
+        // Blocks until every submitted job has finished.
+        void Wait();
+
+        std::uint32_t GetSlotCount() const { return mQueues.size(); }
+    };
+}
+#endif //SMALLVKENGINE_JOBSYSTEM_H
@@ -0,0 +1,104 @@
+//
+// Created by ghima on 22-10-2025.
+//
+
+#ifndef SMALLVKENGINE_MEMORYALLOCATOR_H
+#define SMALLVKENGINE_MEMORYALLOCATOR_H
+
+#include <atomic>
+#include "Utility.h"
+
+namespace rn {
+    struct MemoryHeapStatistics {
+        VkDeviceSize heapSize = 0;
+        VkDeviceSize reservedBytes = 0;
+        VkDeviceSize usedBytes = 0;
+        std::uint32_t deviceAllocationCount = 0;
+        std::uint32_t allocationCount = 0;
+    };
+
+    struct LinearAllocation {
+        void *data;
+        VkDeviceSize offset;
+    };
+
+    // Bump allocated, persistently mapped buffer with a region per frame in flight, reset by BeginFrame.
+    class LinearPool {
+    private:
+        VkBuffer mBuffer{};
+        MemoryAllocation mMemory{};
+        std::string mName;
+        VkDeviceSize mFrameSize;
+        VkDeviceSize mAlignment;
+        VkDeviceSize mFrameBegin = 0;
+        std::atomic<VkDeviceSize> mFrameHead{0};
+
+        LinearPool(const std::string &name, VkDeviceSize frameSize, VkDeviceSize alignment);
+
+        friend class MemoryAllocator;
+
+    public:
+        // Only call once the fence of the frame has signalled.
+        void BeginFrame(size_t currentFrameIndex);
+
+        LinearAllocation Allocate(VkDeviceSize size);
+
+        VkBuffer GetBuffer() const { return mBuffer; }
+    };
+
+    // Sub-allocates buffers and images from size class, free list and dedicated device memory.
+    class MemoryAllocator {
+    private:
+        VkDevice mLogicalDevice;
+        VkPhysicalDevice mPhysicalDevice;
+        VkPhysicalDeviceMemoryProperties mMemoryProperties{};
+        List<List<struct MemoryBlock *>> mPools{};
+        List<MemoryHeapStatistics> mHeapStatistics{};
+        mutable std::mutex mMutex;
+
+        MemoryAllocation Allocate(const VkMemoryRequirements &requirements, VkMemoryPropertyFlags memoryFlags,
+                                  bool optimalTiling, const std::string &name);
+
+        bool AllocateDeviceMemory(std::uint32_t memoryTypeIndex, VkDeviceSize size, VkDeviceMemory &memory,
+                                  std::uint8_t *&mappedData);
+
+        void FreeDeviceMemory(std::uint32_t memoryTypeIndex, VkDeviceSize size, VkDeviceMemory memory);
+
+        MemoryAllocation AllocateDedicated(std::uint32_t memoryTypeIndex, VkDeviceSize size, const std::string &name);
+
+        bool AllocateFromSizeClass(std::uint32_t poolIndex, VkDeviceSize slotSize, MemoryAllocation &allocation);
+
+        bool AllocateFromFreeList(std::uint32_t poolIndex, VkDeviceSize size, VkDeviceSize alignment,
+                                  MemoryAllocation &allocation);
+
+        struct MemoryBlock *CreateBlock(std::uint32_t poolIndex, std::uint32_t memoryTypeIndex, VkDeviceSize size,
+                                        VkDeviceSize slotSize);
+
+        void ReleaseBlockIfUnused(struct MemoryBlock *block);
+
+        void Track(std::uint32_t memoryTypeIndex, VkDeviceSize size, bool allocated);
+
+    public:
+        MemoryAllocator(VkPhysicalDevice physicalDevice, VkDevice logicalDevice);
+
+        ~MemoryAllocator();
+
+        MemoryAllocation AllocateBuffer(VkBuffer buffer, VkMemoryPropertyFlags memoryFlags, const std::string &name);
+
+        MemoryAllocation AllocateImage(VkImage image, VkImageTiling tiling, VkMemoryPropertyFlags memoryFlags,
+                                       const std::string &name);
+
+        // Only call once the GPU no longer uses the resource bound to the allocation.
+        void Free(MemoryAllocation &allocation);
+
+        LinearPool *CreateLinearPool(VkBufferUsageFlags usage, VkDeviceSize frameSize, VkDeviceSize alignment,
+                                     const std::string &name);
+
+        void DestroyLinearPool(LinearPool *pool);
+
+        List<MemoryHeapStatistics> GetHeapStatistics() const;
+
+        void LogStatistics() const;
+    };
+}
+#endif //SMALLVKENGINE_MEMORYALLOCATOR_H
@@ -0,0 +1,46 @@
+//
+// Created by ghima on 22-10-2025.
+//
+
+#ifndef SMALLVKENGINE_MESHOPTIMIZER_H
+#define SMALLVKENGINE_MESHOPTIMIZER_H
+
+#include "Utility.h"
+
+namespace rn {
+    // Post-transform cache statistics of an index list, simulated with a FIFO cache of VERTEX_CACHE_SIZE entries.
+    struct VertexCacheStatistics {
+        // Vertex shader invocations per triangle.
+        float acmr = 0.0f;
+        // Average transformed vertex ratio, vertex shader invocations per referenced vertex. 1 is the optimum.
+        float atvr = 0.0f;
+    };
+
+    struct MeshOptimizationReport {
+        VertexCacheStatistics before{};
+        VertexCacheStatistics after{};
+        // False when the overdraw order cost more than OVERDRAW_ACMR_THRESHOLD and the cache order was kept.
+        bool overdrawOrdered = false;
+    };
+
+    // Tipsify vertex cache and overdraw ordering of indexed triangle lists, vertices renumbered by first use.
+    class MeshOptimizer {
+    private:
+        // Sorts the clusters by the distance of their centre from the mesh centre along their normal.
+        static void OrderForOverdraw(List<std::uint32_t> &indices, const List<Vertex> &vertices,
+                                     const List<std::uint32_t> &clusters);
+
+    public:
+        static VertexCacheStatistics AnalyzeVertexCache(const List<std::uint32_t> &indices, std::uint32_t vertexCount);
+
+        // Applies the three orderings in place, the indices have to be a triangle list.
+        static MeshOptimizationReport Optimize(List<Vertex> &vertices, List<std::uint32_t> &indices);
+
+        // Returns the first triangle of every cluster, ending with the triangle count.
+        static List<std::uint32_t> OrderForVertexCache(List<std::uint32_t> &indices, std::uint32_t vertexCount);
+
+        // Renumbers the vertices in the order of their first reference.
+        static void OrderForVertexFetch(List<Vertex> &vertices, List<std::uint32_t> &indices);
+    };
+}
+#endif //SMALLVKENGINE_MESHOPTIMIZER_H
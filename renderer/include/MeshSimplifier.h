@@ -0,0 +1,32 @@
+//
+// Created by ghima on 22-10-2025.
+//
+
+#ifndef SMALLVKENGINE_MESHSIMPLIFIER_H
+#define SMALLVKENGINE_MESHSIMPLIFIER_H
+
+#include "Utility.h"
+
+namespace rn {
+    // Quadric error metric simplifier that collapses vertices onto existing ones, so every LOD reuses the vertices.
+    class MeshSimplifier {
+    private:
+        struct Quadric {
+            double a2 = 0.0, b2 = 0.0, c2 = 0.0, ab = 0.0, ac = 0.0, bc = 0.0;
+            double ad = 0.0, bd = 0.0, cd = 0.0, d2 = 0.0;
+            double weight = 0.0;
+
+            void AddPlane(const glm::vec3 &normal, float distance, float weight);
+
+            void Add(const Quadric &other);
+
+            double Evaluate(const glm::vec3 &position) const;
+        };
+
+    public:
+        // Returns the largest error of a collapse, relative to the mesh extent like targetError.
+        static float Simplify(const List<Vertex> &vertices, const List<std::uint32_t> &indices,
+                              size_t targetIndexCount, float targetError, List<std::uint32_t> &result);
+    };
+}
+#endif //SMALLVKENGINE_MESHSIMPLIFIER_H
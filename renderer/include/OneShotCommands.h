@@ -0,0 +1,75 @@
+//
+// Created by ghima on 22-10-2025.
+//
+
+#ifndef SMALLVKENGINE_ONESHOTCOMMANDS_H
+#define SMALLVKENGINE_ONESHOTCOMMANDS_H
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include "Utility.h"
+
+namespace rn {
+    // Identifies one submission of OneShotCommands, stays valid after its command buffer has been recycled.
+    struct OneShotHandle {
+        std::uint32_t poolIndex = 0;
+        // Zero never names a submission, a default handle is always complete.
+        std::uint64_t submission = 0;
+    };
+
+    // Per thread pools of command buffers and fences for one-off graphics queue work, recycled once signalled.
+    class OneShotCommands {
+    private:
+        struct Context {
+            VkCommandBuffer commandBuffer{};
+            VkFence fence{};
+            // Zero while free or recording.
+            std::uint64_t submission = 0;
+            bool recording = false;
+        };
+        struct ThreadPool {
+            VkCommandPool commandPool{};
+            List<Context> contexts{};
+            // Owned by one thread for recording, but handles can be polled from anywhere.
+            std::mutex mutex{};
+        };
+
+        RendererContext *mCtx;
+        List<std::unique_ptr<ThreadPool>> mPools{};
+        Map<std::thread::id, std::uint32_t, std::hash<std::thread::id>> mThreadPools{};
+        mutable std::mutex mPoolsMutex{};
+        std::atomic<std::uint64_t> mNextSubmission{1};
+        std::atomic<std::uint64_t> mBeginCount{0};
+        std::atomic<std::uint64_t> mCreatedCount{0};
+
+        ThreadPool &GetThreadPool(std::uint32_t &poolIndex);
+
+        ThreadPool &GetPool(std::uint32_t poolIndex);
+
+        // Frees every context of the pool whose fence has signalled, the pool mutex has to be held.
+        void Recycle(ThreadPool &pool);
+
+        OneShotHandle Submit(VkCommandBuffer commandBuffer, bool wait);
+
+    public:
+        explicit OneShotCommands(RendererContext *ctx);
+
+        ~OneShotCommands();
+
+        // Returns a command buffer of the calling thread's pool in the recording state.
+        VkCommandBuffer Begin();
+
+        // Ends and submits a command buffer from Begin, has to be called on the same thread. Does not wait.
+        OneShotHandle Submit(VkCommandBuffer commandBuffer);
+
+        void SubmitAndWait(VkCommandBuffer commandBuffer);
+
+        bool IsComplete(OneShotHandle handle);
+
+        void Wait(OneShotHandle handle);
+
+        void LogStatistics() const;
+    };
+}
+#endif //SMALLVKENGINE_ONESHOTCOMMANDS_H
@@ -18,9 +18,7 @@ namespace rn {
         VkRect2D mScissors{};
         VkImage mSkyBoxImage{};
         VkImageView mSkyBoxImageView{};
-        VkDeviceMemory mSkyBoxImageMemory{};
-        List<VkBuffer> mStagingBuffers{};
-        List<VkDeviceMemory> mStagingBufferMemory{};
+        MemoryAllocation mSkyBoxImageMemory{};
         VkSampler mCubeSampler{};
 
         class StaticMesh *mCubeMesh;
@@ -38,7 +36,7 @@ namespace rn {
     public:
         explicit Skybox(RendererContext *ctx);
 
-        void RenderSkyBox();
+        void RenderSkyBox(VkCommandBuffer commandBuffer);
 
     };
 }
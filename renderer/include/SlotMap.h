@@ -0,0 +1,106 @@
+//
+// Created by ghima on 22-10-2025.
+//
+
+#ifndef SMALLVKENGINE_SLOTMAP_H
+#define SMALLVKENGINE_SLOTMAP_H
+
+#include "Utility.h"
+
+namespace rn {
+    // Densely packed values behind generational handles, removal moves the last value into the freed place.
+    template<typename T, typename Tag>
+    class SlotMap {
+    public:
+        using Handle = SlotHandle<Tag>;
+
+    private:
+        struct Slot {
+            std::uint32_t valueIndex;
+            std::uint32_t generation;
+        };
+        List<T> mValues{};
+        // Slot of every value, used to patch the slot of the value that fills a removed place.
+        List<std::uint32_t> mValueSlots{};
+        List<Slot> mSlots{};
+        List<std::uint32_t> mFreeSlots{};
+
+    public:
+        Handle Insert(const T &value) {
+            std::uint32_t slotIndex;
+            if (!mFreeSlots.empty()) {
+                slotIndex = mFreeSlots.back();
+                mFreeSlots.pop_back();
+            } else {
+                slotIndex = static_cast<std::uint32_t>(mSlots.size());
+                mSlots.push_back({0, 0});
+            }
+            mSlots[slotIndex].valueIndex = static_cast<std::uint32_t>(mValues.size());
+            mValues.push_back(value);
+            mValueSlots.push_back(slotIndex);
+            return {slotIndex, mSlots[slotIndex].generation};
+        }
+
+        // Returns false for handles that are stale or were never valid.
+        bool Remove(Handle handle) {
+            if (!Contains(handle)) {
+                return false;
+            }
+            Slot &slot = mSlots[handle.index];
+            std::uint32_t lastIndex = static_cast<std::uint32_t>(mValues.size() - 1);
+            if (slot.valueIndex != lastIndex) {
+                mValues[slot.valueIndex] = std::move(mValues[lastIndex]);
+                mValueSlots[slot.valueIndex] = mValueSlots[lastIndex];
+                mSlots[mValueSlots[slot.valueIndex]].valueIndex = slot.valueIndex;
+            }
+            mValues.pop_back();
+            mValueSlots.pop_back();
+            slot.generation++;
+            mFreeSlots.push_back(handle.index);
+            return true;
+        }
+
+        bool Contains(Handle handle) const {
+            // Removing bumps the generation, so a free or reused slot never matches an old handle.
+            return handle.index < mSlots.size() && mSlots[handle.index].generation == handle.generation;
+        }
+
+        // nullptr for stale handles.
+        T *Get(Handle handle) {
+            return Contains(handle) ? &mValues[mSlots[handle.index].valueIndex] : nullptr;
+        }
+
+        const T *Get(Handle handle) const {
+            return Contains(handle) ? &mValues[mSlots[handle.index].valueIndex] : nullptr;
+        }
+
+        // Handle of the value at a position of the packed array.
+        Handle GetHandle(size_t valueIndex) const {
+            std::uint32_t slotIndex = mValueSlots[valueIndex];
+            return {slotIndex, mSlots[slotIndex].generation};
+        }
+
+        size_t Size() const { return mValues.size(); }
+
+        bool Empty() const { return mValues.empty(); }
+
+        typename List<T>::iterator begin() { return mValues.begin(); }
+
+        typename List<T>::iterator end() { return mValues.end(); }
+
+        typename List<T>::const_iterator begin() const { return mValues.begin(); }
+
+        typename List<T>::const_iterator end() const { return mValues.end(); }
+
+        const T &operator[](size_t valueIndex) const { return mValues[valueIndex]; }
+    };
+
+    class StaticMesh;
+
+    class Texture;
+
+    // Scene meshes and textures of the Graphics, indexed with the handles returned by RegisterMesh and RegisterTexture.
+    using MeshRegistry = SlotMap<StaticMesh *, StaticMesh>;
+    using TextureRegistry = SlotMap<Texture *, Texture>;
+}
+#endif //SMALLVKENGINE_SLOTMAP_H
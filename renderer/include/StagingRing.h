@@ -0,0 +1,44 @@
+//
+// Created by ghima on 22-10-2025.
+//
+
+#ifndef SMALLVKENGINE_STAGINGRING_H
+#define SMALLVKENGINE_STAGINGRING_H
+
+#include "Utility.h"
+
+namespace rn {
+    struct StagingAllocation {
+        VkBuffer buffer;
+        VkDeviceSize offset;
+        // Host pointer to offset, data written here is visible to the GPU without a flush.
+        void *data;
+    };
+
+    // Persistently mapped transfer source ring, reclaimed in allocation order through Release.
+    class StagingRing {
+    private:
+        RendererContext *mCtx;
+        VkBuffer mBuffer{};
+        MemoryAllocation mMemory{};
+        VkDeviceSize mSize;
+        // Positions only ever grow, the buffer offset is the position modulo the size.
+        VkDeviceSize mHead = 0;
+        VkDeviceSize mTail = 0;
+
+    public:
+        StagingRing(RendererContext *ctx, VkDeviceSize size);
+
+        ~StagingRing();
+
+        bool Allocate(VkDeviceSize size, VkDeviceSize alignment, StagingAllocation &allocation);
+
+        // Marks everything allocated before the given head as consumed, older heads are ignored.
+        void Release(VkDeviceSize head);
+
+        VkDeviceSize GetHead() const { return mHead; }
+
+        VkDeviceSize GetSize() const { return mSize; }
+    };
+}
+#endif //SMALLVKENGINE_STAGINGRING_H
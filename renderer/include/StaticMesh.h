@@ -6,68 +6,94 @@
 #define SMALLVKENGINE_STATICMESH_H
 
 #include "Utility.h"
+#include "GeometryArena.h"
 
 namespace rn {
+    // Index range of one level of detail inside the arena range of its mesh, every level uses the same vertices.
+    struct MeshLod {
+        // Relative to the first index of the mesh's GeometryRange.
+        std::uint32_t firstIndex;
+        std::uint32_t indexCount;
+        // Largest surface deviation of the simplifier relative to the mesh extent, summed over the levels before.
+        float error;
+    };
+
     class StaticMesh {
     private:
         List<Vertex> mVertList{};
         List<std::uint32_t> mIndicesList{};
         std::uint32_t mIndicesCount;
         std::uint32_t mPickId;
+        std::array<MeshLod, MAX_MESH_LODS> mLods{};
+        std::uint32_t mLodCount = 1;
+        // Picked by the Graphics for the frame from the projected size, the passes add their bias on top.
+        std::uint32_t mLod = 0;
 
-        VkBuffer mVertexBuffer{};
-        VkBuffer mIndexBuffer{};
-        VkDeviceMemory mVertexBufferMemory{};
-        VkDeviceMemory mIndexBufferMemory{};
+        // Vertices and indices live in the shared geometry arena, the draws select them with the range offsets.
+        GeometryRange mGeometryRange{};
         RendererContext mRenderContext{};
         std::string mTextureId;
+        // Resolved from mTextureId when the mesh is registered with the Graphics.
+        TextureHandle mTextureHandle{};
         glm::mat4 mModelMatrix{1};
         bool mCalculateNormals;
+        bool mGenerateLods;
+        // Local space bounding sphere, xyz is the center and w the radius.
+        glm::vec4 mBoundingSphere{};
 
         void CalculateAverageNormals();
 
+        void CalculateBoundingSphere();
+
+        // Simplifies every level from the one before it and appends its indices to the arena index list.
+        void GenerateLods(List<std::uint32_t> &arenaIndices);
+
     public:
+        // Only meshes imported from model files should generate LODs, the simplifier assumes a triangle list.
         StaticMesh(RendererContext &ctx, List<Vertex> &Vertices, List<std::uint32_t> &indices, std::uint32_t pickId,
                    std::string &textureId,
-                   bool calculateNormals);
+                   bool calculateNormals, bool generateLods = false);
 
         ~StaticMesh();
 
         void Init();
 
-        template<typename T>
-        void CreateMeshBuffer(List<T> &meshData, VkBufferUsageFlags usageFlags, VkBuffer &buffer,
-                              VkDeviceMemory &bufferMemory, std::string &&bufferName) {
-            VkBuffer stagingBuffer{};
-            VkDeviceMemory stagingBufferMemory{};
-            VkDeviceSize bufferSize = sizeof(T) * meshData.size();
-            std::string stagingBufferName = "Stating Buffer " + bufferName;
-            Utility::CreateBuffer(mRenderContext, stagingBuffer, (VK_BUFFER_USAGE_TRANSFER_SRC_BIT),
-                                  stagingBufferMemory,
-                                  (VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT),
-                                  bufferSize, stagingBufferName);
-
-            void *data;
-            vkMapMemory(mRenderContext.logicalDevice, stagingBufferMemory, 0, bufferSize, 0, &data);
-            memcpy(data, meshData.data(), bufferSize);
-            vkUnmapMemory(mRenderContext.logicalDevice, stagingBufferMemory);
-
-            Utility::CreateBuffer(mRenderContext, buffer,
-                                  usageFlags,
-                                  bufferMemory, (VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT), bufferSize, bufferName);
-
-            Utility::CopyBuffers(mRenderContext, stagingBuffer, buffer, bufferSize);
-            vkDestroyBuffer(mRenderContext.logicalDevice, stagingBuffer, nullptr);
-            vkFreeMemory(mRenderContext.logicalDevice, stagingBufferMemory, nullptr);
-        }
+        VkBuffer GetVertexBuffer() const { return mRenderContext.geometryArena->GetVertexBuffer(); }
 
-        VkBuffer GetVertexBuffer() const { return mVertexBuffer; }
+        // Arena index buffer of the mesh's index type, firstIndex counts its elements.
+        VkBuffer GetIndexBuffer() const { return mRenderContext.geometryArena->GetIndexBuffer(GetIndexType()); }
 
-        VkBuffer GetIndexBuffer() const { return mIndexBuffer; }
+        // Picked by the arena from the vertex count, the CPU copy of the indices always stays 32 bit.
+        VkIndexType GetIndexType() const { return mGeometryRange.indexType; }
 
         std::uint32_t GetStaticMeshIndicesCount() const { return mIndicesCount; }
 
-        std::string GetTextureId() const { return mTextureId; }
+        std::uint32_t GetStaticMeshIndicesCount(std::uint32_t lod) const { return mLods[lod].indexCount; }
+
+        // First index of the mesh in the arena index buffer of its index type.
+        std::uint32_t GetFirstIndex() const { return mGeometryRange.firstIndex; }
+
+        std::uint32_t GetFirstIndex(std::uint32_t lod) const {
+            return mGeometryRange.firstIndex + mLods[lod].firstIndex;
+        }
+
+        std::uint32_t GetLodCount() const { return mLodCount; }
+
+        const MeshLod &GetLodInfo(std::uint32_t lod) const { return mLods[lod]; }
+
+        // LOD picked for the frame, coarser by bias and clamped to the coarsest level.
+        std::uint32_t GetLod(std::uint32_t bias = 0) const { return std::min(mLod + bias, mLodCount - 1); }
+
+        void SetLod(std::uint32_t lod) { mLod = std::min(lod, mLodCount - 1); }
+
+        // Added to every index of the mesh, the indices themselves stay local to the mesh.
+        std::int32_t GetVertexOffset() const { return static_cast<std::int32_t>(mGeometryRange.firstVertex); }
+
+        const std::string &GetTextureId() const { return mTextureId; }
+
+        TextureHandle GetTextureHandle() const { return mTextureHandle; }
+
+        void SetTextureHandle(TextureHandle handle) { mTextureHandle = handle; }
 
         // Getters and Setters;
         void SetModelMatrix(const glm::mat4 &modelMatrix) {
@@ -83,6 +109,8 @@ namespace rn {
         List<Vertex> &GetVertexList() { return mVertList; };
 
         std::uint32_t GetPickId() const { return mPickId; }
+
+        const glm::vec4 &GetBoundingSphere() const { return mBoundingSphere; }
     };
 }
 #endif //SMALLVKENGINE_STATICMESH_H
@@ -15,14 +15,30 @@ namespace rn {
         VkDescriptorSet mTextureDescriptorSet{};
         VkImageView mTextureImageView{};
         VkImage mTextureImage{};
-        VkDeviceMemory mTextureImageMemory{};
+        MemoryAllocation mTextureImageMemory{};
+        std::uint32_t mWidth = 0;
+        std::uint32_t mHeight = 0;
+        std::uint32_t mMipLevels = 1;
+        VkFormat mFormat = VK_FORMAT_R8G8B8A8_SRGB;
+        // Slot in the bindless texture table, stays 0 without one.
+        std::uint32_t mBindlessIndex = 0;
 
         void CreateTextureImage(const char *fileName);
 
+        // Returns false when there is no usable cooked file.
+        bool LoadCookedTexture(const std::string &fileName);
+
+        bool IsFormatSampleable(VkFormat format) const;
+
+        // Writes level 0 and every smaller level into staging, in the order UploadQueue::UploadImage expects them.
+        void WriteMipChain(const std::uint8_t *imageData, std::uint8_t *staging) const;
+
         void CreateTexture(const char *fileName);
 
         void CreateTextureDescriptorSets(VkImageView imageView);
 
+        void WriteTextureDescriptorSet(VkSampler sampler);
+
     public:
         Texture(const char *fileName, RendererContext *ctx);
 
@@ -30,6 +46,17 @@ namespace rn {
 
         VkDescriptorSet GetTextureDescriptorSet() { return mTextureDescriptorSet; }
 
+        std::uint32_t GetBindlessIndex() const { return mBindlessIndex; }
+
+        // Neither the descriptor set nor the bindless slot may be in use by a frame in flight.
+        void SetSampler(VkSampler sampler);
+
+        VkDeviceSize GetMemorySize() const { return mTextureImageMemory.size; }
+
+        VkDeviceSize GetBaseLevelSize() const {
+            return Utility::GetImageLevelSize(mFormat, mWidth, mHeight, 0);
+        }
+
     };
 }
 #endif //SMALLVKENGINE_TEXTURE_H
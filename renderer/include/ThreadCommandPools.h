@@ -0,0 +1,37 @@
+//
+// Created by ghima on 21-10-2025.
+//
+
+#ifndef SMALLVKENGINE_THREADCOMMANDPOOLS_H
+#define SMALLVKENGINE_THREADCOMMANDPOOLS_H
+
+#include "Utility.h"
+
+namespace rn {
+    // Command pool per job system slot and frame in flight, reset once the frame's fence has signalled.
+    class ThreadCommandPools {
+    private:
+        struct SlotPool {
+            VkCommandPool commandPool{};
+            List<VkCommandBuffer> commandBuffers{};
+            size_t usedCount = 0;
+        };
+        RendererContext *mCtx;
+        VkCommandBufferLevel mLevel;
+        std::uint32_t mSlotCount;
+        // Indexed by frame * slot count + slot.
+        List<SlotPool> mPools{};
+
+    public:
+        ThreadCommandPools(RendererContext *ctx, VkCommandBufferLevel level, std::uint32_t slotCount);
+
+        ~ThreadCommandPools();
+
+        // Only call once the frame's fence has signalled.
+        void Reset(size_t currentFrameIndex);
+
+        // Only the thread owning the slot may call this.
+        VkCommandBuffer Acquire(size_t currentFrameIndex, std::uint32_t slot);
+    };
+}
+#endif //SMALLVKENGINE_THREADCOMMANDPOOLS_H
@@ -0,0 +1,42 @@
+//
+// Created by ghima on 19-10-2025.
+//
+
+#ifndef SMALLVKENGINE_UNIFORMRING_H
+#define SMALLVKENGINE_UNIFORMRING_H
+
+#include "MemoryAllocator.h"
+
+namespace rn {
+    struct UniformAllocation {
+        void *data;
+        // Offset into the ring buffer, passed as the dynamic offset when binding the descriptor set.
+        std::uint32_t offset;
+    };
+
+    // Per frame uniform data out of a LinearPool, aligned for dynamic uniform offsets.
+    class UniformRing {
+    private:
+        RendererContext *mCtx;
+        LinearPool *mPool;
+
+    public:
+        UniformRing(RendererContext *ctx, VkDeviceSize frameSize);
+
+        ~UniformRing();
+
+        void BeginFrame(size_t currentFrameIndex);
+
+        UniformAllocation Allocate(VkDeviceSize size);
+
+        template<typename T>
+        std::uint32_t Push(const T &value) {
+            UniformAllocation allocation = Allocate(sizeof(T));
+            memcpy(allocation.data, &value, sizeof(T));
+            return allocation.offset;
+        }
+
+        VkBuffer GetBuffer() const { return mPool->GetBuffer(); }
+    };
+}
+#endif //SMALLVKENGINE_UNIFORMRING_H
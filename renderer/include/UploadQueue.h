@@ -0,0 +1,106 @@
+//
+// Created by ghima on 22-10-2025.
+//
+
+#ifndef SMALLVKENGINE_UPLOADQUEUE_H
+#define SMALLVKENGINE_UPLOADQUEUE_H
+
+#include "Utility.h"
+#include "StagingRing.h"
+
+namespace rn {
+    using UploadTicket = std::uint64_t;
+    using StagingWriter = std::function<void(void *data)>;
+
+    // Batches buffer and image uploads through a staging ring into one submit per flush.
+    class UploadQueue {
+    private:
+        struct BufferUpload {
+            VkBuffer source;
+            VkBuffer buffer;
+            VkBufferCopy region;
+            VkPipelineStageFlags dstStage;
+            VkAccessFlags dstAccess;
+        };
+        struct ImageUpload {
+            VkBuffer source;
+            VkImage image;
+            std::uint32_t layerCount;
+            std::uint32_t mipLevels;
+            List<VkBufferImageCopy> regions;
+        };
+        struct Batch {
+            VkCommandBuffer transferCommandBuffer{};
+            VkCommandBuffer graphicsCommandBuffer{};
+            VkSemaphore ownershipSemaphore{};
+            VkFence fence{};
+            UploadTicket ticket = 0;
+            VkDeviceSize stagingEnd = 0;
+            List<VkBuffer> oversizedBuffers{};
+            List<MemoryAllocation> oversizedMemory{};
+        };
+
+        RendererContext *mCtx;
+        std::uint32_t mTransferQueueIndex;
+        VkQueue mTransferQueue;
+        bool mDedicatedTransferQueue;
+        VkCommandPool mTransferCommandPool{};
+        VkCommandPool mGraphicsCommandPool{};
+
+        StagingRing mStagingRing;
+
+        List<BufferUpload> mBufferUploads{};
+        List<ImageUpload> mImageUploads{};
+        Batch mOpenBatch{};
+        List<Batch> mInFlightBatches{};
+        List<Batch> mFreeBatches{};
+        UploadTicket mLastCompletedTicket = 0;
+
+        std::uint64_t mUploadCount = 0;
+        std::uint64_t mSubmitCount = 0;
+        std::uint64_t mStagingStallCount = 0;
+        mutable std::mutex mMutex;
+
+        StagingAllocation Stage(VkDeviceSize size, const StagingWriter &writer);
+
+        void PrepareBatch(Batch &batch);
+
+        void RecordTransfer(VkCommandBuffer commandBuffer);
+
+        void RecordAcquire(VkCommandBuffer commandBuffer);
+
+        void FlushLocked();
+
+        void RetireBatches(UploadTicket waitTicket);
+
+        void DestroyBatch(Batch &batch);
+
+    public:
+        UploadQueue(RendererContext *ctx, std::uint32_t transferQueueIndex, VkQueue transferQueue,
+                    VkDeviceSize stagingSize);
+
+        ~UploadQueue();
+
+        UploadTicket UploadBuffer(VkBuffer buffer, VkDeviceSize dstOffset, VkDeviceSize size,
+                                  VkPipelineStageFlags dstStage, VkAccessFlags dstAccess, const StagingWriter &writer);
+
+        UploadTicket UploadBuffer(VkBuffer buffer, VkDeviceSize dstOffset, const void *data, VkDeviceSize size,
+                                  VkPipelineStageFlags dstStage, VkAccessFlags dstAccess);
+
+        UploadTicket UploadImage(VkImage image, VkFormat format, std::uint32_t width, std::uint32_t height,
+                                 std::uint32_t layerCount, std::uint32_t mipLevels, const StagingWriter &writer);
+
+        UploadTicket UploadImage(VkImage image, std::uint32_t width, std::uint32_t height, const void *data,
+                                 VkDeviceSize size, std::uint32_t layerCount = 1);
+
+        // Submits everything recorded since the last flush, does not wait.
+        UploadTicket Flush();
+
+        bool IsComplete(UploadTicket ticket);
+
+        void Wait(UploadTicket ticket);
+
+        void LogStatistics() const;
+    };
+}
+#endif //SMALLVKENGINE_UPLOADQUEUE_H
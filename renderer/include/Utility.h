@@ -22,6 +22,40 @@ namespace rn {
     const std::uint32_t MAX_POINT_LIGHTS = 10;
     const std::uint32_t SHADOW_MAP_SIZE = 1024;
     const std::uint32_t SKY_BOX_RESOLUTION = 1024;
+    const std::uint32_t MAX_FRAMES_IN_FLIGHT = 2;
+    const std::uint32_t UNIFORM_RING_FRAME_SIZE = 4 * 1024 * 1024;
+    const bool USE_MULTIVIEW_POINT_SHADOWS = true;
+    const std::uint32_t MIN_OBJECTS_PER_RECORDING_JOB = 128;
+    const std::uint32_t GEOMETRY_ARENA_VERTEX_COUNT = 1 << 20;
+    const std::uint32_t GEOMETRY_ARENA_INDEX_COUNT = 1 << 21;
+    const std::uint32_t GEOMETRY_ARENA_SHORT_INDEX_COUNT = 1 << 22;
+    const bool STORE_VERTEX_COLORS = false;
+    const bool USE_INDIRECT_SCENE_DRAW = true;
+    const std::uint32_t INITIAL_INDIRECT_DRAW_OBJECTS = 16384;
+    const std::uint32_t INITIAL_FRAME_INSTANCES = 16384;
+    const bool USE_BINDLESS_TEXTURES = true;
+    const std::uint32_t MAX_BINDLESS_TEXTURES = 4096;
+    const bool SORT_SCENE_DRAWS = true;
+    const float DRAW_SORT_DEPTH_RANGE = 100.0f;
+    const VkDeviceSize MEMORY_BLOCK_SIZE = 64 * 1024 * 1024;
+    const VkDeviceSize DEDICATED_ALLOCATION_SIZE = 32 * 1024 * 1024;
+    const VkDeviceSize MIN_SIZE_CLASS = 1024;
+    const VkDeviceSize MAX_SIZE_CLASS = 256 * 1024;
+    const VkDeviceSize SIZE_CLASS_BLOCK_SIZE = 4 * 1024 * 1024;
+    const VkDeviceSize UPLOAD_STAGING_RING_SIZE = 64 * 1024 * 1024;
+    const std::uint32_t VERTEX_CACHE_SIZE = 16;
+    const float OVERDRAW_ACMR_THRESHOLD = 1.05f;
+    const bool OPTIMIZE_IMPORTED_MESHES = true;
+    const std::uint32_t MAX_MESH_LODS = 4;
+    const float MESH_LOD_REDUCTION = 0.5f;
+    const float MESH_LOD_MIN_REDUCTION = 0.85f;
+    const float MESH_LOD_MAX_ERROR = 0.02f;
+    const float MESH_LOD_BORDER_WEIGHT = 10.0f;
+    const float MESH_LOD_MIN_NORMAL_DOT = 0.2f;
+    const std::array<float, MAX_MESH_LODS - 1> MESH_LOD_SCREEN_SIZES = {0.3f, 0.15f, 0.07f};
+    const std::uint32_t SHADOW_LOD_BIAS = 1;
+    const std::uint32_t TEXTURE_BENCHMARK_FRAMES = 240;
+    const char *const COOKED_TEXTURE_EXTENSION = ".ctex";
 
     enum class AXIS {
         NONE = 0,
@@ -42,6 +76,13 @@ namespace rn {
         glm::vec2 uv;
         glm::vec3 normals;
     };
+    // Shading attributes, the position and the optional RGBA8 colour have streams of their own.
+    struct PackedVertex {
+        // Two half floats.
+        std::uint32_t uv;
+        // Octahedral encoding in two snorm16, decoded by the vertex shaders.
+        std::uint32_t normal;
+    };
     struct alignas(16) ViewProjection {
         glm::mat4 projection;
         glm::mat4 view;
@@ -50,6 +91,59 @@ namespace rn {
         glm::mat4 model;
         std::uint32_t pickId;
     };
+    // std430 element of the per-object storage buffer, indexed with the instance index of the indirect draw.
+    struct alignas(16) ObjectData {
+        glm::mat4 model;
+        std::uint32_t pickId;
+        // Slot of the object's texture in the BindlessTextureTable.
+        std::uint32_t textureIndex;
+        std::uint32_t _padding[2];
+    };
+
+    // Index and generation of an element in a SlotMap, Tag only keeps the handles of different registries apart.
+    template<typename Tag>
+    struct SlotHandle {
+        static constexpr std::uint32_t INVALID_INDEX = 0xFFFFFFFF;
+        std::uint32_t index = INVALID_INDEX;
+        std::uint32_t generation = 0;
+
+        bool IsValid() const { return index != INVALID_INDEX; }
+
+        bool operator==(const SlotHandle &other) const {
+            return index == other.index && generation == other.generation;
+        }
+
+        bool operator!=(const SlotHandle &other) const { return !(*this == other); }
+    };
+    using MeshHandle = SlotHandle<class StaticMesh>;
+    using TextureHandle = SlotHandle<class Texture>;
+    using LightHandle = SlotHandle<class PointLights>;
+
+    // Commands recorded for the scene of one frame, binds that would not change the state are skipped and not counted.
+    struct DrawStatistics {
+        std::uint32_t drawCalls = 0;
+        std::uint32_t pipelineBinds = 0;
+        std::uint32_t descriptorSetBinds = 0;
+        std::uint32_t vertexBufferBinds = 0;
+        std::uint32_t indexBufferBinds = 0;
+
+        DrawStatistics &operator+=(const DrawStatistics &other) {
+            drawCalls += other.drawCalls;
+            pipelineBinds += other.pipelineBinds;
+            descriptorSetBinds += other.descriptorSetBinds;
+            vertexBufferBinds += other.vertexBufferBinds;
+            indexBufferBinds += other.indexBufferBinds;
+            return *this;
+        }
+    };
+
+    // Objects and triangles of every level of detail in the last frame, shadow counts are per shadow view.
+    struct LodStatistics {
+        std::array<std::uint32_t, MAX_MESH_LODS> sceneObjects{};
+        std::array<std::uint64_t, MAX_MESH_LODS> sceneTriangles{};
+        std::array<std::uint32_t, MAX_MESH_LODS> shadowObjects{};
+        std::array<std::uint64_t, MAX_MESH_LODS> shadowTriangles{};
+    };
 
     struct ActiveGizmoAxis {
         std::uint32_t activeAxis;
@@ -80,6 +174,20 @@ namespace rn {
         float farPlane;
         float _padding[3];
     };
+    // A range of device memory handed out by the MemoryAllocator, resources are bound at memory + offset.
+    struct MemoryAllocation {
+        VkDeviceMemory memory = VK_NULL_HANDLE;
+        VkDeviceSize offset = 0;
+        VkDeviceSize size = 0;
+        // Points at offset, only set for host visible memory. Blocks stay mapped, never call vkMapMemory on memory.
+        void *mappedData = nullptr;
+        std::uint32_t memoryTypeIndex = 0;
+        // Owning block, null for dedicated allocations.
+        struct MemoryBlock *block = nullptr;
+        // Range reserved in the block including the alignment padding in front of offset.
+        VkDeviceSize reservedOffset = 0;
+        VkDeviceSize reservedSize = 0;
+    };
     struct RendererEvent {
         enum class Type {
             WINDOW_RESIZE,
@@ -94,6 +202,9 @@ namespace rn {
         uint32_t clickY;
     };
 
+    template<typename T, typename Tag>
+    class SlotMap;
+
     struct RendererContext {
         size_t swapChainImageCount;
         VkPhysicalDevice physicalDevice;
@@ -101,12 +212,31 @@ namespace rn {
         VkCommandPool commandPool;
         VkCommandBuffer mainCommandBuffer;
         VkQueue graphicsQueue;
+        // Queues are externally synchronized, every submit to graphicsQueue and every present holds this.
+        std::mutex *graphicsQueueMutex;
         VkQueue presentationQueue;
         std::uint32_t graphicsQueueIndex;
         VkRenderPass offScreenRenderPass;
         VkDescriptorPool samplerDescriptorPool;
         VkDescriptorSetLayout samplerDescriptorSetLayout;
         VkDescriptorSet *viewProjectionDescriptorSet;
+        // Dynamic offset of the camera view projection uploaded for the frame being recorded.
+        std::uint32_t viewProjectionOffset;
+        // Camera snapshot taken in the frame constants stage, every pass of the frame reads this one.
+        ViewProjection frameViewProjection;
+        class UniformRing *uniformRing;
+        // Every buffer and image of the renderer gets its memory from here.
+        class MemoryAllocator *memoryAllocator;
+        // Batches the copies of every buffer and image upload, flushed at the start of each frame.
+        class UploadQueue *uploadQueue;
+        // Recycled command buffers and fences for one-off graphics queue work, one command pool per thread.
+        class OneShotCommands *oneShotCommands;
+        // Every StaticMesh allocates its vertices and indices from this arena.
+        class GeometryArena *geometryArena;
+        // Per frame instance data of the instanced draws, the shadow passes bind it next to their own sets.
+        class InstanceBuffer *instanceBuffer;
+        // Only created when descriptor indexing was enabled, every Texture registers into it.
+        class BindlessTextureTable *bindlessTextureTable;
         VkSampler textureSampler;
         VkDescriptorSetLayout viewProjectionLayout;
         VkDescriptorSetLayout lightsLayout;
@@ -118,6 +248,14 @@ namespace rn {
         VkDescriptorPool pointLightShadowPool;
 
         class PointLights *pointLight;
+        // Collects the command buffers of the frame being recorded, submitted once by Graphics in EndFrame.
+        class FrameSubmission *frameSubmission;
+        // Persistent workers for parallel command recording.
+        class JobSystem *jobSystem;
+        // VK_KHR_multiview was enabled on the logical device.
+        bool multiviewSupported = false;
+        // textureCompressionBC was enabled on the logical device.
+        bool textureCompressionBCSupported = false;
 
         VkSwapchainKHR swapchain;
         VkFormat swapChainFormat;
@@ -129,13 +267,22 @@ namespace rn {
         bool beginGizmoDrag = false;
 
         size_t currentImageIndex;
+        // Index of the frame being recorded, in [0, MAX_FRAMES_IN_FLIGHT), used for the per-frame resources.
+        size_t currentFrameIndex;
         List<VkDescriptorSet> *imguiViewPortDescriptors;
 
-        void (*RegisterMesh)(std::string &id, class StaticMesh *);
+        // Meshes still registered are deleted with the Graphics, a mesh deleted earlier has to be unregistered first.
+        MeshHandle (*RegisterMesh)(class StaticMesh *mesh);
+
+        void (*UnregisterMesh)(MeshHandle handle);
+
+        SlotMap<class StaticMesh *, class StaticMesh> *(*GetSceneMeshes)();
 
-        Map<std::string, class StaticMesh *, std::hash<std::string>> *(*GetSceneObjectMap)();
+        // Counts of the last frame, owned by the Graphics.
+        const LodStatistics *(*GetLodStatistics)();
 
-        class Texture *(*RegisterTexture)(std::string &texturePathId);
+        // Loads the texture on the first call for a path, later calls return the same handle.
+        TextureHandle (*RegisterTexture)(std::string &texturePathId);
 
         void (*UpdateViewAndProjectionMatrix)(ViewProjection &&viewProjection);
 
@@ -154,9 +301,10 @@ namespace rn {
         GIZMO_TYPE (*GetGizmoType)();
 
         // Registered in the Point lights class constructor not in the graphics
-        std::uint32_t (*AddPointLight)(const PointLightInfo &info);
+        // Returns an invalid handle once MAX_POINT_LIGHTS lights were added.
+        LightHandle (*AddPointLight)(const PointLightInfo &info);
 
-        void (*UpdateLightInfoPosition)(const glm::vec4 &position, std::uint32_t lightId);
+        void (*UpdateLightInfoPosition)(const glm::vec4 &position, LightHandle light);
 
     };
 
@@ -186,41 +334,50 @@ namespace rn {
         }
 
         static void CreateBuffer(RendererContext &ctx, VkBuffer &buffer, VkBufferUsageFlags usageFlags,
-                                 VkDeviceMemory &bufferMemory, VkMemoryPropertyFlags bufferMemoryFlags,
+                                 MemoryAllocation &bufferMemory, VkMemoryPropertyFlags bufferMemoryFlags,
                                  VkDeviceSize requiredBufferSize, const std::string &bufferName);
 
+        static void DestroyBuffer(RendererContext &ctx, VkBuffer &buffer, MemoryAllocation &bufferMemory);
+
+        static void DestroyImage(RendererContext &ctx, VkImage &image, MemoryAllocation &imageMemory);
+
         static std::uint32_t FindMemoryIndices(VkPhysicalDevice physicalDevice, uint32_t allowedTypes,
                                                VkMemoryPropertyFlags requiredMemoryFlags,
                                                const std::string &bufferName);
 
+        // Blocking one-off work, backed by ctx.oneShotCommands. Use that directly to submit without waiting.
         static VkCommandBuffer BeginCommandBuffer(RendererContext ctx);
 
         static void SubmitCommandBuffer(RendererContext &ctx, VkCommandBuffer &commandBuffer);
 
-        static void CopyBuffers(RendererContext &ctx, VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize bufferSize);
+        // vkDeviceWaitIdle under the graphics queue mutex, the wait needs every queue to be externally synchronized.
+        static void WaitDeviceIdle(RendererContext &ctx);
 
         static std::uint8_t *LoadTextureImage(const char *fileName, int &width, int &height, VkDeviceSize &imageSize);
 
-        static void
-        CopyBufferToImage(RendererContext &ctx, VkBuffer srcBuffer, VkImage dstImage, uint32_t width, uint32_t height,
-                          VkImageAspectFlags aspectFlags, int baseArrayLayer = 0);
-
         static void
         TransitionImageLayout(RendererContext ctx, VkImage image, VkImageLayout oldLayout, VkImageLayout newLayout,
                               VkImageAspectFlags aspectFlags, int layerCount = 1, int baseLayer = 0);
 
         static VkImage
-        CreateImage(std::string &&imageName, VkPhysicalDevice physicalDevice, VkDevice logicalDevice,
+        CreateImage(std::string &&imageName, RendererContext &ctx,
                     unsigned int width, unsigned int height,
                     VkFormat format,
                     VkImageTiling imageTiling,
                     unsigned int imageUsageFlags, unsigned int memoryPropertyFlags,
-                    VkDeviceMemory &memory, int layers = 1, int flags = 0,
-                    VkImageLayout initialLayout = VK_IMAGE_LAYOUT_UNDEFINED);
+                    MemoryAllocation &memory, int layers = 1, int flags = 0,
+                    VkImageLayout initialLayout = VK_IMAGE_LAYOUT_UNDEFINED, std::uint32_t mipLevels = 1);
 
         static void CreateImageView(VkDevice logicalDevice, VkImage &image, VkFormat format, VkImageView &imageView,
                                     unsigned int imageAspect, int baseArrayLayer = 0, int layerCount = 1,
-                                    VkImageViewType viewType = VK_IMAGE_VIEW_TYPE_2D);
+                                    VkImageViewType viewType = VK_IMAGE_VIEW_TYPE_2D, std::uint32_t levelCount = 1);
+
+        // Levels of a full mip chain, down to 1x1.
+        static std::uint32_t GetMipLevelCount(std::uint32_t width, std::uint32_t height);
+
+        // Tightly packed size of one layer of the given mip level.
+        static VkDeviceSize GetImageLevelSize(VkFormat format, std::uint32_t width, std::uint32_t height,
+                                              std::uint32_t level);
 
         static VkShaderModule CreateShaderModule(VkDevice logicalDevice, const char *filePath);
     };
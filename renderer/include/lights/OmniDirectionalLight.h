@@ -11,16 +11,14 @@ namespace rn {
     class OmniDirectionalLight {
     private:
         RendererContext *mCtx;
-        List<VkBuffer> mLightBuffer{};
-        List<VkDeviceMemory> mLightBufferMemory{};
-        List<VkDescriptorSet> mLightDescriptorSets{};
+        // Points into the uniform ring, mLightUniformOffset selects this frame's copy.
+        VkDescriptorSet mLightDescriptorSet{};
+        std::uint32_t mLightUniformOffset = 0;
         struct OmniDirectionalInfo mLightInfo;
         struct ViewProjection mViewProjection{};
 
         class ShadowMap *mShadowMap;
 
-        void CreateLightBuffers();
-
         void CreateLightDescriptorSets();
 
     public:
@@ -32,10 +30,11 @@ namespace rn {
 
         const OmniDirectionalInfo GetOmniDirectionalInfo() const { return mLightInfo; }
 
-        void UpdateLightDescriptorSet(size_t currentImageIndex);
+        void UpdateLightDescriptorSet();
+
+        const VkDescriptorSet GetLightDescriptorSet() const { return mLightDescriptorSet; };
 
-        const VkDescriptorSet
-        GetLightDescriptorSets(size_t currentImageIndex) const { return mLightDescriptorSets[currentImageIndex]; };
+        std::uint32_t GetLightUniformOffset() const { return mLightUniformOffset; }
 
         ViewProjection &GetLightViewProjection();
 
@@ -6,6 +6,7 @@
 #define SMALLVKENGINE_POINTLIGHTSHADOWMAP_H
 
 #include "Utility.h"
+#include "InstanceBuffer.h"
 
 namespace rn {
     class PointLightShadowMap {
@@ -19,34 +20,49 @@ namespace rn {
         VkPipeline mPipeline{};
         VkImage mShadowImage{};
         VkImage mShadowImageDepth;
-        VkDeviceMemory mShadowImageDepthMemory{};
+        MemoryAllocation mShadowImageDepthMemory{};
         VkImageView mShadowImageDepthView{};
-        VkDeviceMemory mShadowImageMemory{};
+        MemoryAllocation mShadowImageMemory{};
         List<VkImageView> mShadowRendingImageViews{};
-        List<VkDeviceMemory> mShadowRenderingImageViewsMemory{};
         VkImageView mSamplerImageView{};
         VkSampler mShadowSampler{};
         List<VkFramebuffer> mFrameBuffers{};
         VkViewport mViewPort{};
         VkRect2D mScissors{};
-        VkPushConstantRange mModelPushConstant;
         VkSampler mSampler;
 
 
-        VkBuffer viewProjectionBuffer{};
-        VkDeviceMemory viewProjectionMemory{};
+        // Both bindings point into the uniform ring and are selected with dynamic offsets.
         VkDescriptorSet viewProjectionDescriptorSet{};
         VkDescriptorPool mDescriptorPool{};
         VkDescriptorSetLayout mDescriptorSetLayout{};
-
-        VkBuffer mLightDataBuffer{};
-        VkDeviceMemory mLightDataMemory{};
+        // Written once per frame by UpdateFaceUniforms, recording only selects them.
+        std::array<std::uint32_t, 6> mFaceViewProjectionOffsets{};
+        std::uint32_t mLightDataOffset = 0;
+
+        // Single pass path, all six faces are rendered as the views of one multiview render pass.
+        bool mUseMultiview = false;
+        VkRenderPass mMultiviewRenderPass{};
+        VkPipeline mMultiviewPipeline{};
+        VkImageView mMultiviewColorView{};
+        VkImageView mMultiviewDepthView{};
+        VkFramebuffer mMultiviewFrameBuffer{};
+        VkDescriptorSet mMultiviewDescriptorSet{};
+        std::uint32_t mCubeViewProjectionOffset = 0;
+
+        // Shadow casters of every face, the multiview path only uses the first list.
+        std::array<List<const class StaticMesh *>, 6> mFaceMeshes{};
+        List<InstanceRun> mInstanceRuns{};
 
         void CreateFrameBuffersImagesAndImageViews();
 
-        void CreateRenderPass();
+        void CreateMultiviewFrameBuffer();
+
+        void CreateRenderPass(VkRenderPass &renderPass, std::uint32_t viewMask);
 
-        void CreatePipeline();
+        void CreatePipelineLayout();
+
+        void CreatePipeline(VkRenderPass renderPass, const char *vertexShaderFile, VkPipeline &pipeline);
 
         void CreateSampler();
 
@@ -54,21 +70,42 @@ namespace rn {
 
         void CreateCommandBufferAndFences();
 
-        void UpdateDescriptorSet(const ViewProjection &viewProjection);
-
         void ComputePointLightViewProjection();
 
+        void SetViewportAndScissor(VkCommandBuffer commandBuffer);
+
+        void RecordSinglePassShadowFrame(VkCommandBuffer commandBuffer);
+
+        void RecordPerFaceShadowFrame(VkCommandBuffer commandBuffer);
+
+        // Binds the instance buffer set and the geometry arena buffers, after the view projection set.
+        void BindInstancesAndGeometry(VkCommandBuffer commandBuffer);
+
+        // World space bounding sphere of the mesh, xyz is the center and w the radius.
+        static glm::vec4 GetWorldBoundingSphere(const class StaticMesh *mesh);
+
+        bool IsInShadowRange(const glm::vec4 &worldSphere) const;
+
+        bool IsVisibleToFace(const glm::vec4 &worldSphere, int face) const;
+
     public:
         explicit PointLightShadowMap(RendererContext *ctx, PointLightInfo lightInfo);
 
         ~PointLightShadowMap();
 
+        // Culls the scene for this frame, returns the number of instances the recording allocates.
+        std::uint32_t CollectShadowCasters();
+
+        // Records the casters of the last CollectShadowCasters.
         void BeginPointShadowFrame(VkCommandBuffer commandBuffer);
 
         void EndFrame(VkCommandBuffer commandBuffer);
 
         void ImageTransition(VkCommandBuffer commandBuffer);
 
+        // Uploads the six face view projections and the light data for the frame, before any recording.
+        void UpdateFaceUniforms();
+
         // Getter;
         const VkSampler &GetSampler() const { return mSampler; };
 
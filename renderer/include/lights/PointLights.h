@@ -6,37 +6,41 @@
 #define SMALLVKENGINE_POINTLIGHTS_H
 
 #include "Utility.h"
+#include "SlotMap.h"
 
 namespace rn {
     class PointLights {
     private :
         static std::uint32_t mCurrentLightSizeCount;
         static struct PointLightUBO mPointLightUBO;
+        // Element of mPointLightUBO.infos and of mPointLightShadowMaps behind every handle given out.
+        static SlotMap<std::uint32_t, PointLights> mLightSlots;
         static RendererContext *mCtx;
-        List<VkBuffer> mPointLightsBuffer{};
-        List<VkDeviceMemory> mPointLightsMemory{};
-        List<VkDescriptorSet> mPointLightDescriptorSets{};
+        // Points into the uniform ring, mPointLightUniformOffset selects this frame's copy.
+        VkDescriptorSet mPointLightDescriptorSet{};
+        std::uint32_t mPointLightUniformOffset = 0;
         static List<VkDescriptorSet> mPointLightShadowDescriptorSets;
+        // Sets still missing a light added after they were written, each one is rewritten when its frame comes up.
+        static List<bool> mStaleShadowDescriptorSets;
         static List<class PointLightShadowMap *> mPointLightShadowMaps;
-        VkSemaphore mPointLightShadowMapSemaphore;
-        static VkFence renderShadowSceneFence;
-        static List<VkCommandBuffer> mShadowCommandBuffer;
-        static List<std::thread> mShadowMapThreads;
-        std::mutex mutex_;
-        List<VkCommandPool> mThreadedCommandPools{};
+        // Shadow recording runs as jobs, every job system slot records from its own pool.
+        class ThreadCommandPools *mShadowCommandPools = nullptr;
+        List<VkCommandBuffer> mRecordedShadowCommandBuffers{};
+        // Instances every shadow map draws this frame, summed to grow the instance buffer before the recording.
+        List<std::uint32_t> mShadowInstanceCounts{};
 
         static VkSampler mDummyShadowSampler;
         static VkImageView mDummyShadowImageview;
         VkImage mDummyShadowImage{};
-        VkDeviceMemory mDummyImageMemory{};
-
-        void CreatePointLightBuffers();
+        MemoryAllocation mDummyImageMemory{};
 
         void BindPointLightDescriptors();
 
-        static void BindPointLightShadowDescriptors();
+        static void AllocatePointLightShadowDescriptors();
+
+        // Only call once the fence of the frame has signalled, no command buffer may still read the set.
+        static void WritePointLightShadowDescriptors(size_t frameIndex);
 
-        void CreateShadowMapSemaphoreAndAllocateCommandbuffer();
 
         void CreateDummyShadowBindingContext();
 
@@ -46,22 +50,20 @@ namespace rn {
         ~PointLights();
 
 
-        void UpdatePointLightBuffers(size_t currentImageIndex);
+        void UpdatePointLightBuffers();
 
-        static std::uint32_t AddPointLight(const PointLightInfo &info);
+        static LightHandle AddPointLight(const PointLightInfo &info);
 
-        static void UpdateLightInfoPosition(const glm::vec4 &position, std::uint32_t lightId);
+        static void UpdateLightInfoPosition(const glm::vec4 &position, LightHandle light);
 
-        void RenderPointLightShadowScene();
+        void RenderPointLightShadowScene(size_t currentFrameIndex);
 
-        const VkSemaphore &GetShadowMapSemaphore() const { return mPointLightShadowMapSemaphore; }
+        const VkDescriptorSet &GetDescriptorSet() const { return mPointLightDescriptorSet; }
 
-        const VkDescriptorSet &GetDescriptorSet(size_t currentImageIndex) {
-            return mPointLightDescriptorSets[currentImageIndex];
-        }
+        std::uint32_t GetUniformOffset() const { return mPointLightUniformOffset; }
 
-        const VkDescriptorSet &GetShadowDescriptorSet(size_t currentImageIndex) {
-            return mPointLightShadowDescriptorSets[currentImageIndex];
+        const VkDescriptorSet &GetShadowDescriptorSet(size_t currentFrameIndex) {
+            return mPointLightShadowDescriptorSets[currentFrameIndex];
         }
     };
 }
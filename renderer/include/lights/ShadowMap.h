@@ -6,6 +6,8 @@
 #define SMALLVKENGINE_SHADOWMAP_H
 
 #include "Utility.h"
+#include "SlotMap.h"
+#include "InstanceBuffer.h"
 
 namespace rn {
     class ShadowMap {
@@ -19,11 +21,9 @@ namespace rn {
 
         VkImage mSceneImage{};
         VkImageView mSceneImageview{};
-        VkDeviceMemory mSceneImageMemory{};
+        MemoryAllocation mSceneImageMemory{};
         VkFramebuffer mShadowFrameBuffer{};
         List<VkFramebuffer> mShadowDebugFrameBuffers{};
-        VkBuffer mViewProjectionBuffer{};
-        VkDeviceMemory mViewProjectionMemory{};
         VkSampler mShadowSampler{};
         VkRenderPass mShadowRenderPass{};
         VkPipelineLayout mShadowPipelineLayout{};
@@ -31,25 +31,28 @@ namespace rn {
         VkViewport mViewPort{};
         VkRect2D mScissors{};
 
-        VkCommandBuffer mShadowCommandBuffer{};
-        VkSemaphore mShadowMapSemaphore{};
+        // Per frame in flight.
+        List<VkCommandBuffer> mShadowCommandBuffers{};
         VkFence mPresentationFinishFence{};
         VkSemaphore mGetNextImageSemaphore{};
         uint32_t mCurrentImageIndex;
 
-        VkPushConstantRange mModelPushConstant{};
         VkDescriptorSetLayout mShadowDescriptorLayout{};
         VkDescriptorPool mShadowDescriptorPool{};
         VkDescriptorSet mShadowDescriptorSet{};
+        std::uint32_t mViewProjectionOffset = 0;
 
         // Debug Image;
         VkBuffer mDebugBuffer{};
-        VkDeviceMemory mDebugBufferMemory{};
+        MemoryAllocation mDebugBufferMemory{};
 
-        Map<std::string, class StaticMesh *, std::hash<std::string>> *mObjectMap;
+        MeshRegistry *mMeshes;
+        // Scratch lists of the instanced draws, kept to reuse their storage.
+        List<const class StaticMesh *> mInstanceMeshes{};
+        List<InstanceRun> mInstanceRuns{};
     public:
         ShadowMap(RendererContext *ctx, OmniDirectionalLight *light, int width, int height,
-                  Map<std::string, StaticMesh *, std::hash<std::string>> *objectMap);
+                  MeshRegistry *meshes);
 
         ~ShadowMap();
 
@@ -65,9 +68,9 @@ namespace rn {
 
         void CreateDescriptorSet();
 
-        void BeginShadowFrame();
+        void BeginShadowFrame(size_t currentFrameIndex);
 
-        void EndShadowFrame();
+        void EndShadowFrame(size_t currentFrameIndex);
 
         void CreateCommandBuffer();
 
@@ -75,14 +78,13 @@ namespace rn {
 
         void WriteViewProjectionDescriptor();
 
+        // Called once per frame from the frame constants stage.
         void UpdateViewProjectionMatrix(const ViewProjection &viewProjection);
 
         void CreateSampler();
 
         void ReCreateResourcesForWindowResize();
 
-        const VkSemaphore &GetShadowMapSemaphore() const { return mShadowMapSemaphore; };
-
         void CreateDebugTransitions();
 
         void WriteDebugBufferToImage();
@@ -26,4 +26,6 @@
 #include <optional>
 #include <set>
 #include <unordered_map>
+#include <chrono>
+#include <mutex>
 
@@ -0,0 +1,113 @@
+//
+// Created by ghima on 22-10-2025.
+//
+#include "BindlessTextureTable.h"
+
+namespace rn {
+    BindlessTextureTable::BindlessTextureTable(RendererContext *ctx, std::uint32_t capacity)
+            : mCtx{ctx}, mCapacity{capacity} {
+        CreateLayout();
+        CreateDescriptorSet();
+    }
+
+    BindlessTextureTable::~BindlessTextureTable() {
+        vkDestroyDescriptorPool(mCtx->logicalDevice, mDescriptorPool, nullptr);
+        vkDestroyDescriptorSetLayout(mCtx->logicalDevice, mLayout, nullptr);
+    }
+
+    void BindlessTextureTable::CreateLayout() {
+        VkDescriptorSetLayoutBinding texturesBinding{};
+        texturesBinding.binding = 0;
+        texturesBinding.descriptorCount = mCapacity;
+        texturesBinding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        texturesBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+        texturesBinding.pImmutableSamplers = nullptr;
+
+        // Slots that were never registered are not accessed, and unused slots may change while a frame is pending.
+        VkDescriptorBindingFlagsEXT bindingFlags = VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT_EXT |
+                                                   VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT_EXT |
+                                                   VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT_EXT;
+        VkDescriptorSetLayoutBindingFlagsCreateInfoEXT bindingFlagsCreateInfo{};
+        bindingFlagsCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO_EXT;
+        bindingFlagsCreateInfo.bindingCount = 1;
+        bindingFlagsCreateInfo.pBindingFlags = &bindingFlags;
+
+        VkDescriptorSetLayoutCreateInfo layoutCreateInfo{};
+        layoutCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        layoutCreateInfo.pNext = &bindingFlagsCreateInfo;
+        layoutCreateInfo.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT_EXT;
+        layoutCreateInfo.bindingCount = 1;
+        layoutCreateInfo.pBindings = &texturesBinding;
+        Utility::CheckVulkanError(vkCreateDescriptorSetLayout(mCtx->logicalDevice, &layoutCreateInfo, nullptr,
+                                                              &mLayout),
+                                  "Failed to create the layout for the bindless texture table");
+    }
+
+    void BindlessTextureTable::CreateDescriptorSet() {
+        VkDescriptorPoolSize poolSize{};
+        poolSize.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        poolSize.descriptorCount = mCapacity;
+
+        VkDescriptorPoolCreateInfo poolCreateInfo{};
+        poolCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        poolCreateInfo.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT_EXT;
+        poolCreateInfo.maxSets = 1;
+        poolCreateInfo.poolSizeCount = 1;
+        poolCreateInfo.pPoolSizes = &poolSize;
+        Utility::CheckVulkanError(vkCreateDescriptorPool(mCtx->logicalDevice, &poolCreateInfo, nullptr,
+                                                         &mDescriptorPool),
+                                  "Failed to create the descriptor pool for the bindless texture table");
+
+        VkDescriptorSetAllocateInfo allocateInfo{};
+        allocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        allocateInfo.descriptorPool = mDescriptorPool;
+        allocateInfo.descriptorSetCount = 1;
+        allocateInfo.pSetLayouts = &mLayout;
+        Utility::CheckVulkanError(vkAllocateDescriptorSets(mCtx->logicalDevice, &allocateInfo, &mDescriptorSet),
+                                  "Failed to allocate the descriptor set of the bindless texture table");
+    }
+
+    std::uint32_t BindlessTextureTable::Register(VkImageView imageView, VkSampler sampler) {
+        std::uint32_t index;
+        {
+            std::lock_guard<std::mutex> guard{mMutex};
+            if (!mFreeIndices.empty()) {
+                index = mFreeIndices.back();
+                mFreeIndices.pop_back();
+            } else {
+                if (mNextIndex == mCapacity) {
+                    LOG_ERROR("Bindless texture table overflow, more than {} textures are registered", mCapacity);
+                    std::exit(EXIT_FAILURE);
+                }
+                index = mNextIndex++;
+            }
+        }
+        Update(index, imageView, sampler);
+        return index;
+    }
+
+    void BindlessTextureTable::Update(std::uint32_t index, VkImageView imageView, VkSampler sampler) {
+        VkDescriptorImageInfo imageInfo{};
+        imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        imageInfo.sampler = sampler;
+        imageInfo.imageView = imageView;
+
+        VkWriteDescriptorSet writeInfo{};
+        writeInfo.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        writeInfo.descriptorCount = 1;
+        writeInfo.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        writeInfo.dstSet = mDescriptorSet;
+        writeInfo.dstBinding = 0;
+        writeInfo.dstArrayElement = index;
+        writeInfo.pImageInfo = &imageInfo;
+
+        // The set is externally synchronized, writes to different slots still must not overlap.
+        std::lock_guard<std::mutex> guard{mMutex};
+        vkUpdateDescriptorSets(mCtx->logicalDevice, 1, &writeInfo, 0, nullptr);
+    }
+
+    void BindlessTextureTable::Release(std::uint32_t index) {
+        std::lock_guard<std::mutex> guard{mMutex};
+        mFreeIndices.push_back(index);
+    }
+}
@@ -0,0 +1,454 @@
+//
+// Created by ghima on 22-10-2025.
+//
+#include "BlockCompression.h"
+#include <cfloat>
+#include <cmath>
+
+namespace rn {
+    // Interpolation weights of the 4 bit BC7 indices, out of 64.
+    static const std::array<std::uint32_t, 16> BC7_WEIGHTS = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60,
+                                                              64};
+
+    // Fits a line through the first channelCount channels of the 16 texels and returns the extremes of the projection.
+    static void FitEndpoints(const std::uint8_t *texels, std::uint32_t channelCount, std::array<float, 4> &low,
+                             std::array<float, 4> &high) {
+        std::array<float, 4> mean{};
+        for (std::uint32_t texel = 0; texel < 16; texel++) {
+            for (std::uint32_t channel = 0; channel < channelCount; channel++) {
+                mean[channel] += texels[texel * 4 + channel] / 16.0f;
+            }
+        }
+        std::array<std::array<float, 4>, 4> covariance{};
+        for (std::uint32_t texel = 0; texel < 16; texel++) {
+            for (std::uint32_t row = 0; row < channelCount; row++) {
+                for (std::uint32_t column = 0; column < channelCount; column++) {
+                    covariance[row][column] += (texels[texel * 4 + row] - mean[row]) *
+                                               (texels[texel * 4 + column] - mean[column]);
+                }
+            }
+        }
+        // A few power iterations are enough to find the dominant direction of a 4x4 block.
+        std::array<float, 4> axis{1.0f, 1.0f, 1.0f, 1.0f};
+        for (std::uint32_t iteration = 0; iteration < 8; iteration++) {
+            std::array<float, 4> next{};
+            float length = 0.0f;
+            for (std::uint32_t row = 0; row < channelCount; row++) {
+                for (std::uint32_t column = 0; column < channelCount; column++) {
+                    next[row] += covariance[row][column] * axis[column];
+                }
+                length = std::max(length, std::abs(next[row]));
+            }
+            if (length < 1e-6f) {
+                break;
+            }
+            for (std::uint32_t channel = 0; channel < channelCount; channel++) {
+                axis[channel] = next[channel] / length;
+            }
+        }
+
+        float axisLength = 0.0f;
+        for (std::uint32_t channel = 0; channel < channelCount; channel++) {
+            axisLength += axis[channel] * axis[channel];
+        }
+        float minProjection = 0.0f;
+        float maxProjection = 0.0f;
+        if (axisLength > 1e-6f) {
+            minProjection = FLT_MAX;
+            maxProjection = -FLT_MAX;
+            for (std::uint32_t texel = 0; texel < 16; texel++) {
+                float projection = 0.0f;
+                for (std::uint32_t channel = 0; channel < channelCount; channel++) {
+                    projection += (texels[texel * 4 + channel] - mean[channel]) * axis[channel];
+                }
+                projection /= axisLength;
+                minProjection = std::min(minProjection, projection);
+                maxProjection = std::max(maxProjection, projection);
+            }
+        }
+        for (std::uint32_t channel = 0; channel < channelCount; channel++) {
+            low[channel] = std::clamp(mean[channel] + minProjection * axis[channel], 0.0f, 255.0f);
+            high[channel] = std::clamp(mean[channel] + maxProjection * axis[channel], 0.0f, 255.0f);
+        }
+    }
+
+    static std::uint16_t ToRGB565(const std::array<float, 4> &color) {
+        std::uint32_t red = static_cast<std::uint32_t>(color[0] * 31.0f / 255.0f + 0.5f);
+        std::uint32_t green = static_cast<std::uint32_t>(color[1] * 63.0f / 255.0f + 0.5f);
+        std::uint32_t blue = static_cast<std::uint32_t>(color[2] * 31.0f / 255.0f + 0.5f);
+        return static_cast<std::uint16_t>((red << 11) | (green << 5) | blue);
+    }
+
+    static std::array<std::uint32_t, 3> FromRGB565(std::uint16_t color) {
+        std::uint32_t red = (color >> 11) & 31;
+        std::uint32_t green = (color >> 5) & 63;
+        std::uint32_t blue = color & 31;
+        return {(red << 3) | (red >> 2), (green << 2) | (green >> 4), (blue << 3) | (blue >> 2)};
+    }
+
+    // Bits of a BC7 block are packed from the least significant bit of the first byte.
+    static void WriteBits(std::uint8_t *block, std::uint32_t &position, std::uint32_t value, std::uint32_t bitCount) {
+        for (std::uint32_t bit = 0; bit < bitCount; bit++, position++) {
+            if ((value >> bit) & 1) {
+                block[position >> 3] |= static_cast<std::uint8_t>(1 << (position & 7));
+            }
+        }
+    }
+
+    static std::uint32_t ReadBits(const std::uint8_t *block, std::uint32_t &position, std::uint32_t bitCount) {
+        std::uint32_t value = 0;
+        for (std::uint32_t bit = 0; bit < bitCount; bit++, position++) {
+            value |= ((block[position >> 3] >> (position & 7)) & 1) << bit;
+        }
+        return value;
+    }
+
+    void BlockCompression::EncodeBC1(const std::uint8_t *texels, std::uint8_t *block) {
+        std::array<float, 4> low{};
+        std::array<float, 4> high{};
+        FitEndpoints(texels, 3, low, high);
+        std::uint16_t color0 = ToRGB565(high);
+        std::uint16_t color1 = ToRGB565(low);
+        // color0 > color1 selects the four color mode, equal endpoints only ever use index 0.
+        if (color0 < color1) {
+            std::swap(color0, color1);
+        }
+        std::array<std::array<std::uint32_t, 3>, 4> palette{};
+        palette[0] = FromRGB565(color0);
+        palette[1] = FromRGB565(color1);
+        for (std::uint32_t channel = 0; channel < 3; channel++) {
+            palette[2][channel] = (2 * palette[0][channel] + palette[1][channel]) / 3;
+            palette[3][channel] = (palette[0][channel] + 2 * palette[1][channel]) / 3;
+        }
+
+        std::uint32_t indices = 0;
+        if (color0 != color1) {
+            for (std::uint32_t texel = 0; texel < 16; texel++) {
+                std::uint32_t bestIndex = 0;
+                std::int32_t bestError = INT32_MAX;
+                for (std::uint32_t index = 0; index < 4; index++) {
+                    std::int32_t error = 0;
+                    for (std::uint32_t channel = 0; channel < 3; channel++) {
+                        std::int32_t difference = static_cast<std::int32_t>(texels[texel * 4 + channel]) -
+                                                  static_cast<std::int32_t>(palette[index][channel]);
+                        error += difference * difference;
+                    }
+                    if (error < bestError) {
+                        bestError = error;
+                        bestIndex = index;
+                    }
+                }
+                indices |= bestIndex << (2 * texel);
+            }
+        }
+        block[0] = color0 & 0xFF;
+        block[1] = color0 >> 8;
+        block[2] = color1 & 0xFF;
+        block[3] = color1 >> 8;
+        for (std::uint32_t byte = 0; byte < 4; byte++) {
+            block[4 + byte] = (indices >> (8 * byte)) & 0xFF;
+        }
+    }
+
+    void BlockCompression::EncodeSingleChannel(const std::uint8_t *texels, std::uint32_t channel,
+                                               std::uint8_t *block) {
+        std::uint32_t minValue = 255;
+        std::uint32_t maxValue = 0;
+        for (std::uint32_t texel = 0; texel < 16; texel++) {
+            minValue = std::min<std::uint32_t>(minValue, texels[texel * 4 + channel]);
+            maxValue = std::max<std::uint32_t>(maxValue, texels[texel * 4 + channel]);
+        }
+        // value0 > value1 selects the eight value mode, the palette is value0, value1 and six steps in between.
+        std::array<std::uint32_t, 8> palette{maxValue, minValue};
+        for (std::uint32_t index = 2; index < 8; index++) {
+            palette[index] = ((8 - index) * maxValue + (index - 1) * minValue) / 7;
+        }
+
+        std::uint64_t indices = 0;
+        if (maxValue != minValue) {
+            for (std::uint32_t texel = 0; texel < 16; texel++) {
+                std::uint32_t bestIndex = 0;
+                std::int32_t bestError = INT32_MAX;
+                for (std::uint32_t index = 0; index < 8; index++) {
+                    std::int32_t error = std::abs(static_cast<std::int32_t>(texels[texel * 4 + channel]) -
+                                                  static_cast<std::int32_t>(palette[index]));
+                    if (error < bestError) {
+                        bestError = error;
+                        bestIndex = index;
+                    }
+                }
+                indices |= static_cast<std::uint64_t>(bestIndex) << (3 * texel);
+            }
+        }
+        block[0] = static_cast<std::uint8_t>(maxValue);
+        block[1] = static_cast<std::uint8_t>(minValue);
+        for (std::uint32_t byte = 0; byte < 6; byte++) {
+            block[2 + byte] = (indices >> (8 * byte)) & 0xFF;
+        }
+    }
+
+    void BlockCompression::EncodeBC7(const std::uint8_t *texels, std::uint8_t *block) {
+        std::array<float, 4> low{};
+        std::array<float, 4> high{};
+        FitEndpoints(texels, 4, low, high);
+
+        // Mode 6 endpoints are 7 bits per channel plus one shared p-bit per endpoint that becomes the lowest bit.
+        std::array<std::array<std::uint32_t, 4>, 2> quantized{};
+        std::array<std::uint32_t, 2> pBits{};
+        std::array<std::array<std::uint32_t, 4>, 2> endpoints{};
+        for (std::uint32_t endpoint = 0; endpoint < 2; endpoint++) {
+            const std::array<float, 4> &color = endpoint == 0 ? low : high;
+            float bestError = FLT_MAX;
+            for (std::uint32_t pBit = 0; pBit < 2; pBit++) {
+                std::array<std::uint32_t, 4> candidate{};
+                float error = 0.0f;
+                for (std::uint32_t channel = 0; channel < 4; channel++) {
+                    float value = std::round((color[channel] - pBit) / 2.0f);
+                    candidate[channel] = static_cast<std::uint32_t>(std::clamp(value, 0.0f, 127.0f));
+                    float difference = color[channel] - static_cast<float>((candidate[channel] << 1) | pBit);
+                    error += difference * difference;
+                }
+                if (error < bestError) {
+                    bestError = error;
+                    quantized[endpoint] = candidate;
+                    pBits[endpoint] = pBit;
+                }
+            }
+            for (std::uint32_t channel = 0; channel < 4; channel++) {
+                endpoints[endpoint][channel] = (quantized[endpoint][channel] << 1) | pBits[endpoint];
+            }
+        }
+
+        std::array<std::uint32_t, 16> indices{};
+        for (std::uint32_t texel = 0; texel < 16; texel++) {
+            std::int32_t bestError = INT32_MAX;
+            for (std::uint32_t index = 0; index < 16; index++) {
+                std::int32_t error = 0;
+                for (std::uint32_t channel = 0; channel < 4; channel++) {
+                    std::int32_t value = static_cast<std::int32_t>(
+                            ((64 - BC7_WEIGHTS[index]) * endpoints[0][channel] +
+                             BC7_WEIGHTS[index] * endpoints[1][channel] + 32) >> 6);
+                    std::int32_t difference = static_cast<std::int32_t>(texels[texel * 4 + channel]) - value;
+                    error += difference * difference;
+                }
+                if (error < bestError) {
+                    bestError = error;
+                    indices[texel] = index;
+                }
+            }
+        }
+        // The most significant index bit of the first texel is implied zero, swapping the endpoints guarantees it.
+        if (indices[0] >= 8) {
+            std::swap(quantized[0], quantized[1]);
+            std::swap(pBits[0], pBits[1]);
+            for (std::uint32_t &index: indices) {
+                index = 15 - index;
+            }
+        }
+
+        memset(block, 0, 16);
+        std::uint32_t position = 0;
+        WriteBits(block, position, 1 << 6, 7);
+        for (std::uint32_t channel = 0; channel < 4; channel++) {
+            WriteBits(block, position, quantized[0][channel], 7);
+            WriteBits(block, position, quantized[1][channel], 7);
+        }
+        WriteBits(block, position, pBits[0], 1);
+        WriteBits(block, position, pBits[1], 1);
+        for (std::uint32_t texel = 0; texel < 16; texel++) {
+            WriteBits(block, position, indices[texel], texel == 0 ? 3 : 4);
+        }
+    }
+
+    void BlockCompression::DecodeBC1(const std::uint8_t *block, std::uint8_t *texels, bool opaqueOnly) {
+        std::uint16_t color0 = block[0] | (block[1] << 8);
+        std::uint16_t color1 = block[2] | (block[3] << 8);
+        std::array<std::array<std::uint32_t, 4>, 4> palette{};
+        std::array<std::uint32_t, 3> rgb0 = FromRGB565(color0);
+        std::array<std::uint32_t, 3> rgb1 = FromRGB565(color1);
+        for (std::uint32_t channel = 0; channel < 3; channel++) {
+            palette[0][channel] = rgb0[channel];
+            palette[1][channel] = rgb1[channel];
+            if (color0 > color1 || opaqueOnly) {
+                palette[2][channel] = (2 * rgb0[channel] + rgb1[channel]) / 3;
+                palette[3][channel] = (rgb0[channel] + 2 * rgb1[channel]) / 3;
+            } else {
+                palette[2][channel] = (rgb0[channel] + rgb1[channel]) / 2;
+                palette[3][channel] = 0;
+            }
+        }
+        palette[0][3] = palette[1][3] = palette[2][3] = 255;
+        palette[3][3] = (color0 > color1 || opaqueOnly) ? 255 : 0;
+
+        std::uint32_t indices = block[4] | (block[5] << 8) | (block[6] << 16) | (block[7] << 24);
+        for (std::uint32_t texel = 0; texel < 16; texel++) {
+            std::uint32_t index = (indices >> (2 * texel)) & 3;
+            for (std::uint32_t channel = 0; channel < 4; channel++) {
+                texels[texel * 4 + channel] = static_cast<std::uint8_t>(palette[index][channel]);
+            }
+        }
+    }
+
+    void BlockCompression::DecodeSingleChannel(const std::uint8_t *block, std::uint32_t channel,
+                                               std::uint8_t *texels) {
+        std::uint32_t value0 = block[0];
+        std::uint32_t value1 = block[1];
+        std::array<std::uint32_t, 8> palette{value0, value1};
+        if (value0 > value1) {
+            for (std::uint32_t index = 2; index < 8; index++) {
+                palette[index] = ((8 - index) * value0 + (index - 1) * value1) / 7;
+            }
+        } else {
+            for (std::uint32_t index = 2; index < 6; index++) {
+                palette[index] = ((6 - index) * value0 + (index - 1) * value1) / 5;
+            }
+            palette[6] = 0;
+            palette[7] = 255;
+        }
+        std::uint64_t indices = 0;
+        for (std::uint32_t byte = 0; byte < 6; byte++) {
+            indices |= static_cast<std::uint64_t>(block[2 + byte]) << (8 * byte);
+        }
+        for (std::uint32_t texel = 0; texel < 16; texel++) {
+            texels[texel * 4 + channel] = static_cast<std::uint8_t>(palette[(indices >> (3 * texel)) & 7]);
+        }
+    }
+
+    void BlockCompression::DecodeBC7(const std::uint8_t *block, std::uint8_t *texels) {
+        // Only mode 6 is written by the cooker, any other mode shows up magenta instead of garbage.
+        if ((block[0] & 0x7F) != (1 << 6)) {
+            for (std::uint32_t texel = 0; texel < 16; texel++) {
+                texels[texel * 4 + 0] = 255;
+                texels[texel * 4 + 1] = 0;
+                texels[texel * 4 + 2] = 255;
+                texels[texel * 4 + 3] = 255;
+            }
+            return;
+        }
+        std::uint32_t position = 7;
+        std::array<std::array<std::uint32_t, 4>, 2> endpoints{};
+        for (std::uint32_t channel = 0; channel < 4; channel++) {
+            endpoints[0][channel] = ReadBits(block, position, 7) << 1;
+            endpoints[1][channel] = ReadBits(block, position, 7) << 1;
+        }
+        std::uint32_t pBit0 = ReadBits(block, position, 1);
+        std::uint32_t pBit1 = ReadBits(block, position, 1);
+        for (std::uint32_t channel = 0; channel < 4; channel++) {
+            endpoints[0][channel] |= pBit0;
+            endpoints[1][channel] |= pBit1;
+        }
+        for (std::uint32_t texel = 0; texel < 16; texel++) {
+            std::uint32_t index = ReadBits(block, position, texel == 0 ? 3 : 4);
+            for (std::uint32_t channel = 0; channel < 4; channel++) {
+                texels[texel * 4 + channel] = static_cast<std::uint8_t>(
+                        ((64 - BC7_WEIGHTS[index]) * endpoints[0][channel] +
+                         BC7_WEIGHTS[index] * endpoints[1][channel] + 32) >> 6);
+            }
+        }
+    }
+
+    bool BlockCompression::IsBlockCompressed(VkFormat format) {
+        return GetBlockSize(format) != 0;
+    }
+
+    VkDeviceSize BlockCompression::GetBlockSize(VkFormat format) {
+        switch (format) {
+            case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+            case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+                return 8;
+            case VK_FORMAT_BC3_UNORM_BLOCK:
+            case VK_FORMAT_BC3_SRGB_BLOCK:
+            case VK_FORMAT_BC5_UNORM_BLOCK:
+            case VK_FORMAT_BC7_UNORM_BLOCK:
+            case VK_FORMAT_BC7_SRGB_BLOCK:
+                return 16;
+            default:
+                return 0;
+        }
+    }
+
+    VkFormat BlockCompression::GetFallbackFormat(VkFormat format) {
+        switch (format) {
+            case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+            case VK_FORMAT_BC3_SRGB_BLOCK:
+            case VK_FORMAT_BC7_SRGB_BLOCK:
+                return VK_FORMAT_R8G8B8A8_SRGB;
+            default:
+                return VK_FORMAT_R8G8B8A8_UNORM;
+        }
+    }
+
+    void BlockCompression::CompressLevel(VkFormat format, const std::uint8_t *rgba, std::uint32_t width,
+                                         std::uint32_t height, std::uint8_t *blocks) {
+        VkDeviceSize blockSize = GetBlockSize(format);
+        std::array<std::uint8_t, 64> texels{};
+        for (std::uint32_t blockY = 0; blockY < height; blockY += 4) {
+            for (std::uint32_t blockX = 0; blockX < width; blockX += 4) {
+                for (std::uint32_t y = 0; y < 4; y++) {
+                    for (std::uint32_t x = 0; x < 4; x++) {
+                        std::uint32_t sourceX = std::min(blockX + x, width - 1);
+                        std::uint32_t sourceY = std::min(blockY + y, height - 1);
+                        memcpy(&texels[(y * 4 + x) * 4], &rgba[(sourceY * width + sourceX) * 4], 4);
+                    }
+                }
+                switch (format) {
+                    case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+                    case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+                        EncodeBC1(texels.data(), blocks);
+                        break;
+                    case VK_FORMAT_BC3_UNORM_BLOCK:
+                    case VK_FORMAT_BC3_SRGB_BLOCK:
+                        EncodeSingleChannel(texels.data(), 3, blocks);
+                        EncodeBC1(texels.data(), blocks + 8);
+                        break;
+                    case VK_FORMAT_BC5_UNORM_BLOCK:
+                        EncodeSingleChannel(texels.data(), 0, blocks);
+                        EncodeSingleChannel(texels.data(), 1, blocks + 8);
+                        break;
+                    default:
+                        EncodeBC7(texels.data(), blocks);
+                        break;
+                }
+                blocks += blockSize;
+            }
+        }
+    }
+
+    void BlockCompression::DecompressLevel(VkFormat format, const std::uint8_t *blocks, std::uint32_t width,
+                                           std::uint32_t height, std::uint8_t *rgba) {
+        VkDeviceSize blockSize = GetBlockSize(format);
+        std::array<std::uint8_t, 64> texels{};
+        for (std::uint32_t blockY = 0; blockY < height; blockY += 4) {
+            for (std::uint32_t blockX = 0; blockX < width; blockX += 4) {
+                switch (format) {
+                    case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+                    case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+                        DecodeBC1(blocks, texels.data(), false);
+                        break;
+                    case VK_FORMAT_BC3_UNORM_BLOCK:
+                    case VK_FORMAT_BC3_SRGB_BLOCK:
+                        DecodeBC1(blocks + 8, texels.data(), true);
+                        DecodeSingleChannel(blocks, 3, texels.data());
+                        break;
+                    case VK_FORMAT_BC5_UNORM_BLOCK:
+                        DecodeSingleChannel(blocks, 0, texels.data());
+                        DecodeSingleChannel(blocks + 8, 1, texels.data());
+                        for (std::uint32_t texel = 0; texel < 16; texel++) {
+                            texels[texel * 4 + 2] = 0;
+                            texels[texel * 4 + 3] = 255;
+                        }
+                        break;
+                    default:
+                        DecodeBC7(blocks, texels.data());
+                        break;
+                }
+                for (std::uint32_t y = 0; y < 4 && blockY + y < height; y++) {
+                    for (std::uint32_t x = 0; x < 4 && blockX + x < width; x++) {
+                        memcpy(&rgba[((blockY + y) * width + blockX + x) * 4], &texels[(y * 4 + x) * 4], 4);
+                    }
+                }
+                blocks += blockSize;
+            }
+        }
+    }
+}
@@ -0,0 +1,72 @@
+//
+// Created by ghima on 22-10-2025.
+//
+#include "CookedTexture.h"
+#include "BlockCompression.h"
+
+namespace rn {
+    bool CookedTexture::Write(const std::string &fileName, VkFormat format, std::uint32_t width, std::uint32_t height,
+                              const List<List<std::uint8_t>> &levels) {
+        std::ofstream stream{fileName, std::ios::binary | std::ios::trunc};
+        if (!stream) {
+            LOG_ERROR("Failed to open the cooked texture {} for writing", fileName);
+            return false;
+        }
+        CookedTextureHeader header{};
+        header.magic = MAGIC;
+        header.version = VERSION;
+        header.format = format;
+        header.width = width;
+        header.height = height;
+        header.levelCount = static_cast<std::uint32_t>(levels.size());
+
+        List<CookedTextureLevel> levelIndex(levels.size());
+        std::uint64_t offset = sizeof(CookedTextureHeader) + levels.size() * sizeof(CookedTextureLevel);
+        for (size_t level = 0; level < levels.size(); level++) {
+            levelIndex[level].offset = offset;
+            levelIndex[level].size = levels[level].size();
+            offset += levels[level].size();
+        }
+        stream.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        stream.write(reinterpret_cast<const char *>(levelIndex.data()), levelIndex.size() * sizeof(CookedTextureLevel));
+        for (const List<std::uint8_t> &level: levels) {
+            stream.write(reinterpret_cast<const char *>(level.data()), level.size());
+        }
+        if (!stream) {
+            LOG_ERROR("Failed to write the cooked texture {}", fileName);
+            return false;
+        }
+        return true;
+    }
+
+    bool CookedTexture::Open(const std::string &fileName, std::ifstream &stream, CookedTextureHeader &header,
+                             List<CookedTextureLevel> &levels) {
+        stream.open(fileName, std::ios::binary);
+        if (!stream) {
+            return false;
+        }
+        stream.read(reinterpret_cast<char *>(&header), sizeof(header));
+        VkFormat format = static_cast<VkFormat>(header.format);
+        bool knownFormat = BlockCompression::IsBlockCompressed(format) || format == VK_FORMAT_R8G8B8A8_SRGB ||
+                           format == VK_FORMAT_R8G8B8A8_UNORM;
+        if (!stream || header.magic != MAGIC || header.version != VERSION || !knownFormat || header.levelCount == 0 ||
+            header.levelCount > Utility::GetMipLevelCount(header.width, header.height)) {
+            LOG_WARN("Cooked texture {} has an unknown header, loading the source image instead", fileName);
+            return false;
+        }
+        levels.resize(header.levelCount);
+        stream.read(reinterpret_cast<char *>(levels.data()), levels.size() * sizeof(CookedTextureLevel));
+        // The upload reads all levels in one go, so they have to follow each other with the expected sizes.
+        std::uint64_t offset = sizeof(CookedTextureHeader) + levels.size() * sizeof(CookedTextureLevel);
+        for (std::uint32_t level = 0; level < header.levelCount && stream; level++) {
+            VkDeviceSize levelSize = Utility::GetImageLevelSize(format, header.width, header.height, level);
+            if (levels[level].offset != offset || levels[level].size != levelSize) {
+                LOG_WARN("Cooked texture {} has an unexpected level layout, loading the source image instead",
+                         fileName);
+                return false;
+            }
+            offset += levelSize;
+        }
+        return static_cast<bool>(stream);
+    }
+}
@@ -0,0 +1,38 @@
+//
+// Created by ghima on 22-10-2025.
+//
+#include "DeferredRelease.h"
+
+namespace rn {
+    DeferredRelease::DeferredRelease(RendererContext *ctx) : mCtx{ctx} {
+    }
+
+    DeferredRelease::~DeferredRelease() {
+        for (Entry &entry: mEntries) {
+            Release(entry);
+        }
+    }
+
+    void DeferredRelease::Release(Entry &entry) {
+        if (entry.descriptorPool != VK_NULL_HANDLE) {
+            vkDestroyDescriptorPool(mCtx->logicalDevice, entry.descriptorPool, nullptr);
+        }
+        Utility::DestroyBuffer(*mCtx, entry.buffer, entry.memory);
+    }
+
+    void DeferredRelease::Retire(VkBuffer buffer, const MemoryAllocation &memory, VkDescriptorPool descriptorPool) {
+        mEntries.push_back({buffer, memory, descriptorPool, MAX_FRAMES_IN_FLIGHT});
+    }
+
+    void DeferredRelease::BeginFrame() {
+        size_t kept = 0;
+        for (Entry &entry: mEntries) {
+            if (--entry.framesLeft == 0) {
+                Release(entry);
+            } else {
+                mEntries[kept++] = entry;
+            }
+        }
+        mEntries.resize(kept);
+    }
+}
@@ -0,0 +1,63 @@
+//
+// Created by ghima on 22-10-2025.
+//
+#include "DrawKeySorter.h"
+
+namespace rn {
+    std::uint64_t DrawKeySorter::MakeKey(std::uint32_t pipeline, VkIndexType indexType, std::uint32_t texture,
+                                         std::uint32_t mesh, float depth) {
+        const std::uint64_t depthMask = (1ull << DEPTH_BITS) - 1;
+        std::uint64_t quantizedDepth = static_cast<std::uint64_t>(std::clamp(depth, 0.0f, 1.0f) *
+                                                                  static_cast<float>(depthMask));
+        std::uint64_t key = pipeline & ((1u << PIPELINE_BITS) - 1);
+        key = (key << INDEX_TYPE_BITS) | (indexType == VK_INDEX_TYPE_UINT32 ? 1u : 0u);
+        key = (key << TEXTURE_BITS) | (texture & ((1u << TEXTURE_BITS) - 1));
+        key = (key << MESH_BITS) | (mesh & ((1u << MESH_BITS) - 1));
+        key = (key << DEPTH_BITS) | std::min(quantizedDepth, depthMask);
+        return key;
+    }
+
+    const List<std::uint32_t> &DrawKeySorter::Sort(const List<std::uint64_t> &keys) {
+        size_t count = keys.size();
+        mKeys.assign(keys.begin(), keys.end());
+        mKeyScratch.resize(count);
+        mOrder.resize(count);
+        mOrderScratch.resize(count);
+        for (std::uint32_t i = 0; i < count; i++) {
+            mOrder[i] = i;
+        }
+        if (count < 2) {
+            return mOrder;
+        }
+
+        // All eight histograms come from a single read of the keys.
+        std::array<std::array<std::uint32_t, 256>, 8> histograms{};
+        for (std::uint64_t key: mKeys) {
+            for (std::uint32_t digit = 0; digit < 8; digit++) {
+                histograms[digit][(key >> (digit * 8)) & 0xFF]++;
+            }
+        }
+        for (std::uint32_t digit = 0; digit < 8; digit++) {
+            std::array<std::uint32_t, 256> &histogram = histograms[digit];
+            std::uint32_t shift = digit * 8;
+            // Every key has the same value in this digit, the pass would not move anything.
+            if (histogram[(mKeys[0] >> shift) & 0xFF] == count) {
+                continue;
+            }
+            std::uint32_t offset = 0;
+            for (std::uint32_t &bucket: histogram) {
+                std::uint32_t bucketCount = bucket;
+                bucket = offset;
+                offset += bucketCount;
+            }
+            for (size_t i = 0; i < count; i++) {
+                std::uint32_t destination = histogram[(mKeys[i] >> shift) & 0xFF]++;
+                mKeyScratch[destination] = mKeys[i];
+                mOrderScratch[destination] = mOrder[i];
+            }
+            mKeys.swap(mKeyScratch);
+            mOrder.swap(mOrderScratch);
+        }
+        return mOrder;
+    }
+}
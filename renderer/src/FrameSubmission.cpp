@@ -0,0 +1,82 @@
+//
+// Created by ghima on 18-10-2025.
+//
+#include "FrameSubmission.h"
+
+namespace rn {
+    FrameSubmission::Batch &FrameSubmission::CurrentBatch() {
+        if (mBatchCount == 0) {
+            AppendBatch();
+        }
+        return mBatches[mBatchCount - 1];
+    }
+
+    void FrameSubmission::AppendBatch() {
+        if (mBatchCount == mBatches.size()) {
+            mBatches.emplace_back();
+        }
+        mBatchCount++;
+    }
+
+    void FrameSubmission::Begin() {
+        std::lock_guard<std::mutex> lockGuard{mMutex};
+        for (size_t i = 0; i < mBatchCount; i++) {
+            mBatches[i].commandBuffers.clear();
+            mBatches[i].waitSemaphores.clear();
+            mBatches[i].waitStages.clear();
+            mBatches[i].signalSemaphores.clear();
+        }
+        mBatchCount = 0;
+    }
+
+    void FrameSubmission::NextBatch() {
+        std::lock_guard<std::mutex> lockGuard{mMutex};
+        AppendBatch();
+    }
+
+    void FrameSubmission::AddCommandBuffer(VkCommandBuffer commandBuffer) {
+        std::lock_guard<std::mutex> lockGuard{mMutex};
+        CurrentBatch().commandBuffers.push_back(commandBuffer);
+    }
+
+    void FrameSubmission::AddCommandBuffers(const List<VkCommandBuffer> &commandBuffers) {
+        std::lock_guard<std::mutex> lockGuard{mMutex};
+        Batch &batch = CurrentBatch();
+        batch.commandBuffers.insert(batch.commandBuffers.end(), commandBuffers.begin(), commandBuffers.end());
+    }
+
+    void FrameSubmission::AddWaitSemaphore(VkSemaphore semaphore, VkPipelineStageFlags waitStage) {
+        std::lock_guard<std::mutex> lockGuard{mMutex};
+        Batch &batch = CurrentBatch();
+        batch.waitSemaphores.push_back(semaphore);
+        batch.waitStages.push_back(waitStage);
+    }
+
+    void FrameSubmission::AddSignalSemaphore(VkSemaphore semaphore) {
+        std::lock_guard<std::mutex> lockGuard{mMutex};
+        CurrentBatch().signalSemaphores.push_back(semaphore);
+    }
+
+    VkResult FrameSubmission::Submit(VkQueue queue, VkFence fence) {
+        std::lock_guard<std::mutex> lockGuard{mMutex};
+        mSubmitInfos.clear();
+        for (size_t i = 0; i < mBatchCount; i++) {
+            const Batch &batch = mBatches[i];
+            // Skipping the empty batches, e.g. the shadow batch of a scene without lights
+            if (batch.commandBuffers.empty() && batch.waitSemaphores.empty() && batch.signalSemaphores.empty()) {
+                continue;
+            }
+            VkSubmitInfo submitInfo{};
+            submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+            submitInfo.commandBufferCount = batch.commandBuffers.size();
+            submitInfo.pCommandBuffers = batch.commandBuffers.data();
+            submitInfo.waitSemaphoreCount = batch.waitSemaphores.size();
+            submitInfo.pWaitSemaphores = batch.waitSemaphores.data();
+            submitInfo.pWaitDstStageMask = batch.waitStages.data();
+            submitInfo.signalSemaphoreCount = batch.signalSemaphores.size();
+            submitInfo.pSignalSemaphores = batch.signalSemaphores.data();
+            mSubmitInfos.push_back(submitInfo);
+        }
+        return vkQueueSubmit(queue, mSubmitInfos.size(), mSubmitInfos.data(), fence);
+    }
+}
@@ -0,0 +1,273 @@
+//
+// Created by ghima on 22-10-2025.
+//
+#include "GeometryArena.h"
+#include "UploadQueue.h"
+
+namespace rn {
+    VkPipelineVertexInputStateCreateInfo VertexInputDescription::GetCreateInfo() const {
+        VkPipelineVertexInputStateCreateInfo createInfo{};
+        createInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+        createInfo.vertexBindingDescriptionCount = bindings.size();
+        createInfo.pVertexBindingDescriptions = bindings.data();
+        createInfo.vertexAttributeDescriptionCount = attributes.size();
+        createInfo.pVertexAttributeDescriptions = attributes.data();
+        return createInfo;
+    }
+
+    GeometryArena::GeometryArena(RendererContext *ctx, std::uint32_t vertexCount, std::uint32_t indexCount,
+                                 std::uint32_t shortIndexCount) : mCtx{ctx} {
+        VkBufferUsageFlags vertexUsage = VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
+        Utility::CreateBuffer(*mCtx, mPositionBuffer, vertexUsage, mPositionBufferMemory,
+                              VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                              sizeof(glm::vec3) * static_cast<VkDeviceSize>(vertexCount),
+                              "Geometry Arena Position Buffer");
+        Utility::CreateBuffer(*mCtx, mAttributeBuffer, vertexUsage, mAttributeBufferMemory,
+                              VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                              sizeof(PackedVertex) * static_cast<VkDeviceSize>(vertexCount),
+                              "Geometry Arena Attribute Buffer");
+        Utility::CreateBuffer(*mCtx, mColorBuffer, vertexUsage, mColorBufferMemory, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                              sizeof(std::uint32_t) * static_cast<VkDeviceSize>(STORE_VERTEX_COLORS ? vertexCount : 1),
+                              "Geometry Arena Color Buffer");
+        if (!STORE_VERTEX_COLORS) {
+            std::uint32_t white = glm::packUnorm4x8(glm::vec4{1.0f});
+            mCtx->uploadQueue->UploadBuffer(mColorBuffer, 0, &white, sizeof(white), VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+                                            VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT);
+        }
+        LOG_INFO("Geometry arena vertices : {} bytes for the shading passes, {} for the depth passes, {} unpacked",
+                 sizeof(glm::vec3) + sizeof(PackedVertex) + (STORE_VERTEX_COLORS ? sizeof(std::uint32_t) : 0),
+                 sizeof(glm::vec3), sizeof(Vertex));
+        Utility::CreateBuffer(*mCtx, mIndexBuffer,
+                              (VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT),
+                              mIndexBufferMemory, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                              sizeof(std::uint32_t) * static_cast<VkDeviceSize>(indexCount),
+                              "Geometry Arena Index Buffer");
+        Utility::CreateBuffer(*mCtx, mShortIndexBuffer,
+                              (VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT),
+                              mShortIndexBufferMemory, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                              sizeof(std::uint16_t) * static_cast<VkDeviceSize>(shortIndexCount),
+                              "Geometry Arena Short Index Buffer");
+        mFreeVertices.push_back({0, vertexCount});
+        mFreeIndices.push_back({0, indexCount});
+        mFreeShortIndices.push_back({0, shortIndexCount});
+    }
+
+    GeometryArena::~GeometryArena() {
+        Utility::DestroyBuffer(*mCtx, mPositionBuffer, mPositionBufferMemory);
+        Utility::DestroyBuffer(*mCtx, mAttributeBuffer, mAttributeBufferMemory);
+        Utility::DestroyBuffer(*mCtx, mColorBuffer, mColorBufferMemory);
+        Utility::DestroyBuffer(*mCtx, mIndexBuffer, mIndexBufferMemory);
+        Utility::DestroyBuffer(*mCtx, mShortIndexBuffer, mShortIndexBufferMemory);
+    }
+
+    bool GeometryArena::AllocateBlock(List<FreeBlock> &freeBlocks, std::uint32_t count, std::uint32_t &offset) {
+        // First fit, the blocks are kept sorted by offset.
+        for (size_t i = 0; i < freeBlocks.size(); i++) {
+            FreeBlock &block = freeBlocks[i];
+            if (block.count < count) {
+                continue;
+            }
+            offset = block.offset;
+            block.offset += count;
+            block.count -= count;
+            if (block.count == 0) {
+                freeBlocks.erase(freeBlocks.begin() + i);
+            }
+            return true;
+        }
+        return false;
+    }
+
+    void GeometryArena::ReleaseBlock(List<FreeBlock> &freeBlocks, std::uint32_t offset, std::uint32_t count) {
+        List<FreeBlock>::iterator next = std::lower_bound(freeBlocks.begin(), freeBlocks.end(), offset,
+                                                          [](const FreeBlock &block, std::uint32_t value) -> bool {
+                                                              return block.offset < value;
+                                                          });
+        next = freeBlocks.insert(next, {offset, count});
+        // Merging with the following block first, so the iterator to the released block stays valid.
+        if (next + 1 != freeBlocks.end() && next->offset + next->count == (next + 1)->offset) {
+            next->count += (next + 1)->count;
+            freeBlocks.erase(next + 1);
+        }
+        if (next != freeBlocks.begin() && (next - 1)->offset + (next - 1)->count == next->offset) {
+            (next - 1)->count += next->count;
+            freeBlocks.erase(next);
+        }
+    }
+
+    std::uint64_t GeometryArena::HashContent(const List<Vertex> &vertices, const List<std::uint32_t> &indices) {
+        // FNV-1a over the raw bytes, Vertex only holds floats so there is no padding in it.
+        std::uint64_t hash = 14695981039346656037ull;
+        const std::uint64_t prime = 1099511628211ull;
+        const std::uint8_t *vertexBytes = reinterpret_cast<const std::uint8_t *>(vertices.data());
+        for (size_t i = 0; i < sizeof(Vertex) * vertices.size(); i++) {
+            hash = (hash ^ vertexBytes[i]) * prime;
+        }
+        const std::uint8_t *indexBytes = reinterpret_cast<const std::uint8_t *>(indices.data());
+        for (size_t i = 0; i < sizeof(std::uint32_t) * indices.size(); i++) {
+            hash = (hash ^ indexBytes[i]) * prime;
+        }
+        return hash;
+    }
+
+    std::uint32_t GeometryArena::EncodeOctahedral(const glm::vec3 &normal) {
+        // Projects the normal onto the octahedron |x| + |y| + |z| = 1 and folds the lower half over the diagonals,
+        // so the whole sphere maps to the [-1, 1] square.
+        float length = std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+        if (length == 0.0f) {
+            return glm::packSnorm2x16(glm::vec2{0.0f});
+        }
+        glm::vec2 encoded = glm::vec2{normal} / length;
+        if (normal.z < 0.0f) {
+            glm::vec2 sign{encoded.x >= 0.0f ? 1.0f : -1.0f, encoded.y >= 0.0f ? 1.0f : -1.0f};
+            encoded = (1.0f - glm::abs(glm::vec2{encoded.y, encoded.x})) * sign;
+        }
+        return glm::packSnorm2x16(encoded);
+    }
+
+    VertexInputDescription GeometryArena::DescribeVertexInput(std::uint32_t attributes) {
+        VertexInputDescription description{};
+        description.bindings.push_back({0, sizeof(glm::vec3), VK_VERTEX_INPUT_RATE_VERTEX});
+        description.attributes.push_back({0, 0, VK_FORMAT_R32G32B32_SFLOAT, 0});
+        if ((attributes & (VERTEX_ATTRIBUTE_UV | VERTEX_ATTRIBUTE_NORMAL)) != 0) {
+            description.bindings.push_back({1, sizeof(PackedVertex), VK_VERTEX_INPUT_RATE_VERTEX});
+        }
+        if ((attributes & VERTEX_ATTRIBUTE_COLOR) != 0) {
+            // A zero stride makes every vertex read the single white element.
+            description.bindings.push_back({2, STORE_VERTEX_COLORS ? sizeof(std::uint32_t) : 0,
+                                            VK_VERTEX_INPUT_RATE_VERTEX});
+            description.attributes.push_back({1, 2, VK_FORMAT_R8G8B8A8_UNORM, 0});
+        }
+        if ((attributes & VERTEX_ATTRIBUTE_UV) != 0) {
+            description.attributes.push_back({2, 1, VK_FORMAT_R16G16_SFLOAT, offsetof(PackedVertex, uv)});
+        }
+        if ((attributes & VERTEX_ATTRIBUTE_NORMAL) != 0) {
+            description.attributes.push_back({3, 1, VK_FORMAT_R16G16_SNORM, offsetof(PackedVertex, normal)});
+        }
+        return description;
+    }
+
+    void GeometryArena::BindVertexBuffers(VkCommandBuffer commandBuffer, std::uint32_t attributes) const {
+        std::array<VkBuffer, 3> buffers{mPositionBuffer, mAttributeBuffer, mColorBuffer};
+        std::array<VkDeviceSize, 3> offsets{};
+        std::uint32_t bindingCount = attributes == VERTEX_ATTRIBUTE_POSITION ? 1 : buffers.size();
+        vkCmdBindVertexBuffers(commandBuffer, 0, bindingCount, buffers.data(), offsets.data());
+    }
+
+    GeometryRange GeometryArena::Allocate(const List<Vertex> &vertices, const List<std::uint32_t> &indices) {
+        GeometryRange range{};
+        range.vertexCount = vertices.size();
+        range.indexCount = indices.size();
+        // Every index of the mesh is below its vertex count, so 16 bits hold them up to 65536 vertices.
+        range.indexType = vertices.size() <= 65536 ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32;
+        range.contentHash = HashContent(vertices, indices);
+        {
+            std::lock_guard<std::mutex> guard{mMutex};
+            Map<std::uint64_t, SharedRange, std::hash<std::uint64_t>>::iterator shared = mSharedRanges.find(
+                    range.contentHash);
+            // The counts are compared as well, a hash collision between different meshes is then practically out.
+            if (shared != mSharedRanges.end() && shared->second.range.vertexCount == range.vertexCount &&
+                shared->second.range.indexCount == range.indexCount) {
+                shared->second.meshCount++;
+                return shared->second.range;
+            }
+            List<FreeBlock> &freeIndices = range.indexType == VK_INDEX_TYPE_UINT16 ? mFreeShortIndices : mFreeIndices;
+            if ((range.vertexCount > 0 && !AllocateBlock(mFreeVertices, range.vertexCount, range.firstVertex)) ||
+                (range.indexCount > 0 && !AllocateBlock(freeIndices, range.indexCount, range.firstIndex))) {
+                LOG_ERROR("Geometry arena is full, failed to allocate {} vertices and {} indices", range.vertexCount,
+                          range.indexCount);
+                std::exit(EXIT_FAILURE);
+            }
+            if (shared == mSharedRanges.end()) {
+                mSharedRanges[range.contentHash] = {range, 1};
+            }
+        }
+        // The copies land with the next flush of the upload queue, before the first frame that can draw the range.
+        // The streams are packed straight into the staging memory.
+        if (range.vertexCount > 0) {
+            VkDeviceSize firstVertex = range.firstVertex;
+            mCtx->uploadQueue->UploadBuffer(mPositionBuffer, sizeof(glm::vec3) * firstVertex,
+                                            sizeof(glm::vec3) * vertices.size(), VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+                                            VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT, [&vertices](void *staging) -> void {
+                        glm::vec3 *positions = static_cast<glm::vec3 *>(staging);
+                        for (size_t i = 0; i < vertices.size(); i++) {
+                            positions[i] = vertices[i].pos;
+                        }
+                    });
+            mCtx->uploadQueue->UploadBuffer(mAttributeBuffer, sizeof(PackedVertex) * firstVertex,
+                                            sizeof(PackedVertex) * vertices.size(), VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+                                            VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT, [&vertices](void *staging) -> void {
+                        PackedVertex *packed = static_cast<PackedVertex *>(staging);
+                        for (size_t i = 0; i < vertices.size(); i++) {
+                            packed[i].uv = glm::packHalf2x16(vertices[i].uv);
+                            packed[i].normal = EncodeOctahedral(vertices[i].normals);
+                        }
+                    });
+            if (STORE_VERTEX_COLORS) {
+                mCtx->uploadQueue->UploadBuffer(mColorBuffer, sizeof(std::uint32_t) * firstVertex,
+                                                sizeof(std::uint32_t) * vertices.size(),
+                                                VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+                                                VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT, [&vertices](void *staging) -> void {
+                            std::uint32_t *colors = static_cast<std::uint32_t *>(staging);
+                            for (size_t i = 0; i < vertices.size(); i++) {
+                                colors[i] = glm::packUnorm4x8(vertices[i].color);
+                            }
+                        });
+            }
+        }
+        if (range.indexCount > 0 && range.indexType == VK_INDEX_TYPE_UINT16) {
+            mCtx->uploadQueue->UploadBuffer(mShortIndexBuffer,
+                                            sizeof(std::uint16_t) * static_cast<VkDeviceSize>(range.firstIndex),
+                                            sizeof(std::uint16_t) * indices.size(), VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+                                            VK_ACCESS_INDEX_READ_BIT, [&indices](void *staging) -> void {
+                        std::uint16_t *shortIndices = static_cast<std::uint16_t *>(staging);
+                        for (size_t i = 0; i < indices.size(); i++) {
+                            shortIndices[i] = static_cast<std::uint16_t>(indices[i]);
+                        }
+                    });
+        } else if (range.indexCount > 0) {
+            mCtx->uploadQueue->UploadBuffer(mIndexBuffer,
+                                            sizeof(std::uint32_t) * static_cast<VkDeviceSize>(range.firstIndex),
+                                            indices.data(), sizeof(std::uint32_t) * indices.size(),
+                                            VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, VK_ACCESS_INDEX_READ_BIT);
+        }
+        return range;
+    }
+
+    void GeometryArena::Free(const GeometryRange &range) {
+        std::lock_guard<std::mutex> guard{mMutex};
+        Map<std::uint64_t, SharedRange, std::hash<std::uint64_t>>::iterator shared = mSharedRanges.find(
+                range.contentHash);
+        if (shared != mSharedRanges.end() && shared->second.range.firstIndex == range.firstIndex &&
+            shared->second.range.firstVertex == range.firstVertex) {
+            if (--shared->second.meshCount > 0) {
+                return;
+            }
+            mSharedRanges.erase(shared);
+        }
+        mPendingFrees.push_back({range, MAX_FRAMES_IN_FLIGHT});
+    }
+
+    void GeometryArena::BeginFrame() {
+        std::lock_guard<std::mutex> guard{mMutex};
+        size_t kept = 0;
+        for (PendingFree &pending: mPendingFrees) {
+            if (--pending.framesLeft == 0) {
+                ReleaseRange(pending.range);
+            } else {
+                mPendingFrees[kept++] = pending;
+            }
+        }
+        mPendingFrees.resize(kept);
+    }
+
+    void GeometryArena::ReleaseRange(const GeometryRange &range) {
+        if (range.vertexCount > 0) {
+            ReleaseBlock(mFreeVertices, range.firstVertex, range.vertexCount);
+        }
+        if (range.indexCount > 0) {
+            ReleaseBlock(range.indexType == VK_INDEX_TYPE_UINT16 ? mFreeShortIndices : mFreeIndices, range.firstIndex,
+                         range.indexCount);
+        }
+    }
+}
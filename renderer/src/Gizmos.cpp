@@ -32,37 +32,9 @@ namespace rn {
 
         List<VkPipelineShaderStageCreateInfo> shaderStages{vertexShaderStage, fragShaderStage};
 
-        VkVertexInputBindingDescription vertexInputBindingDescription{};
-        vertexInputBindingDescription.binding = 0;
-        vertexInputBindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
-        vertexInputBindingDescription.stride = sizeof(Vertex);
-
-        VkVertexInputAttributeDescription positionAttribute{};
-        positionAttribute.binding = 0;
-        positionAttribute.format = VK_FORMAT_R32G32B32_SFLOAT;
-        positionAttribute.offset = offsetof(Vertex, pos);
-        positionAttribute.location = 0;
-
-        VkVertexInputAttributeDescription colorAttribute{};
-        colorAttribute.binding = 0;
-        colorAttribute.format = VK_FORMAT_R32G32B32A32_SFLOAT;
-        colorAttribute.offset = offsetof(Vertex, color);
-        colorAttribute.location = 1;
-
-        VkVertexInputAttributeDescription uvAttribute{};
-        uvAttribute.binding = 0;
-        uvAttribute.format = VK_FORMAT_R32G32_SFLOAT;
-        uvAttribute.offset = offsetof(Vertex, uv);
-        uvAttribute.location = 2;
-
-        VkVertexInputAttributeDescription normalAttribute{};
-        normalAttribute.binding = 0;
-        normalAttribute.format = VK_FORMAT_R32G32B32_SFLOAT;
-        normalAttribute.offset = offsetof(Vertex, normals);
-        normalAttribute.location = 3;
-
-        List<VkVertexInputAttributeDescription> inputAttributes{positionAttribute, colorAttribute, uvAttribute,
-                                                                normalAttribute};
+        // The axis is stored in uv.x, the shader derives the colour and the pick id from it.
+        VertexInputDescription vertexInput = GeometryArena::DescribeVertexInput(VERTEX_ATTRIBUTE_POSITION |
+                                                                                VERTEX_ATTRIBUTE_UV);
 
         mViewport.x = 0;
         mViewport.y = 0;
@@ -81,12 +53,7 @@ namespace rn {
         viewportStateCreateInfo.scissorCount = 1;
         viewportStateCreateInfo.pScissors = &mScissors;
 
-        VkPipelineVertexInputStateCreateInfo vertexInputStateCreateInfo{};
-        vertexInputStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-        vertexInputStateCreateInfo.vertexBindingDescriptionCount = 1;
-        vertexInputStateCreateInfo.pVertexBindingDescriptions = &vertexInputBindingDescription;
-        vertexInputStateCreateInfo.vertexAttributeDescriptionCount = inputAttributes.size();
-        vertexInputStateCreateInfo.pVertexAttributeDescriptions = inputAttributes.data();
+        VkPipelineVertexInputStateCreateInfo vertexInputStateCreateInfo = vertexInput.GetCreateInfo();
 
         VkPipelineInputAssemblyStateCreateInfo inputAssemblyStateCreateInfo{};
         inputAssemblyStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
@@ -196,95 +163,95 @@ namespace rn {
     void Gizmos::SetUpMesh() {
         List<Vertex> gizmoVertices = {
                 // X Axis (Red)
-                {{0.0f,             0.0f,             0.0f},             {1.0f, 0.2f, 0.2f, 1.0f}, {1001.0f, 0.0f}, {0.0f, 0.0f, 1.0f}},  // start
-                {{AXIS_LENGTH,      0.0f,             0.0f},             {1.0f, 0.2f, 0.2f, 1.0f}, {1001.0f, 0.0f}, {0.0f, 0.0f, 1.0f}}, // end
+                {{0.0f,             0.0f,             0.0f},             {1.0f, 0.2f, 0.2f, 1.0f}, {1.0f, 0.0f}, {0.0f, 0.0f, 1.0f}},  // start
+                {{AXIS_LENGTH,      0.0f,             0.0f},             {1.0f, 0.2f, 0.2f, 1.0f}, {1.0f, 0.0f}, {0.0f, 0.0f, 1.0f}}, // end
 
                 // Y Axis (Green)
-                {{0.0f,             0.0f,             0.0f},             {0.2f, 1.0f, 0.2f, 1.0f}, {2002.0f, 0.0f}, {0.0f, 0.0f, 1.0f}},  // start
-                {{0.0f,             AXIS_LENGTH,      0.0f},             {0.2f, 1.0f, 0.2f, 1.0f}, {2002.0f, 0.0f}, {0.0f, 0.0f, 1.0f}}, // end
+                {{0.0f,             0.0f,             0.0f},             {0.2f, 1.0f, 0.2f, 1.0f}, {2.0f, 0.0f}, {0.0f, 0.0f, 1.0f}},  // start
+                {{0.0f,             AXIS_LENGTH,      0.0f},             {0.2f, 1.0f, 0.2f, 1.0f}, {2.0f, 0.0f}, {0.0f, 0.0f, 1.0f}}, // end
 
                 // Z Axis (Blue)
-                {{0.0f,             0.0f,             0.0f},             {0.2f, 0.2f, 1.0f, 1.0f}, {3003.0f, 0.0f}, {0.0f, 0.0f, 1.0f}},  // start
-                {{0.0f,             0.0f,             -AXIS_LENGTH},      {0.2f, 0.2f, 1.0f, 1.0f}, {3003.0f, 0.0f}, {0.0f, 0.0f, 1.0f}}, // end
+                {{0.0f,             0.0f,             0.0f},             {0.2f, 0.2f, 1.0f, 1.0f}, {3.0f, 0.0f}, {0.0f, 0.0f, 1.0f}},  // start
+                {{0.0f,             0.0f,             -AXIS_LENGTH},      {0.2f, 0.2f, 1.0f, 1.0f}, {3.0f, 0.0f}, {0.0f, 0.0f, 1.0f}}, // end
 
                 // Triangles on Top of the lines;
                 // tip
                 {{AXIS_LENGTH +
-                  ARROW_TIP_LENGTH, 0.0f,             0.0f},             {1.0f, 0.2f, 0.2f, 1.0f}, {1001.0f, 0.0f}, {0.0f, 0.0f, 1.0f}},
+                  ARROW_TIP_LENGTH, 0.0f,             0.0f},             {1.0f, 0.2f, 0.2f, 1.0f}, {1.0f, 0.0f}, {0.0f, 0.0f, 1.0f}},
                 // base upper
-                {{AXIS_LENGTH,      ARROW_BASE_SIZE,  0.0f},             {1.0f, 0.2f, 0.2f, 1.0f}, {1001.0f, 0.0f}, {0.0f, 0.0f, 1.0f}},
+                {{AXIS_LENGTH,      ARROW_BASE_SIZE,  0.0f},             {1.0f, 0.2f, 0.2f, 1.0f}, {1.0f, 0.0f}, {0.0f, 0.0f, 1.0f}},
                 // base lower
-                {{AXIS_LENGTH,      -ARROW_BASE_SIZE, 0.0f},             {1.0f, 0.2f, 0.2f, 1.0f}, {1001.0f, 0.0f}, {0.0f, 0.0f, 1.0f}},
+                {{AXIS_LENGTH,      -ARROW_BASE_SIZE, 0.0f},             {1.0f, 0.2f, 0.2f, 1.0f}, {1.0f, 0.0f}, {0.0f, 0.0f, 1.0f}},
 
                 // tip
                 {{0.0f,             AXIS_LENGTH +
-                                    ARROW_TIP_LENGTH, 0.0f},             {0.2f, 1.0f, 0.2f, 1.0f}, {2002.0f, 0.0f}, {0.0f, 0.0f, 1.0f}},
+                                    ARROW_TIP_LENGTH, 0.0f},             {0.2f, 1.0f, 0.2f, 1.0f}, {2.0f, 0.0f}, {0.0f, 0.0f, 1.0f}},
                 // base right
-                {{ARROW_BASE_SIZE,  AXIS_LENGTH,      0.0f},             {0.2f, 1.0f, 0.2f, 1.0f}, {2002.0f, 0.0f}, {0.0f, 0.0f, 1.0f}},
+                {{ARROW_BASE_SIZE,  AXIS_LENGTH,      0.0f},             {0.2f, 1.0f, 0.2f, 1.0f}, {2.0f, 0.0f}, {0.0f, 0.0f, 1.0f}},
                 // base left
-                {{-ARROW_BASE_SIZE, AXIS_LENGTH,      0.0f},             {0.2f, 1.0f, 0.2f, 1.0f}, {2002.0f, 0.0f}, {0.0f, 0.0f, 1.0f}},
+                {{-ARROW_BASE_SIZE, AXIS_LENGTH,      0.0f},             {0.2f, 1.0f, 0.2f, 1.0f}, {2.0f, 0.0f}, {0.0f, 0.0f, 1.0f}},
 
                 // tip
                 {{0.0f,             0.0f,             -(AXIS_LENGTH +
-                                                      ARROW_TIP_LENGTH)}, {0.2f, 0.2f, 1.0f, 1.0f}, {3003.0f, 0.0f}, {0.0f, 0.0f, 1.0f}},
+                                                      ARROW_TIP_LENGTH)}, {0.2f, 0.2f, 1.0f, 1.0f}, {3.0f, 0.0f}, {0.0f, 0.0f, 1.0f}},
                 // base top
-                {{0.0f,             ARROW_BASE_SIZE,  -AXIS_LENGTH},      {0.2f, 0.2f, 1.0f, 1.0f}, {3003.0f, 0.0f}, {0.0f, 0.0f, 1.0f}},
+                {{0.0f,             ARROW_BASE_SIZE,  -AXIS_LENGTH},      {0.2f, 0.2f, 1.0f, 1.0f}, {3.0f, 0.0f}, {0.0f, 0.0f, 1.0f}},
                 // base bottom
-                {{0.0f,             -ARROW_BASE_SIZE, -AXIS_LENGTH},      {0.2f, 0.2f, 1.0f, 1.0f}, {3003.0f, 0.0f}, {0.0f, 0.0f, 1.0f}},
+                {{0.0f,             -ARROW_BASE_SIZE, -AXIS_LENGTH},      {0.2f, 0.2f, 1.0f, 1.0f}, {3.0f, 0.0f}, {0.0f, 0.0f, 1.0f}},
 
                 // X axis scale cube (Red)
                 {{AXIS_LENGTH -
-                  CUBE_SIZE,        -CUBE_SIZE,       -CUBE_SIZE},       {1.0f, 0.2f, 0.2f, 1.0f}, {1001.0f, 0},    {0,    0,    1}},
+                  CUBE_SIZE,        -CUBE_SIZE,       -CUBE_SIZE},       {1.0f, 0.2f, 0.2f, 1.0f}, {1.0f, 0},    {0,    0,    1}},
                 {{AXIS_LENGTH +
-                  CUBE_SIZE,        -CUBE_SIZE,       -CUBE_SIZE},       {1.0f, 0.2f, 0.2f, 1.0f}, {1001.0f, 0},    {0,    0,    1}},
+                  CUBE_SIZE,        -CUBE_SIZE,       -CUBE_SIZE},       {1.0f, 0.2f, 0.2f, 1.0f}, {1.0f, 0},    {0,    0,    1}},
                 {{AXIS_LENGTH +
-                  CUBE_SIZE,        CUBE_SIZE,        -CUBE_SIZE},       {1.0f, 0.2f, 0.2f, 1.0f}, {1001.0f, 0},    {0,    0,    1}},
+                  CUBE_SIZE,        CUBE_SIZE,        -CUBE_SIZE},       {1.0f, 0.2f, 0.2f, 1.0f}, {1.0f, 0},    {0,    0,    1}},
                 {{AXIS_LENGTH -
-                  CUBE_SIZE,        CUBE_SIZE,        -CUBE_SIZE},       {1.0f, 0.2f, 0.2f, 1.0f}, {1001.0f, 0},    {0,    0,    1}},
+                  CUBE_SIZE,        CUBE_SIZE,        -CUBE_SIZE},       {1.0f, 0.2f, 0.2f, 1.0f}, {1.0f, 0},    {0,    0,    1}},
                 {{AXIS_LENGTH -
-                  CUBE_SIZE,        -CUBE_SIZE,       CUBE_SIZE},        {1.0f, 0.2f, 0.2f, 1.0f}, {1001.0f, 0},    {0,    0,    1}},
+                  CUBE_SIZE,        -CUBE_SIZE,       CUBE_SIZE},        {1.0f, 0.2f, 0.2f, 1.0f}, {1.0f, 0},    {0,    0,    1}},
                 {{AXIS_LENGTH +
-                  CUBE_SIZE,        -CUBE_SIZE,       CUBE_SIZE},        {1.0f, 0.2f, 0.2f, 1.0f}, {1001.0f, 0},    {0,    0,    1}},
+                  CUBE_SIZE,        -CUBE_SIZE,       CUBE_SIZE},        {1.0f, 0.2f, 0.2f, 1.0f}, {1.0f, 0},    {0,    0,    1}},
                 {{AXIS_LENGTH +
-                  CUBE_SIZE,        CUBE_SIZE,        CUBE_SIZE},        {1.0f, 0.2f, 0.2f, 1.0f}, {1001.0f, 0},    {0,    0,    1}},
+                  CUBE_SIZE,        CUBE_SIZE,        CUBE_SIZE},        {1.0f, 0.2f, 0.2f, 1.0f}, {1.0f, 0},    {0,    0,    1}},
                 {{AXIS_LENGTH -
-                  CUBE_SIZE,        CUBE_SIZE,        CUBE_SIZE},        {1.0f, 0.2f, 0.2f, 1.0f}, {1001.0f, 0},    {0,    0,    1}},
+                  CUBE_SIZE,        CUBE_SIZE,        CUBE_SIZE},        {1.0f, 0.2f, 0.2f, 1.0f}, {1.0f, 0},    {0,    0,    1}},
 
                 // Y axis scale cube (Green)
                 {{-CUBE_SIZE,       AXIS_LENGTH -
-                                    CUBE_SIZE,        -CUBE_SIZE},       {0.2f, 1.0f, 0.2f, 1.0f}, {2002.0f, 0},    {0,    0,    1}},
+                                    CUBE_SIZE,        -CUBE_SIZE},       {0.2f, 1.0f, 0.2f, 1.0f}, {2.0f, 0},    {0,    0,    1}},
                 {{CUBE_SIZE,        AXIS_LENGTH -
-                                    CUBE_SIZE,        -CUBE_SIZE},       {0.2f, 1.0f, 0.2f, 1.0f}, {2002.0f, 0},    {0,    0,    1}},
+                                    CUBE_SIZE,        -CUBE_SIZE},       {0.2f, 1.0f, 0.2f, 1.0f}, {2.0f, 0},    {0,    0,    1}},
                 {{CUBE_SIZE,        AXIS_LENGTH +
-                                    CUBE_SIZE,        -CUBE_SIZE},       {0.2f, 1.0f, 0.2f, 1.0f}, {2002.0f, 0},    {0,    0,    1}},
+                                    CUBE_SIZE,        -CUBE_SIZE},       {0.2f, 1.0f, 0.2f, 1.0f}, {2.0f, 0},    {0,    0,    1}},
                 {{-CUBE_SIZE,       AXIS_LENGTH +
-                                    CUBE_SIZE,        -CUBE_SIZE},       {0.2f, 1.0f, 0.2f, 1.0f}, {2002.0f, 0},    {0,    0,    1}},
+                                    CUBE_SIZE,        -CUBE_SIZE},       {0.2f, 1.0f, 0.2f, 1.0f}, {2.0f, 0},    {0,    0,    1}},
                 {{-CUBE_SIZE,       AXIS_LENGTH -
-                                    CUBE_SIZE,        CUBE_SIZE},        {0.2f, 1.0f, 0.2f, 1.0f}, {2002.0f, 0},    {0,    0,    1}},
+                                    CUBE_SIZE,        CUBE_SIZE},        {0.2f, 1.0f, 0.2f, 1.0f}, {2.0f, 0},    {0,    0,    1}},
                 {{CUBE_SIZE,        AXIS_LENGTH -
-                                    CUBE_SIZE,        CUBE_SIZE},        {0.2f, 1.0f, 0.2f, 1.0f}, {2002.0f, 0},    {0,    0,    1}},
+                                    CUBE_SIZE,        CUBE_SIZE},        {0.2f, 1.0f, 0.2f, 1.0f}, {2.0f, 0},    {0,    0,    1}},
                 {{CUBE_SIZE,        AXIS_LENGTH +
-                                    CUBE_SIZE,        CUBE_SIZE},        {0.2f, 1.0f, 0.2f, 1.0f}, {2002.0f, 0},    {0,    0,    1}},
+                                    CUBE_SIZE,        CUBE_SIZE},        {0.2f, 1.0f, 0.2f, 1.0f}, {2.0f, 0},    {0,    0,    1}},
                 {{-CUBE_SIZE,       AXIS_LENGTH +
-                                    CUBE_SIZE,        CUBE_SIZE},        {0.2f, 1.0f, 0.2f, 1.0f}, {2002.0f, 0},    {0,    0,    1}},
+                                    CUBE_SIZE,        CUBE_SIZE},        {0.2f, 1.0f, 0.2f, 1.0f}, {2.0f, 0},    {0,    0,    1}},
 
                 // Z axis scale cube (Blue)
                 {{-CUBE_SIZE,       -CUBE_SIZE,       -(AXIS_LENGTH -
-                                                      CUBE_SIZE)},        {0.2f, 0.2f, 1.0f, 1.0f}, {3003.0f, 0},    {0,    0,    1}},
+                                                      CUBE_SIZE)},        {0.2f, 0.2f, 1.0f, 1.0f}, {3.0f, 0},    {0,    0,    1}},
                 {{CUBE_SIZE,        -CUBE_SIZE,       -(AXIS_LENGTH -
-                                                      CUBE_SIZE)},        {0.2f, 0.2f, 1.0f, 1.0f}, {3003.0f, 0},    {0,    0,    1}},
+                                                      CUBE_SIZE)},        {0.2f, 0.2f, 1.0f, 1.0f}, {3.0f, 0},    {0,    0,    1}},
                 {{CUBE_SIZE,        CUBE_SIZE,        -(AXIS_LENGTH -
-                                                      CUBE_SIZE)},        {0.2f, 0.2f, 1.0f, 1.0f}, {3003.0f, 0},    {0,    0,    1}},
+                                                      CUBE_SIZE)},        {0.2f, 0.2f, 1.0f, 1.0f}, {3.0f, 0},    {0,    0,    1}},
                 {{-CUBE_SIZE,       CUBE_SIZE,        -(AXIS_LENGTH -
-                                                      CUBE_SIZE)},        {0.2f, 0.2f, 1.0f, 1.0f}, {3003.0f, 0},    {0,    0,    1}},
+                                                      CUBE_SIZE)},        {0.2f, 0.2f, 1.0f, 1.0f}, {3.0f, 0},    {0,    0,    1}},
                 {{-CUBE_SIZE,       -CUBE_SIZE,       -(AXIS_LENGTH +
-                                                      CUBE_SIZE)},        {0.2f, 0.2f, 1.0f, 1.0f}, {3003.0f, 0},    {0,    0,    1}},
+                                                      CUBE_SIZE)},        {0.2f, 0.2f, 1.0f, 1.0f}, {3.0f, 0},    {0,    0,    1}},
                 {{CUBE_SIZE,        -CUBE_SIZE,       -(AXIS_LENGTH +
-                                                      CUBE_SIZE)},        {0.2f, 0.2f, 1.0f, 1.0f}, {3003.0f, 0},    {0,    0,    1}},
+                                                      CUBE_SIZE)},        {0.2f, 0.2f, 1.0f, 1.0f}, {3.0f, 0},    {0,    0,    1}},
                 {{CUBE_SIZE,        CUBE_SIZE,        -(AXIS_LENGTH +
-                                                      CUBE_SIZE)},        {0.2f, 0.2f, 1.0f, 1.0f}, {3003.0f, 0},    {0,    0,    1}},
+                                                      CUBE_SIZE)},        {0.2f, 0.2f, 1.0f, 1.0f}, {3.0f, 0},    {0,    0,    1}},
                 {{-CUBE_SIZE,       CUBE_SIZE,        -(AXIS_LENGTH +
-                                                      CUBE_SIZE)},        {0.2f, 0.2f, 1.0f, 1.0f}, {3003.0f, 0},    {0,    0,    1}},
+                                                      CUBE_SIZE)},        {0.2f, 0.2f, 1.0f, 1.0f}, {3.0f, 0},    {0,    0,    1}},
 
 
         };
@@ -337,10 +304,10 @@ namespace rn {
         const float TWO_PI = 2.0f * PI;
         const float radius = AXIS_LENGTH * radiusMultiplier;
 
-        // IDs (like you used 1001/2002/3003 before) - use distinct ids for rotation gizmo
-        const float idX = 1001.0f; // X-rotation ring (around X axis)
-        const float idY = 2002.0f; // Y-rotation ring (around Y axis)
-        const float idZ = 3003.0f; // Z-rotation ring (around Z axis)
+        // Axis of every ring, the shader turns it into the 1001/2002/3003 pick ids
+        const float idX = 1.0f; // X-rotation ring (around X axis)
+        const float idY = 2.0f; // Y-rotation ring (around Y axis)
+        const float idZ = 3.0f; // Z-rotation ring (around Z axis)
 
         // Helper lambda to append a circle
         auto append_circle = [&](int axis, const glm::vec4 &color, float id) {
@@ -387,11 +354,11 @@ namespace rn {
         append_circle(3, glm::vec4(0.2f, 0.2f, 1.0f, 1.0f), idZ);
     }
 
-    void Gizmos::DrawGizmos(size_t currentImageIndex) {
+    void Gizmos::DrawGizmos(VkCommandBuffer commandBuffer, size_t currentFrameIndex) {
         if (mGizmoType == GIZMO_TYPE::ROTATE) {
-            DrawRotationGizmo(currentImageIndex);
+            DrawRotationGizmo(commandBuffer, currentFrameIndex);
         } else if ((mGizmoType == GIZMO_TYPE::SCALE) || (mGizmoType == GIZMO_TYPE::TRANSLATE)) {
-            DrawTranslateScaleGizmo(currentImageIndex);
+            DrawTranslateScaleGizmo(commandBuffer, currentFrameIndex);
         }
     }
 
@@ -406,62 +373,60 @@ namespace rn {
 
     }
 
-    void Gizmos::DrawRotationGizmo(std::uint32_t currentImageIndex) {
+    void Gizmos::DrawRotationGizmo(VkCommandBuffer commandBuffer, std::uint32_t currentFrameIndex) {
         std::uint32_t activeId = static_cast<std::uint32_t>(mCtx->GetActiveGizmoAxis());
         mTranslateMesh->SetModelMatrix(mModelMatrix);
-        vkCmdBindPipeline(mCtx->mainCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
                           mGizmoPipelineLineStrip);
-        vkCmdSetLineWidth(mCtx->mainCommandBuffer, LINE_WIDTH);
-        VkDeviceSize offset = {};
-        VkBuffer vertexBuffer = mTranslateMesh->GetVertexBuffer();
-        vkCmdBindVertexBuffers(mCtx->mainCommandBuffer, 0, 1, &vertexBuffer, &offset);
-        vkCmdBindIndexBuffer(mCtx->mainCommandBuffer, mTranslateMesh->GetIndexBuffer(), offset,
-                             VK_INDEX_TYPE_UINT32);
-
-        std::uint32_t dyOffset = 0;
-        vkCmdBindDescriptorSets(mCtx->mainCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
+        vkCmdSetLineWidth(commandBuffer, LINE_WIDTH);
+        mCtx->geometryArena->BindVertexBuffers(commandBuffer, VERTEX_ATTRIBUTE_POSITION | VERTEX_ATTRIBUTE_UV);
+        vkCmdBindIndexBuffer(commandBuffer, mTranslateMesh->GetIndexBuffer(), 0,
+                             mTranslateMesh->GetIndexType());
+
+        // The gizmo model comes from the push constant.
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
                                 mLayoutLineStrip, 0, 1,
-                                &(mCtx->viewProjectionDescriptorSet[currentImageIndex]), 1,
-                                &dyOffset);
+                                mCtx->viewProjectionDescriptorSet, 1, &mCtx->viewProjectionOffset);
 
         ModelUBO modelUbo = {mTranslateMesh->GetModelMatrix(), activeId};
-        vkCmdPushConstants(mCtx->mainCommandBuffer, mLayoutLineStrip,
+        vkCmdPushConstants(commandBuffer, mLayoutLineStrip,
                            VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(ModelUBO),
                            &modelUbo);
-        vkCmdDrawIndexed(mCtx->mainCommandBuffer, 65, 1, rotationStartIndex, 0, 0); // X
-        vkCmdDrawIndexed(mCtx->mainCommandBuffer, 65, 1, rotationStartIndex + 65, 0, 0); // Y
-        vkCmdDrawIndexed(mCtx->mainCommandBuffer, 65, 1, rotationStartIndex + 130, 0, 0); // Z
+        // The gizmo index ranges are relative to the mesh, the arena range is added on top.
+        std::uint32_t firstIndex = mTranslateMesh->GetFirstIndex() + rotationStartIndex;
+        std::int32_t vertexOffset = mTranslateMesh->GetVertexOffset();
+        vkCmdDrawIndexed(commandBuffer, 65, 1, firstIndex, vertexOffset, 0); // X
+        vkCmdDrawIndexed(commandBuffer, 65, 1, firstIndex + 65, vertexOffset, 0); // Y
+        vkCmdDrawIndexed(commandBuffer, 65, 1, firstIndex + 130, vertexOffset, 0); // Z
     }
 
-    void Gizmos::DrawTranslateScaleGizmo(std::uint32_t currentImageIndex) {
+    void Gizmos::DrawTranslateScaleGizmo(VkCommandBuffer commandBuffer, std::uint32_t currentFrameIndex) {
         for (int i = 0; i < 2; i++) {
             std::uint32_t activeId = static_cast<std::uint32_t>(mCtx->GetActiveGizmoAxis());
             mTranslateMesh->SetModelMatrix(mModelMatrix);
-            vkCmdBindPipeline(mCtx->mainCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
+            vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
                               i == 0 ? mGizmoPipelineLines : mGizmoPipelineTriangles);
-            vkCmdSetLineWidth(mCtx->mainCommandBuffer, LINE_WIDTH);
-            VkDeviceSize offset = {};
-            VkBuffer vertexBuffer = mTranslateMesh->GetVertexBuffer();
-            vkCmdBindVertexBuffers(mCtx->mainCommandBuffer, 0, 1, &vertexBuffer, &offset);
-            vkCmdBindIndexBuffer(mCtx->mainCommandBuffer, mTranslateMesh->GetIndexBuffer(), offset,
-                                 VK_INDEX_TYPE_UINT32);
-
-            std::uint32_t dyOffset = 0;
-            vkCmdBindDescriptorSets(mCtx->mainCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
+            vkCmdSetLineWidth(commandBuffer, LINE_WIDTH);
+            mCtx->geometryArena->BindVertexBuffers(commandBuffer, VERTEX_ATTRIBUTE_POSITION | VERTEX_ATTRIBUTE_UV);
+            vkCmdBindIndexBuffer(commandBuffer, mTranslateMesh->GetIndexBuffer(), 0,
+                                 mTranslateMesh->GetIndexType());
+
+            vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
                                     i == 0 ? mLayoutLines : mLayoutTriangles, 0, 1,
-                                    &(mCtx->viewProjectionDescriptorSet[currentImageIndex]), 1,
-                                    &dyOffset);
+                                    mCtx->viewProjectionDescriptorSet, 1, &mCtx->viewProjectionOffset);
 
             ModelUBO modelUbo = {mTranslateMesh->GetModelMatrix(), activeId};
-            vkCmdPushConstants(mCtx->mainCommandBuffer, i == 0 ? mLayoutLines : mLayoutTriangles,
+            vkCmdPushConstants(commandBuffer, i == 0 ? mLayoutLines : mLayoutTriangles,
                                VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(ModelUBO),
                                &modelUbo);
+            std::uint32_t meshFirstIndex = mTranslateMesh->GetFirstIndex();
+            std::int32_t vertexOffset = mTranslateMesh->GetVertexOffset();
             if (i == 0) {
-                vkCmdDrawIndexed(mCtx->mainCommandBuffer, 6, 1, 0, 0, 0);
+                vkCmdDrawIndexed(commandBuffer, 6, 1, meshFirstIndex, vertexOffset, 0);
             } else {
                 int indexCount = mGizmoType == GIZMO_TYPE::TRANSLATE ? 9 : 3 * 36;
                 int firstIndex = mGizmoType == GIZMO_TYPE::TRANSLATE ? 6 : 15;
-                vkCmdDrawIndexed(mCtx->mainCommandBuffer, indexCount, 1, firstIndex, 0, 0);
+                vkCmdDrawIndexed(commandBuffer, indexCount, 1, meshFirstIndex + firstIndex, vertexOffset, 0);
             }
         }
     }
@@ -12,12 +12,19 @@
 #include "lights/ShadowMap.h"
 #include "Gizmos.h"
 #include "SkyBox.h"
+#include "ThreadCommandPools.h"
+#include "MemoryAllocator.h"
+#include "BindlessTextureTable.h"
 
 
 namespace rn {
 #pragma region Common
-    Map<std::string, StaticMesh *, std::hash<std::string>> Graphics::meshObjectList = {};
-    Map<std::string, Texture *, std::hash<std::string>> Graphics::mTextureMap = {};
+    MeshRegistry Graphics::mMeshes = {};
+    LodStatistics Graphics::mLodStatistics = {};
+    Map<std::uint32_t, MeshHandle, std::hash<std::uint32_t>> Graphics::mMeshPickIds = {};
+    TextureRegistry Graphics::mTextures = {};
+    Map<std::string, TextureHandle, std::hash<std::string>> Graphics::mTextureIds = {};
+    TextureHandle Graphics::mDefaultTexture = {};
     RendererContext Graphics::mRendererContext = {};
     OmniDirectionalLight *Graphics::mDirectionalLight = nullptr;
     PointLights *Graphics::mPointLights = nullptr;
@@ -61,7 +68,6 @@ namespace rn {
                         mMouseYPos = event.clickY;
                         isViewPortClicked = true;
                         // This can be consume if the click is on the gizmo
-                        vkWaitForFences(mDevices.logicalDevice, 1, &mPresentFinishFence, VK_TRUE, UINT64_MAX);
                         mRendererContext.beginGizmoDrag = true;
                         break;
                     }
@@ -96,17 +102,27 @@ namespace rn {
         CreateOffScreenRenderPass();
         CreatePipeline();
         CreateSemaphoresAndFences();
+        CreateTimestampQueries();
         CreateCommandPool();
         AllocateCommandBuffer();
         SetRendererContext();
+        mOneShotCommands = new OneShotCommands{&mRendererContext};
+        mRendererContext.oneShotCommands = mOneShotCommands;
+        mUploadQueue = new UploadQueue{&mRendererContext,
+                                       mQueueFamily.transferQueueIndex.value_or(
+                                               mQueueFamily.graphicsQueueIndex.value()),
+                                       mTransferQueue, UPLOAD_STAGING_RING_SIZE};
+        mRendererContext.uploadQueue = mUploadQueue;
         CreateFrameBuffers();
         CreateOffScreenFrameBuffers();
         Imgui_vulkan_init();
 
         // Setting up the view and projection matrix descriptor sets
-        AllocateDynamicBufferTransferSpace();
         CreateUniformBuffers();
+        CreateSceneBuffers();
         CreateMousePickingBuffers();
+        mSecondaryCommandPools = new ThreadCommandPools{&mRendererContext, VK_COMMAND_BUFFER_LEVEL_SECONDARY,
+                                                        mJobSystem.GetSlotCount()};
 
         CreateDescriptorPool();
         AllocateDescriptorSets();
@@ -124,28 +140,26 @@ namespace rn {
     }
 
     Graphics::~Graphics() {
-        vkDeviceWaitIdle(mDevices.logicalDevice);
-
-        for (size_t i = 0; i < mViewProjectionBuffers.size(); i++) {
-            vkDestroyBuffer(mDevices.logicalDevice, mViewProjectionBuffers[i], nullptr);
-            vkFreeMemory(mDevices.logicalDevice, mViewProjectionMemory[i], nullptr);
-            vkDestroyBuffer(mDevices.logicalDevice, mDynamicBuffers[i], nullptr);
-            vkFreeMemory(mDevices.logicalDevice, mDynamicBufferMemory[i], nullptr);
-        }
-        vkDestroyBuffer(mDevices.logicalDevice, mMousePickingBuffer, nullptr);
-        vkFreeMemory(mDevices.logicalDevice, mMousePickingBufferMemory, nullptr);
-
-        _aligned_free(mModelTransferSpace);
-        auto textureIter = mTextureMap.begin();
-        while (textureIter != mTextureMap.end()) {
-            Texture *texture = textureIter->second;
+        Utility::WaitDeviceIdle(mRendererContext);
+
+        // Submits and waits for whatever was still recorded, before any destination resource goes away.
+        delete mUploadQueue;
+        delete mOneShotCommands;
+        delete mUniformRing;
+        delete mIndirectDrawList;
+        delete mInstanceBuffer;
+        delete mSecondaryCommandPools;
+        DestroyMousePickingBuffers();
+
+        for (Texture *texture: mTextures) {
             delete texture;
-            textureIter++;
         }
+        delete mBindlessTextureTable;
         // Just for testing the light make the light in the engine as a game object;
         delete mDirectionalLight;
         delete mPointLights;
         vkDestroySampler(mDevices.logicalDevice, mTextureSampler, nullptr);
+        vkDestroySampler(mDevices.logicalDevice, mBaseLevelSampler, nullptr);
         vkDestroySampler(mDevices.logicalDevice, mOffScreenImageSampler, nullptr);
 
         vkDestroyDescriptorPool(mDevices.logicalDevice, mViewProjectionDescriptorPool, nullptr);
@@ -160,29 +174,34 @@ namespace rn {
         vkDestroyDescriptorPool(mDevices.logicalDevice, mPointLightDescriptorPool, nullptr);
         vkDestroyDescriptorSetLayout(mDevices.logicalDevice, mPointLightShadowLayout, nullptr);
         vkDestroyDescriptorPool(mDevices.logicalDevice, mPointShadowDescriptorPool, nullptr);
+        vkDestroyDescriptorSetLayout(mDevices.logicalDevice, mObjectDataDescriptorSetLayout, nullptr);
 
         ImGui_ImplVulkan_Shutdown();
         ImGui_ImplGlfw_Shutdown();
         ImGui::DestroyContext();
         vkDestroyDescriptorPool(mDevices.logicalDevice, mImguiDescriptorPool, nullptr);
 
-        Map<std::string, StaticMesh *, std::hash<std::string>>::iterator iter = meshObjectList.begin();
-        while (iter != meshObjectList.end()) {
-            StaticMesh *mesh = iter->second;
+        for (StaticMesh *mesh: mMeshes) {
             delete mesh;
-            iter++;
         }
         delete mGizmos;
+        // Every mesh frees its range on deletion, so the arena goes last.
+        delete mGeometryArena;
         vkDestroyCommandPool(mDevices.logicalDevice, mCommandPool, nullptr);
+        if (mTimestampQueryPool != VK_NULL_HANDLE) {
+            vkDestroyQueryPool(mDevices.logicalDevice, mTimestampQueryPool, nullptr);
+        }
         for (VkFramebuffer framebuffer: mFrameBuffers) {
             vkDestroyFramebuffer(mDevices.logicalDevice, framebuffer, nullptr);
         }
         for (VkFramebuffer &framebuffer: mOffScreenFrameBuffers) {
             vkDestroyFramebuffer(mDevices.logicalDevice, framebuffer, nullptr);
         }
-        vkDestroySemaphore(mDevices.logicalDevice, mPresentImageSemaphore, nullptr);
-        vkDestroySemaphore(mDevices.logicalDevice, mGetImageSemaphore, nullptr);
-        vkDestroyFence(mDevices.logicalDevice, mPresentFinishFence, nullptr);
+        for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+            vkDestroySemaphore(mDevices.logicalDevice, mPresentImageSemaphores[i], nullptr);
+            vkDestroySemaphore(mDevices.logicalDevice, mGetImageSemaphores[i], nullptr);
+            vkDestroyFence(mDevices.logicalDevice, mInFlightFences[i], nullptr);
+        }
 
 
         for (size_t i = 0; i < mSwapChainImageViews.size(); i++) {
@@ -191,20 +210,21 @@ namespace rn {
             vkDestroyImageView(mDevices.logicalDevice, mDepthBufferImageViews[i], nullptr);
             vkDestroyImageView(mDevices.logicalDevice, mMousePickingImageViews[i], nullptr);
 
-            vkDestroyImage(mDevices.logicalDevice, mDepthBufferImages[i], nullptr);
-            vkFreeMemory(mDevices.logicalDevice, mDepthBufferImageMemory[i], nullptr);
-
-            vkDestroyImage(mDevices.logicalDevice, mOffScreenImages[i], nullptr);
-            vkFreeMemory(mDevices.logicalDevice, mOffScreenImageMemory[i], nullptr);
-
-            vkDestroyImage(mDevices.logicalDevice, mMousePickingImages[i], nullptr);
-            vkFreeMemory(mDevices.logicalDevice, mMousePickingImageMemory[i], nullptr);
+            Utility::DestroyImage(mRendererContext, mDepthBufferImages[i], mDepthBufferImageMemory[i]);
+            Utility::DestroyImage(mRendererContext, mOffScreenImages[i], mOffScreenImageMemory[i]);
+            Utility::DestroyImage(mRendererContext, mMousePickingImages[i], mMousePickingImageMemory[i]);
         }
         vkDestroyPipeline(mDevices.logicalDevice, mPipeline, nullptr);
         vkDestroyPipelineLayout(mDevices.logicalDevice, mPipelineLayout, nullptr);
+        if (mIndirectDrawSupported) {
+            vkDestroyPipeline(mDevices.logicalDevice, mIndirectPipeline, nullptr);
+            vkDestroyPipelineLayout(mDevices.logicalDevice, mIndirectPipelineLayout, nullptr);
+        }
         vkDestroyRenderPass(mDevices.logicalDevice, mRenderPass, nullptr);
         vkDestroyRenderPass(mDevices.logicalDevice, mOffScreenRenderPass, nullptr);
         vkDestroySwapchainKHR(mDevices.logicalDevice, mSwapChain, nullptr);
+        mMemoryAllocator->LogStatistics();
+        delete mMemoryAllocator;
         vkDestroyDevice(mDevices.logicalDevice, nullptr);
         vkDestroySurfaceKHR(mInstance, mSurface, nullptr);
         vkDestroyInstance(mInstance, nullptr);
@@ -245,6 +265,20 @@ namespace rn {
         List<const char *> instanceExtensions{};
         GetWindowExtensions(instanceExtensions);
         instanceExtensions.push_back("VK_EXT_debug_utils");
+        // Optional, only used to enable the multiview device extension.
+        std::uint32_t availableInstanceExtensionCount{};
+        vkEnumerateInstanceExtensionProperties(nullptr, &availableInstanceExtensionCount, nullptr);
+        List<VkExtensionProperties> availableInstanceExtensions(availableInstanceExtensionCount);
+        vkEnumerateInstanceExtensionProperties(nullptr, &availableInstanceExtensionCount,
+                                               availableInstanceExtensions.data());
+        mPhysicalDeviceProperties2Enabled = std::any_of(
+                availableInstanceExtensions.begin(), availableInstanceExtensions.end(),
+                [](const VkExtensionProperties &property) -> bool {
+                    return ComparePropertyNames(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME, property);
+                });
+        if (mPhysicalDeviceProperties2Enabled) {
+            instanceExtensions.push_back(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME);
+        }
         instanceCreateInfo.enabledExtensionCount = instanceExtensions.size();
         instanceCreateInfo.ppEnabledExtensionNames = instanceExtensions.data();
 
@@ -314,6 +348,8 @@ namespace rn {
         VkPhysicalDeviceProperties physicalDeviceProperties{};
         vkGetPhysicalDeviceProperties(mDevices.physicalDevice, &physicalDeviceProperties);
         mBufferMinAlignment = physicalDeviceProperties.limits.minUniformBufferOffsetAlignment;
+        mTimestampsSupported = physicalDeviceProperties.limits.timestampComputeAndGraphics;
+        mTimestampPeriod = physicalDeviceProperties.limits.timestampPeriod;
         CreateLogicalDevice(mDevices.physicalDevice);
     }
 
@@ -349,6 +385,14 @@ namespace rn {
             return;
         }
         mQueueFamily.graphicsQueueIndex = iter - queueFamilyProperties.begin();
+        mQueueFamily.transferQueueIndex = std::nullopt;
+        for (std::uint32_t i = 0; i < queueFamilyProperties.size(); i++) {
+            VkQueueFlags flags = queueFamilyProperties[i].queueFlags;
+            if ((flags & VK_QUEUE_TRANSFER_BIT) && !(flags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT))) {
+                mQueueFamily.transferQueueIndex = i;
+                break;
+            }
+        }
         for (int i = 0; i < queueFamilyProperties.size(); i++) {
             VkBool32 hasPresentationMode = false;
             vkGetPhysicalDeviceSurfaceSupportKHR(physicalDevice, i, mSurface, &hasPresentationMode);
@@ -361,6 +405,9 @@ namespace rn {
     void Graphics::CreateLogicalDevice(VkPhysicalDevice &physicalDevice) {
         std::set<std::uint32_t> queueIndex = {mQueueFamily.graphicsQueueIndex.value(),
                                               mQueueFamily.presentationQueueIndex.value()};
+        if (mQueueFamily.transferQueueIndex.has_value()) {
+            queueIndex.insert(mQueueFamily.transferQueueIndex.value());
+        }
         List<VkDeviceQueueCreateInfo> queueCreateInfos{};
         std::float_t priority = 1.f;
         for (std::uint32_t index: queueIndex) {
@@ -383,6 +430,60 @@ namespace rn {
         GetPhysicalDeviceExtensionProperties(physicalDevice, availableExtensionProperties);
         CheckAvailability<VkExtensionProperties>(requiredExtensions, availableExtensionProperties,
                                                  &Graphics::ComparePropertyNames);
+        // Multiview is optional, the point light shadows fall back to one render pass per cube face without it.
+        VkPhysicalDeviceMultiviewFeaturesKHR multiviewFeatures{};
+        multiviewFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MULTIVIEW_FEATURES_KHR;
+        multiviewFeatures.multiview = VK_TRUE;
+        mMultiviewSupported = USE_MULTIVIEW_POINT_SHADOWS && mPhysicalDeviceProperties2Enabled &&
+                              std::any_of(availableExtensionProperties.begin(), availableExtensionProperties.end(),
+                                          [](const VkExtensionProperties &property) -> bool {
+                                              return ComparePropertyNames(VK_KHR_MULTIVIEW_EXTENSION_NAME, property);
+                                          });
+        // Feature structures of the optional extensions are chained in front of each other.
+        void *featureChain = nullptr;
+        if (mMultiviewSupported) {
+            requiredExtensions.push_back(VK_KHR_MULTIVIEW_EXTENSION_NAME);
+            multiviewFeatures.pNext = featureChain;
+            featureChain = &multiviewFeatures;
+        }
+        LOG_INFO("Point light shadows use {}", mMultiviewSupported ? "a single multiview pass" : "six passes per light");
+        // The indirect scene path selects the object data with firstInstance, without it the scene is drawn directly.
+        VkPhysicalDeviceFeatures supportedFeatures{};
+        vkGetPhysicalDeviceFeatures(physicalDevice, &supportedFeatures);
+        mIndirectDrawSupported = USE_INDIRECT_SCENE_DRAW && supportedFeatures.drawIndirectFirstInstance;
+        mMultiDrawIndirectSupported = mIndirectDrawSupported && supportedFeatures.multiDrawIndirect;
+        bool drawIndirectCountSupported =
+                mMultiDrawIndirectSupported &&
+                std::any_of(availableExtensionProperties.begin(), availableExtensionProperties.end(),
+                            [](const VkExtensionProperties &property) -> bool {
+                                return ComparePropertyNames(VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME, property);
+                            });
+        if (drawIndirectCountSupported) {
+            requiredExtensions.push_back(VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME);
+        }
+        LOG_INFO("Scene is drawn with {}", !mIndirectDrawSupported ? "one direct draw per object" :
+                                           drawIndirectCountSupported ? "indirect count draws" :
+                                           mMultiDrawIndirectSupported ? "multi draw indirect" : "single indirect draws");
+        // The bindless texture table only replaces the per batch texture sets of the indirect scene path.
+        VkPhysicalDeviceDescriptorIndexingFeaturesEXT descriptorIndexingFeatures{};
+        descriptorIndexingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT;
+        mBindlessTexturesSupported = USE_BINDLESS_TEXTURES && mIndirectDrawSupported &&
+                                     QueryBindlessTextureSupport(physicalDevice, availableExtensionProperties);
+        if (mBindlessTexturesSupported) {
+            requiredExtensions.push_back(VK_KHR_MAINTENANCE3_EXTENSION_NAME);
+            requiredExtensions.push_back(VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME);
+            descriptorIndexingFeatures.runtimeDescriptorArray = VK_TRUE;
+            descriptorIndexingFeatures.descriptorBindingPartiallyBound = VK_TRUE;
+            descriptorIndexingFeatures.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+            descriptorIndexingFeatures.descriptorBindingUpdateUnusedWhilePending = VK_TRUE;
+            descriptorIndexingFeatures.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
+            descriptorIndexingFeatures.pNext = featureChain;
+            featureChain = &descriptorIndexingFeatures;
+        }
+        LOG_INFO("Scene textures are bound {}", mBindlessTexturesSupported
+                                                ? "once per frame through the bindless texture table"
+                                                : "per batch as one descriptor set per texture");
+        deviceCreateInfo.pNext = featureChain;
         deviceCreateInfo.enabledExtensionCount = requiredExtensions.size();
         deviceCreateInfo.ppEnabledExtensionNames = requiredExtensions.data();
         // Enabling required features for the physical device on to the logical device
@@ -390,17 +491,92 @@ namespace rn {
         deviceFeatures.samplerAnisotropy = VK_TRUE;
         deviceFeatures.independentBlend = VK_TRUE;
         deviceFeatures.wideLines = VK_TRUE;
+        deviceFeatures.drawIndirectFirstInstance = mIndirectDrawSupported;
+        // Cooked textures are decoded to RGBA8 on load without it.
+        mTextureCompressionBCSupported = supportedFeatures.textureCompressionBC;
+        deviceFeatures.textureCompressionBC = mTextureCompressionBCSupported;
+        deviceFeatures.multiDrawIndirect = mMultiDrawIndirectSupported;
         deviceCreateInfo.pEnabledFeatures = &deviceFeatures;
 
         Utility::CheckVulkanError(
                 vkCreateDevice(physicalDevice, &deviceCreateInfo, nullptr, &mDevices.logicalDevice),
                 "Failed to create the logical device from the physical device");
+        // The depth images are created before SetRendererContext and already go through the allocator.
+        mRendererContext.physicalDevice = physicalDevice;
+        mRendererContext.logicalDevice = mDevices.logicalDevice;
+        mMemoryAllocator = new MemoryAllocator{physicalDevice, mDevices.logicalDevice};
+        mRendererContext.memoryAllocator = mMemoryAllocator;
+        if (drawIndirectCountSupported) {
+            mCmdDrawIndexedIndirectCount = reinterpret_cast<PFN_vkCmdDrawIndexedIndirectCountKHR>(
+                    vkGetDeviceProcAddr(mDevices.logicalDevice, "vkCmdDrawIndexedIndirectCountKHR"));
+        }
         vkGetDeviceQueue(mDevices.logicalDevice, mQueueFamily.graphicsQueueIndex.value(), 0, &mGraphicsQueue);
         vkGetDeviceQueue(mDevices.logicalDevice, mQueueFamily.presentationQueueIndex.value(), 0,
                          &mPresentationQueue);
+        mTransferQueue = mGraphicsQueue;
+        if (mQueueFamily.transferQueueIndex.has_value()) {
+            vkGetDeviceQueue(mDevices.logicalDevice, mQueueFamily.transferQueueIndex.value(), 0, &mTransferQueue);
+        }
+        LOG_INFO("Uploads run on {}", mQueueFamily.transferQueueIndex.has_value() ? "a dedicated transfer queue"
+                                                                                   : "the graphics queue");
 
     }
 
+    bool Graphics::QueryBindlessTextureSupport(VkPhysicalDevice &physicalDevice,
+                                               const List<VkExtensionProperties> &availableExtensions) {
+        // Both the features and the limits are only reachable through VK_KHR_get_physical_device_properties2.
+        if (!mPhysicalDeviceProperties2Enabled) {
+            return false;
+        }
+        for (const char *extension: {VK_KHR_MAINTENANCE3_EXTENSION_NAME, VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME}) {
+            bool available = std::any_of(availableExtensions.begin(), availableExtensions.end(),
+                                         [extension](const VkExtensionProperties &property) -> bool {
+                                             return ComparePropertyNames(extension, property);
+                                         });
+            if (!available) {
+                return false;
+            }
+        }
+        PFN_vkGetPhysicalDeviceFeatures2KHR getFeatures2 = reinterpret_cast<PFN_vkGetPhysicalDeviceFeatures2KHR>(
+                vkGetInstanceProcAddr(mInstance, "vkGetPhysicalDeviceFeatures2KHR"));
+        PFN_vkGetPhysicalDeviceProperties2KHR getProperties2 = reinterpret_cast<PFN_vkGetPhysicalDeviceProperties2KHR>(
+                vkGetInstanceProcAddr(mInstance, "vkGetPhysicalDeviceProperties2KHR"));
+        if (getFeatures2 == nullptr || getProperties2 == nullptr) {
+            return false;
+        }
+
+        VkPhysicalDeviceDescriptorIndexingFeaturesEXT indexingFeatures{};
+        indexingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT;
+        VkPhysicalDeviceFeatures2KHR features{};
+        features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2_KHR;
+        features.pNext = &indexingFeatures;
+        getFeatures2(physicalDevice, &features);
+        if (!indexingFeatures.runtimeDescriptorArray || !indexingFeatures.descriptorBindingPartiallyBound ||
+            !indexingFeatures.descriptorBindingSampledImageUpdateAfterBind ||
+            !indexingFeatures.descriptorBindingUpdateUnusedWhilePending ||
+            !indexingFeatures.shaderSampledImageArrayNonUniformIndexing) {
+            return false;
+        }
+
+        VkPhysicalDeviceDescriptorIndexingPropertiesEXT indexingProperties{};
+        indexingProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES_EXT;
+        VkPhysicalDeviceProperties2KHR properties{};
+        properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2_KHR;
+        properties.pNext = &indexingProperties;
+        getProperties2(physicalDevice, &properties);
+        // The limits count every set of the pipeline layout, the shadow maps take the other fragment samplers.
+        std::uint32_t reservedSamplers = MAX_POINT_LIGHTS + 1;
+        std::uint32_t limit = std::min({indexingProperties.maxPerStageDescriptorUpdateAfterBindSamplers,
+                                        indexingProperties.maxPerStageDescriptorUpdateAfterBindSampledImages,
+                                        indexingProperties.maxDescriptorSetUpdateAfterBindSamplers,
+                                        indexingProperties.maxDescriptorSetUpdateAfterBindSampledImages});
+        if (limit <= reservedSamplers) {
+            return false;
+        }
+        mBindlessTextureCapacity = std::min(MAX_BINDLESS_TEXTURES, limit - reservedSamplers);
+        return true;
+    }
+
     void Graphics::GetPhysicalDeviceExtensionProperties(VkPhysicalDevice &physicalDevice,
                                                         List<VkExtensionProperties> &propertiesList) {
         std::uint32_t count{};
@@ -531,26 +707,21 @@ namespace rn {
 
     void Graphics::ReCreateSwapChain() {
         // This function handles the recreation and resizing of the window and re-creating the frame buffers and image views for the swapchain;
-        vkWaitForFences(mDevices.logicalDevice, 1, &mPresentFinishFence, true, UINT64_MAX);
+        WaitForFramesInFlight();
         // Deleting the previous swapchain;
         for (int i = 0; i < mSwapChainImageViews.size(); i++) {
             vkDestroyFramebuffer(mRendererContext.logicalDevice, mFrameBuffers[i], nullptr);
             vkDestroyImageView(mRendererContext.logicalDevice, mSwapChainImageViews[i], nullptr);
             vkDestroyImageView(mRendererContext.logicalDevice, mDepthBufferImageViews[i], nullptr);
-            vkDestroyImage(mRendererContext.logicalDevice, mDepthBufferImages[i], nullptr);
-            vkFreeMemory(mRendererContext.logicalDevice, mDepthBufferImageMemory[i], nullptr);
+            Utility::DestroyImage(mRendererContext, mDepthBufferImages[i], mDepthBufferImageMemory[i]);
 
             vkDestroyFramebuffer(mRendererContext.logicalDevice, mOffScreenFrameBuffers[i], nullptr);
             vkDestroyImageView(mRendererContext.logicalDevice, mOffScreenImageViews[i], nullptr);
-            vkDestroyImage(mRendererContext.logicalDevice, mOffScreenImages[i], nullptr);
-            vkFreeMemory(mRendererContext.logicalDevice, mOffScreenImageMemory[i], nullptr);
+            Utility::DestroyImage(mRendererContext, mOffScreenImages[i], mOffScreenImageMemory[i]);
 
             vkDestroyImageView(mRendererContext.logicalDevice, mMousePickingImageViews[i], nullptr);
-            vkDestroyImage(mRendererContext.logicalDevice, mMousePickingImages[i], nullptr);
-            vkFreeMemory(mRendererContext.logicalDevice, mMousePickingImageMemory[i], nullptr);
+            Utility::DestroyImage(mRendererContext, mMousePickingImages[i], mMousePickingImageMemory[i]);
         }
-        vkDestroyBuffer(mDevices.logicalDevice, mMousePickingBuffer, nullptr);
-        vkFreeMemory(mDevices.logicalDevice, mMousePickingBufferMemory, nullptr);
         vkDestroySwapchainKHR(mRendererContext.logicalDevice, mSwapChain, nullptr);
 
         mSwapChainImages.clear();
@@ -566,6 +737,7 @@ namespace rn {
 
 
         CreateSwapChain();
+        mImagesInFlight.assign(mSwapChainImages.size(), VK_NULL_HANDLE);
         CreateDepthBufferImages();
         CreateFrameBuffers();
         CreateOffScreenFrameBuffers();
@@ -575,7 +747,6 @@ namespace rn {
         }
         vkDestroySampler(mDevices.logicalDevice, mOffScreenImageSampler, nullptr);
         CreateOffScreenBindings();
-        CreateMousePickingBuffers();
     }
 
     void Graphics::OnViewPortChange(uint32_t newWidth, uint32_t newHeight) {
@@ -781,44 +952,9 @@ namespace rn {
         viewportStateCreateInfo.scissorCount = 1;
         viewportStateCreateInfo.pScissors = &mScissors;
 
-        VkVertexInputBindingDescription bindingDescription{};
-        bindingDescription.stride = sizeof(Vertex);
-        bindingDescription.binding = 0;
-        bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
-
-        VkVertexInputAttributeDescription positionAttribute{};
-        positionAttribute.binding = 0;
-        positionAttribute.location = 0;
-        positionAttribute.format = VK_FORMAT_R32G32B32_SFLOAT;
-        positionAttribute.offset = offsetof(Vertex, pos);
-
-        VkVertexInputAttributeDescription colorAttribute{};
-        colorAttribute.binding = 0;
-        colorAttribute.location = 1;
-        colorAttribute.format = VK_FORMAT_R32G32B32A32_SFLOAT;
-        colorAttribute.offset = offsetof(Vertex, color);
-
-        VkVertexInputAttributeDescription textureCoordsInputAttribute{};
-        textureCoordsInputAttribute.binding = 0;
-        textureCoordsInputAttribute.location = 2;
-        textureCoordsInputAttribute.format = VK_FORMAT_R32G32_SFLOAT;
-        textureCoordsInputAttribute.offset = offsetof(Vertex, uv);
-
-        VkVertexInputAttributeDescription normalInputAttribute{};
-        normalInputAttribute.binding = 0;
-        normalInputAttribute.location = 3;
-        normalInputAttribute.format = VK_FORMAT_R32G32B32A32_SFLOAT;
-        normalInputAttribute.offset = offsetof(Vertex, normals);
-
-        std::array<VkVertexInputAttributeDescription, 4> attributeDescriptions{
-                positionAttribute, colorAttribute, textureCoordsInputAttribute, normalInputAttribute
-        };
-        VkPipelineVertexInputStateCreateInfo vertexInputStateCreateInfo{};
-        vertexInputStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-        vertexInputStateCreateInfo.vertexBindingDescriptionCount = 1;
-        vertexInputStateCreateInfo.pVertexBindingDescriptions = &bindingDescription;
-        vertexInputStateCreateInfo.vertexAttributeDescriptionCount = attributeDescriptions.size();
-        vertexInputStateCreateInfo.pVertexAttributeDescriptions = attributeDescriptions.data();
+        // The scene shaders read every stream of the geometry arena.
+        VertexInputDescription vertexInput = GeometryArena::DescribeVertexInput(VERTEX_ATTRIBUTE_ALL);
+        VkPipelineVertexInputStateCreateInfo vertexInputStateCreateInfo = vertexInput.GetCreateInfo();
 
 
         VkPipelineInputAssemblyStateCreateInfo inputAssemblyStateCreateInfo{};
@@ -867,21 +1003,17 @@ namespace rn {
         CreateDescriptorLayouts();
         CreateTextureDefaultSampler();
         mRendererContext.viewProjectionLayout = mViewProjectionDescriptorSetLayout;
+        // The instances of the direct path are read from the InstanceBuffer at set OBJECT_DATA_SET, like the
+        // objects of the indirect path.
         List<VkDescriptorSetLayout> setLayouts{mViewProjectionDescriptorSetLayout, mSamplerDescriptorLayout,
                                                mLightsDescriptorSetLayout, mShadowLayout,
-                                               mPointLightDescriptorSetLayout, mPointLightShadowLayout};
-
-        VkPushConstantRange pushConstantRange{};
-        pushConstantRange.offset = 0;
-        pushConstantRange.size = sizeof(glm::mat4);
-        pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+                                               mPointLightDescriptorSetLayout, mPointLightShadowLayout,
+                                               mObjectDataDescriptorSetLayout};
 
         VkPipelineLayoutCreateInfo layoutCreateInfo{};
         layoutCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
         layoutCreateInfo.setLayoutCount = setLayouts.size();
         layoutCreateInfo.pSetLayouts = setLayouts.data();
-        layoutCreateInfo.pushConstantRangeCount = 1;
-        layoutCreateInfo.pPushConstantRanges = &pushConstantRange;
 
         Utility::CheckVulkanError(
                 vkCreatePipelineLayout(mDevices.logicalDevice, &layoutCreateInfo, nullptr, &mPipelineLayout),
@@ -909,6 +1041,41 @@ namespace rn {
                                           &mPipeline),
                 "Failed to create the pipeline");
         vkDestroyShaderModule(mDevices.logicalDevice, vertexShaderModule, nullptr);
+
+        if (mIndirectDrawSupported) {
+            // Only the shader stages and the layout differ, the object data set comes after the lights as well.
+            std::string indirectVertexShaderFile = R"(D:\cProjects\SmallVkEngine\Shaders\defaultIndirect.vert.spv)";
+            VkShaderModule indirectVertexShaderModule = CreateShaderModule(indirectVertexShaderFile.c_str());
+            shaderStages[0].module = indirectVertexShaderModule;
+            // The bindless fragment shader reads the texture index of the object instead of a texture set.
+            VkShaderModule bindlessFragmentShaderModule = VK_NULL_HANDLE;
+            if (mBindlessTextureTable != nullptr) {
+                std::string bindlessFragmentShaderFile =
+                        R"(D:\cProjects\SmallVkEngine\Shaders\defaultBindless.frag.spv)";
+                bindlessFragmentShaderModule = CreateShaderModule(bindlessFragmentShaderFile.c_str());
+                shaderStages[1].module = bindlessFragmentShaderModule;
+                setLayouts[1] = mBindlessTextureTable->GetLayout();
+            }
+
+            VkPipelineLayoutCreateInfo indirectLayoutCreateInfo{};
+            indirectLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+            indirectLayoutCreateInfo.setLayoutCount = setLayouts.size();
+            indirectLayoutCreateInfo.pSetLayouts = setLayouts.data();
+            Utility::CheckVulkanError(
+                    vkCreatePipelineLayout(mDevices.logicalDevice, &indirectLayoutCreateInfo, nullptr,
+                                           &mIndirectPipelineLayout),
+                    "Failed to create the layout for the indirect pipeline");
+
+            pipelineCreateInfo.layout = mIndirectPipelineLayout;
+            Utility::CheckVulkanError(
+                    vkCreateGraphicsPipelines(mDevices.logicalDevice, nullptr, 1, &pipelineCreateInfo, nullptr,
+                                              &mIndirectPipeline),
+                    "Failed to create the indirect pipeline");
+            vkDestroyShaderModule(mDevices.logicalDevice, indirectVertexShaderModule, nullptr);
+            if (bindlessFragmentShaderModule != VK_NULL_HANDLE) {
+                vkDestroyShaderModule(mDevices.logicalDevice, bindlessFragmentShaderModule, nullptr);
+            }
+        }
         vkDestroyShaderModule(mDevices.logicalDevice, fragmentShaderModule, nullptr);
     }
 
@@ -924,17 +1091,24 @@ namespace rn {
         presentImageFenceCreateInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
         presentImageFenceCreateInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
 
-        Utility::CheckVulkanError(
-                vkCreateSemaphore(mDevices.logicalDevice, &getImageSemaphoreCreateInfo, nullptr,
-                                  &mGetImageSemaphore),
-                "Failed to create the wait get image semaphore");
-        Utility::CheckVulkanError(
-                vkCreateSemaphore(mDevices.logicalDevice, &presentImageSemaphoreCreateInfo, nullptr,
-                                  &mPresentImageSemaphore),
-                "Failed to create the present Image semaphore");
-        Utility::CheckVulkanError(
-                vkCreateFence(mDevices.logicalDevice, &presentImageFenceCreateInfo, nullptr, &mPresentFinishFence),
-                "Failed to create the fence for the present Image");
+        mGetImageSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
+        mPresentImageSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
+        mInFlightFences.resize(MAX_FRAMES_IN_FLIGHT);
+        mImagesInFlight.assign(mSwapChainImages.size(), VK_NULL_HANDLE);
+
+        for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+            Utility::CheckVulkanError(
+                    vkCreateSemaphore(mDevices.logicalDevice, &getImageSemaphoreCreateInfo, nullptr,
+                                      &mGetImageSemaphores[i]),
+                    "Failed to create the wait get image semaphore");
+            Utility::CheckVulkanError(
+                    vkCreateSemaphore(mDevices.logicalDevice, &presentImageSemaphoreCreateInfo, nullptr,
+                                      &mPresentImageSemaphores[i]),
+                    "Failed to create the present Image semaphore");
+            Utility::CheckVulkanError(
+                    vkCreateFence(mDevices.logicalDevice, &presentImageFenceCreateInfo, nullptr, &mInFlightFences[i]),
+                    "Failed to create the fence for the present Image");
+        }
 
     }
 
@@ -953,8 +1127,7 @@ namespace rn {
         for (size_t i = 0; i < mSwapChainImageViews.size(); i++) {
 
             // Creating the frame buffer for the off screen rendering for the imgui view port;
-            mOffScreenImages[i] = Utility::CreateImage("ImGui off-ScreenImage", mDevices.physicalDevice,
-                                                       mDevices.logicalDevice,
+            mOffScreenImages[i] = Utility::CreateImage("ImGui off-ScreenImage", mRendererContext,
                                                        mRendererContext.viewportExtends.width,
                                                        mRendererContext.viewportExtends.height,
                                                        mSurfaceFormat.format,
@@ -966,8 +1139,7 @@ namespace rn {
             Utility::CreateImageView(mDevices.logicalDevice, mOffScreenImages[i], mSurfaceFormat.format,
                                      mOffScreenImageViews[i], VK_IMAGE_ASPECT_COLOR_BIT);
 
-            mMousePickingImages[i] = Utility::CreateImage("Mouse Picking Image", mDevices.physicalDevice,
-                                                          mDevices.logicalDevice,
+            mMousePickingImages[i] = Utility::CreateImage("Mouse Picking Image", mRendererContext,
                                                           mRendererContext.viewportExtends.width,
                                                           mRendererContext.viewportExtends.height,
                                                           VK_FORMAT_R32_UINT,
@@ -1040,12 +1212,86 @@ namespace rn {
         VkCommandBufferAllocateInfo allocateInfo{};
         allocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
         allocateInfo.commandPool = mCommandPool;
-        allocateInfo.commandBufferCount = 1;
+        allocateInfo.commandBufferCount = MAX_FRAMES_IN_FLIGHT;
         allocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
 
-        Utility::CheckVulkanError(vkAllocateCommandBuffers(mDevices.logicalDevice, &allocateInfo, &mCommandBuffer),
-                                  "Failed to allocate the command buffer");
+        mCommandBuffers.resize(MAX_FRAMES_IN_FLIGHT);
+        Utility::CheckVulkanError(
+                vkAllocateCommandBuffers(mDevices.logicalDevice, &allocateInfo, mCommandBuffers.data()),
+                "Failed to allocate the command buffer");
+        mCommandBuffer = mCommandBuffers[mCurrentFrame];
         mRendererContext.mainCommandBuffer = mCommandBuffer;
+        mRendererContext.currentFrameIndex = mCurrentFrame;
+    }
+
+    void Graphics::WaitForFramesInFlight() {
+        vkWaitForFences(mDevices.logicalDevice, mInFlightFences.size(), mInFlightFences.data(), VK_TRUE,
+                        UINT64_MAX);
+    }
+
+    void Graphics::CreateTimestampQueries() {
+        if (!mTimestampsSupported) {
+            return;
+        }
+        VkQueryPoolCreateInfo queryPoolCreateInfo{};
+        queryPoolCreateInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+        queryPoolCreateInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+        queryPoolCreateInfo.queryCount = 2 * MAX_FRAMES_IN_FLIGHT;
+        Utility::CheckVulkanError(
+                vkCreateQueryPool(mDevices.logicalDevice, &queryPoolCreateInfo, nullptr, &mTimestampQueryPool),
+                "Failed to create the timestamp query pool");
+    }
+
+    void Graphics::ResolveFrameTimestamps(std::uint32_t frameIndex) {
+        std::uint32_t phase = mTextureBenchmark.framePhases[frameIndex];
+        if (phase == 0) {
+            return;
+        }
+        std::array<std::uint64_t, 2> timestamps{};
+        Utility::CheckVulkanError(
+                vkGetQueryPoolResults(mDevices.logicalDevice, mTimestampQueryPool, 2 * frameIndex, 2,
+                                      sizeof(timestamps), timestamps.data(), sizeof(std::uint64_t),
+                                      VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT),
+                "Failed to read the off-screen pass timestamps");
+        mTextureBenchmark.gpuMilliseconds[phase - 1] +=
+                static_cast<double>(timestamps[1] - timestamps[0]) * mTimestampPeriod / 1000000.0;
+        mTextureBenchmark.resolvedFrames[phase - 1]++;
+        mTextureBenchmark.framePhases[frameIndex] = 0;
+    }
+
+    void Graphics::UpdateTextureBenchmark() {
+        ResolveFrameTimestamps(mCurrentFrame);
+        if (mTextureBenchmark.phase == 0 || mTextureBenchmark.recordedFrames < TEXTURE_BENCHMARK_FRAMES) {
+            return;
+        }
+        // The texture descriptor sets are rewritten below, no frame may still be using them. Only the frames are
+        // waited for, the uploads and loader submissions keep running. This frame's fence is not reset yet.
+        WaitForFramesInFlight();
+        if (mTextureBenchmark.phase == 1) {
+            SetTextureSamplers(mBaseLevelSampler);
+            mTextureBenchmark.phase = 2;
+            mTextureBenchmark.recordedFrames = 0;
+            return;
+        }
+        for (std::uint32_t frame = 0; frame < MAX_FRAMES_IN_FLIGHT; frame++) {
+            ResolveFrameTimestamps(frame);
+        }
+        SetTextureSamplers(mTextureSampler);
+        mTextureBenchmark.phase = 0;
+
+        VkDeviceSize baseLevelBytes = 0;
+        VkDeviceSize mipChainBytes = 0;
+        for (const Texture *texture: mTextures) {
+            baseLevelBytes += texture->GetBaseLevelSize();
+            mipChainBytes += texture->GetMemorySize();
+        }
+        LOG_INFO("Texture sampling benchmark : {} textures, {:.2f} MB of base levels, {:.2f} MB with the mip chains",
+                 mTextures.Size(), baseLevelBytes / (1024.0 * 1024.0), mipChainBytes / (1024.0 * 1024.0));
+        LOG_INFO("Texture sampling benchmark : off-screen pass {:.3f} ms with mip chains, {:.3f} ms base level only, "
+                 "averaged over {} and {} frames",
+                 mTextureBenchmark.gpuMilliseconds[0] / std::max(mTextureBenchmark.resolvedFrames[0], 1u),
+                 mTextureBenchmark.gpuMilliseconds[1] / std::max(mTextureBenchmark.resolvedFrames[1], 1u),
+                 mTextureBenchmark.resolvedFrames[0], mTextureBenchmark.resolvedFrames[1]);
     }
 
     void Graphics::BeginOffScreenPass(std::uint32_t currentImageIndex) {
@@ -1053,6 +1299,13 @@ namespace rn {
         VkCommandBufferBeginInfo beginInfo{};
         beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
         vkBeginCommandBuffer(mCommandBuffer, &beginInfo);
+        mTextureBenchmark.framePhases[mCurrentFrame] = mTextureBenchmark.phase;
+        if (mTextureBenchmark.phase != 0) {
+            vkCmdResetQueryPool(mCommandBuffer, mTimestampQueryPool, 2 * mCurrentFrame, 2);
+            vkCmdWriteTimestamp(mCommandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, mTimestampQueryPool,
+                                2 * mCurrentFrame);
+            mTextureBenchmark.recordedFrames++;
+        }
 
         VkRenderPassBeginInfo renderPassBeginInfo{};
         renderPassBeginInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
@@ -1068,13 +1321,30 @@ namespace rn {
         renderPassBeginInfo.clearValueCount = clearValues.size();
         renderPassBeginInfo.pClearValues = clearValues.data();
 
-        vkCmdBeginRenderPass(mCommandBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+        // Everything inside the pass is recorded into secondary command buffers by Draw.
+        vkCmdBeginRenderPass(mCommandBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+    }
+
+    VkCommandBuffer Graphics::BeginSecondaryCommandBuffer(std::uint32_t slot) {
+        VkCommandBuffer commandBuffer = mSecondaryCommandPools->Acquire(mCurrentFrame, slot);
 
-        // Rendering the sky box // This has to be done before binding the main pipeline and rendering the scene else the scene will use the sky box pipeline
-        mSkyBox->RenderSkyBox();
+        VkCommandBufferInheritanceInfo inheritanceInfo{};
+        inheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+        inheritanceInfo.renderPass = mOffScreenRenderPass;
+        inheritanceInfo.subpass = 0;
+        inheritanceInfo.framebuffer = mOffScreenFrameBuffers[mCurrentImageIndex];
 
-        vkCmdBindPipeline(mCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, mPipeline);
+        VkCommandBufferBeginInfo beginInfo{};
+        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+        beginInfo.pInheritanceInfo = &inheritanceInfo;
+        Utility::CheckVulkanError(vkBeginCommandBuffer(commandBuffer, &beginInfo),
+                                  "Failed to begin the secondary command buffer");
+        return commandBuffer;
+    }
 
+    void Graphics::SetSceneViewportAndScissor(VkCommandBuffer commandBuffer) {
+        // Dynamic state is not inherited by secondary command buffers, every one of them sets it again.
         VkViewport viewport{};
         viewport.x = 0.0f;
         viewport.y = 0.0f;
@@ -1087,13 +1357,16 @@ namespace rn {
         scissor.offset = {0, 0};
         scissor.extent = mRendererContext.viewportExtends;
 
-        vkCmdSetViewport(mCommandBuffer, 0, 1, &viewport);
-        vkCmdSetScissor(mCommandBuffer, 0, 1, &scissor);
-
+        vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+        vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
     }
 
     void Graphics::EndOffScreenPass() {
         vkCmdEndRenderPass(mCommandBuffer);
+        if (mTextureBenchmark.framePhases[mCurrentFrame] != 0) {
+            vkCmdWriteTimestamp(mCommandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, mTimestampQueryPool,
+                                2 * mCurrentFrame + 1);
+        }
         CopyMouseImageToBuffer();
     }
 
@@ -1118,95 +1391,437 @@ namespace rn {
             return false;
         }
         mMutex.lock();
-        vkWaitForFences(mDevices.logicalDevice, 1, &mPresentFinishFence, VK_TRUE, UINT64_MAX);
-        vkResetFences(mDevices.logicalDevice, 1, &mPresentFinishFence);
-        VkResult result = vkAcquireNextImageKHR(mDevices.logicalDevice, mSwapChain, UINT64_MAX, mGetImageSemaphore,
+        // Only wait for the frame that used this slot last, the other frames keep running on the GPU.
+        vkWaitForFences(mDevices.logicalDevice, 1, &mInFlightFences[mCurrentFrame], VK_TRUE, UINT64_MAX);
+        ResolveMousePickQueries();
+        UpdateTextureBenchmark();
+        if (mSceneBenchmarkPending) {
+            mSceneBenchmarkPending = false;
+            RunSceneRecordingBenchmark();
+        }
+        // Everything loaded since the last frame goes out in one batch, ahead of this frame on the graphics queue.
+        mUploadQueue->Flush();
+        VkResult result = vkAcquireNextImageKHR(mDevices.logicalDevice, mSwapChain, UINT64_MAX,
+                                                mGetImageSemaphores[mCurrentFrame],
                                                 nullptr,
                                                 &mCurrentImageIndex);
         if (result == VK_ERROR_OUT_OF_DATE_KHR) {
             ReCreateSwapChain();
+            mMutex.unlock();
             return false;
         }
         if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR) {
             LOG_ERROR("Failed to acquire The valid Swapchain Image To Present.. Render Exiting");
             std::exit(EXIT_FAILURE);
         }
+        // The image can still be used by an older frame if the swapchain returns images out of order.
+        if (mImagesInFlight[mCurrentImageIndex] != VK_NULL_HANDLE) {
+            vkWaitForFences(mDevices.logicalDevice, 1, &mImagesInFlight[mCurrentImageIndex], VK_TRUE, UINT64_MAX);
+        }
+        mImagesInFlight[mCurrentImageIndex] = mInFlightFences[mCurrentFrame];
+        // Resetting only after a successful acquire so a skipped frame never leaves an unsignaled fence behind.
+        vkResetFences(mDevices.logicalDevice, 1, &mInFlightFences[mCurrentFrame]);
+
+        mCommandBuffer = mCommandBuffers[mCurrentFrame];
+        mRendererContext.mainCommandBuffer = mCommandBuffer;
+        mRendererContext.currentFrameIndex = mCurrentFrame;
+        // The first batch collects the shadow passes recorded in Draw, the main pass goes into the second one.
+        mFrameSubmission.Begin();
+        mUniformRing->BeginFrame(mCurrentFrame);
+        mInstanceBuffer->BeginFrame(mCurrentFrame);
+        mGeometryArena->BeginFrame();
+        mSecondaryCommandPools->Reset(mCurrentFrame);
+        UpdateFrameConstants();
         BeginOffScreenPass(mCurrentImageIndex);
         return true;
     }
 
     void Graphics::Draw() {
         //vkCmdDraw(mCommandBuffer, 3, 1, 0, 0);
+        // The shadow passes read the LODs as well, so they are picked before anything is recorded.
+        SelectMeshLods();
         // Setting the Shadow Scene Render Pass before the draw calls
 
         if (mDirectionalLight != nullptr) {
-            mDirectionalLight->GetShadowMap()->BeginShadowFrame();
-            mDirectionalLight->GetShadowMap()->EndShadowFrame();
-        }
-        mPointLights->RenderPointLightShadowScene();
-        Map<std::string, StaticMesh *, std::hash<std::string>>::iterator iter = meshObjectList.begin();
-        while (iter != meshObjectList.end()) {
-            List<VkDescriptorSet> descriptorSets{};
-            std::uint32_t currentIndex = std::distance(meshObjectList.begin(), iter);
-            std::uint32_t dynamicOffset = std::uint32_t(mModelMinAlignment) * currentIndex;
-
-            VkBuffer vertexBuffer = iter->second->GetVertexBuffer();
-            VkBuffer indexBuffer = iter->second->GetIndexBuffer();
-
-            VkDeviceSize offset = {0};
-            vkCmdBindVertexBuffers(mCommandBuffer, 0, 1, &vertexBuffer, &offset);
-            vkCmdBindIndexBuffer(mCommandBuffer, indexBuffer, 0, VK_INDEX_TYPE_UINT32);
-            // Binding the descriptor sets
-            UpdateMvpUniformBuffers(mCurrentImageIndex, currentIndex, iter->second->GetModelMatrix(),
-                                    iter->second->GetPickId());
-
-            if (mDirectionalLight != nullptr) {
-                mDirectionalLight->UpdateLightDescriptorSet(mCurrentImageIndex);
-            }
-            mPointLights->UpdatePointLightBuffers(mCurrentImageIndex);
-
-            VkDescriptorSet textureDescriptor{};
-            Map<std::string, Texture *, std::hash<std::string>>::iterator texIter = mTextureMap.find(
-                    (*iter).second->GetTextureId());
-            if (texIter == mTextureMap.end()) {
-                textureDescriptor = mTextureMap.find(
-                        R"(D:\cProjects\SmallVkEngine\textures\brick.png)")->second->GetTextureDescriptorSet();
-            } else {
-                textureDescriptor = texIter->second->GetTextureDescriptorSet();
-            }
-
-            descriptorSets.push_back(mViewProjectionDescriptorSets[mCurrentImageIndex]);
-            descriptorSets.push_back(textureDescriptor);
-            if (mDirectionalLight != nullptr) {
-                descriptorSets.push_back(mDirectionalLight->GetLightDescriptorSets(mCurrentImageIndex));
-                //   descriptorSets.push_back(mDirectionalLight->GetViewProjectionDescriptorSets(mCurrentImageIndex));
-                descriptorSets.push_back(mShadowDescriptorSet);
-            }
-            descriptorSets.push_back(mPointLights->GetDescriptorSet(mCurrentImageIndex));
-            descriptorSets.push_back(mPointLights->GetShadowDescriptorSet(mCurrentImageIndex));
-            vkCmdPushConstants(mCommandBuffer, mPipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(glm::mat4),
-                               &iter->second->GetModelMatrix());
-            vkCmdBindDescriptorSets(mCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, mPipelineLayout, 0,
-                                    descriptorSets.size(),
-                                    descriptorSets.data(), 1,
-                                    &dynamicOffset);
-            vkCmdDrawIndexed(mCommandBuffer, iter->second->GetStaticMeshIndicesCount(), 1, 0, 0, 0);
-            iter++;
+            mDirectionalLight->GetShadowMap()->BeginShadowFrame(mCurrentFrame);
+            mDirectionalLight->GetShadowMap()->EndShadowFrame(mCurrentFrame);
+        }
+        mPointLights->RenderPointLightShadowScene(mCurrentFrame);
+
+        // The recording thread uses the last job system slot, the same one it helps with while waiting on the jobs.
+        std::uint32_t recordingSlot = mJobSystem.GetSlotCount() - 1;
+        mSecondaryCommandBuffers.clear();
+        mDrawStatistics = DrawStatistics{};
+
+        // Rendering the sky box first so the scene is drawn over it
+        VkCommandBuffer skyBoxCommandBuffer = BeginSecondaryCommandBuffer(recordingSlot);
+        mSkyBox->RenderSkyBox(skyBoxCommandBuffer);
+        vkEndCommandBuffer(skyBoxCommandBuffer);
+        mSecondaryCommandBuffers.push_back(skyBoxCommandBuffer);
+
+        if (mIndirectDrawSupported) {
+            // The whole scene is a handful of indirect draws, a single secondary on this thread is enough.
+            CollectSceneDrawItems();
+            BuildIndirectDrawList(mSceneDrawItems);
+            VkCommandBuffer sceneCommandBuffer = BeginSecondaryCommandBuffer(recordingSlot);
+            RecordIndirectScene(sceneCommandBuffer, mDrawStatistics);
+            vkEndCommandBuffer(sceneCommandBuffer);
+            mSecondaryCommandBuffers.push_back(sceneCommandBuffer);
+        } else {
+            CollectSceneDrawItems();
+            size_t chunkCount = (mSceneDrawItems.size() + MIN_OBJECTS_PER_RECORDING_JOB - 1) /
+                                MIN_OBJECTS_PER_RECORDING_JOB;
+            chunkCount = std::min<size_t>(chunkCount, mJobSystem.GetSlotCount());
+            // Every object is at most one instance, growing has to happen before the jobs start allocating.
+            mInstanceBuffer->Reserve(static_cast<std::uint32_t>(mSceneDrawItems.size()));
+            RecordSceneChunks(mSceneDrawItems, chunkCount, mSecondaryCommandBuffers, mDrawStatistics);
         }
+
         // Drawing the active game object gizmo
-        Map<std::string, StaticMesh *, std::hash<std::string>>::iterator activeIter = std::find_if(
-                meshObjectList.begin(), meshObjectList.end(),
-                [&](const std::pair<std::string, StaticMesh *> &pair) -> bool {
-                    return pair.second->GetPickId() == mRendererContext.GetActiveClickedObjectId();
-                });
-        if (activeIter != meshObjectList.end()) {
-            glm::mat4 activeObjectModelMatrix = activeIter->second->GetModelMatrix();
+        Map<std::uint32_t, MeshHandle, std::hash<std::uint32_t>>::iterator activeIter = mMeshPickIds.find(
+                mRendererContext.GetActiveClickedObjectId());
+        StaticMesh **activeMesh = activeIter != mMeshPickIds.end() ? mMeshes.Get(activeIter->second) : nullptr;
+        if (activeMesh != nullptr) {
+            glm::mat4 activeObjectModelMatrix = (*activeMesh)->GetModelMatrix();
             glm::vec3 translation = activeObjectModelMatrix[3];
             glm::mat4 gizmoModelMatrix = glm::translate(glm::mat4{1}, translation);
             mGizmos->SetModelMatrix(gizmoModelMatrix);
-            mGizmos->DrawGizmos(mCurrentImageIndex);
+
+            VkCommandBuffer gizmoCommandBuffer = BeginSecondaryCommandBuffer(recordingSlot);
+            SetSceneViewportAndScissor(gizmoCommandBuffer);
+            mGizmos->DrawGizmos(gizmoCommandBuffer, mCurrentFrame);
+            vkEndCommandBuffer(gizmoCommandBuffer);
+            mSecondaryCommandBuffers.push_back(gizmoCommandBuffer);
+        }
+
+        vkCmdExecuteCommands(mCommandBuffer, mSecondaryCommandBuffers.size(), mSecondaryCommandBuffers.data());
+    }
+
+    void Graphics::SelectMeshLods() {
+        const ViewProjection &viewProjection = mRendererContext.frameViewProjection;
+        // The cotangent of half the vertical field of view, turns the radius over the distance into the share of the
+        // viewport height the bounding sphere covers.
+        float projectionScale = std::abs(viewProjection.projection[1][1]);
+        mLodStatistics = LodStatistics{};
+        for (StaticMesh *mesh: mMeshes) {
+            const glm::mat4 &model = mesh->GetModelMatrix();
+            const glm::vec4 &localSphere = mesh->GetBoundingSphere();
+            glm::vec4 viewCenter = viewProjection.view * model * glm::vec4{glm::vec3{localSphere}, 1.0f};
+            // Largest axis scale so the sphere still bounds the mesh under non uniform scaling.
+            float scale = std::max({glm::length(glm::vec3{model[0]}), glm::length(glm::vec3{model[1]}),
+                                    glm::length(glm::vec3{model[2]})});
+            float radius = localSphere.w * scale;
+            float distance = glm::length(glm::vec3{viewCenter});
+            std::uint32_t lod = 0;
+            if (distance > radius) {
+                float screenSize = radius * projectionScale / distance;
+                while (lod < MESH_LOD_SCREEN_SIZES.size() && screenSize < MESH_LOD_SCREEN_SIZES[lod]) {
+                    lod++;
+                }
+            }
+            mesh->SetLod(lod);
+
+            std::uint32_t sceneLod = mesh->GetLod();
+            std::uint32_t shadowLod = mesh->GetLod(SHADOW_LOD_BIAS);
+            mLodStatistics.sceneObjects[sceneLod]++;
+            mLodStatistics.sceneTriangles[sceneLod] += mesh->GetStaticMeshIndicesCount(sceneLod) / 3;
+            mLodStatistics.shadowObjects[shadowLod]++;
+            mLodStatistics.shadowTriangles[shadowLod] += mesh->GetStaticMeshIndicesCount(shadowLod) / 3;
+        }
+    }
+
+    const LodStatistics *Graphics::GetLodStatistics() {
+        return &mLodStatistics;
+    }
+
+    Texture *Graphics::GetSceneTexture(TextureHandle handle) {
+        Texture **texture = mTextures.Get(handle);
+        if (texture == nullptr) {
+            return *mTextures.Get(mDefaultTexture);
+        }
+        return *texture;
+    }
+
+    void Graphics::CollectSceneDrawItems() {
+        mSceneDrawItems.clear();
+        mSceneDrawItems.reserve(mMeshes.Size());
+        const glm::mat4 &view = mRendererContext.frameViewProjection.view;
+        for (StaticMesh *mesh: mMeshes) {
+            SceneDrawItem item{};
+            item.mesh = mesh;
+            item.lod = mesh->GetLod();
+            Texture *texture = GetSceneTexture(mesh->GetTextureHandle());
+            item.textureDescriptorSet = texture->GetTextureDescriptorSet();
+            item.textureIndex = texture->GetBindlessIndex();
+            // The texture is the only material state of the scene, and every object uses the same pipeline. Meshes
+            // are keyed by their index type and the first index of their LOD in the geometry arena, the copies of a
+            // geometry at the same LOD share both and end up next to each other for the instanced draws.
+            glm::vec4 center{glm::vec3{mesh->GetBoundingSphere()}, 1.0f};
+            glm::vec4 viewCenter = view * mesh->GetModelMatrix() * center;
+            item.sortKey = DrawKeySorter::MakeKey(0, mesh->GetIndexType(), mesh->GetTextureHandle().index,
+                                                  mesh->GetFirstIndex(item.lod), -viewCenter.z / DRAW_SORT_DEPTH_RANGE);
+            mSceneDrawItems.push_back(item);
+        }
+        if (mSortSceneDraws) {
+            SortSceneDrawItems(mSceneDrawItems);
+        }
+    }
+
+    void Graphics::SortSceneDrawItems(List<SceneDrawItem> &items) {
+        mSortKeys.clear();
+        for (const SceneDrawItem &item: items) {
+            mSortKeys.push_back(item.sortKey);
         }
+        const List<std::uint32_t> &order = mDrawKeySorter.Sort(mSortKeys);
+        mSortedDrawItems.clear();
+        for (std::uint32_t index: order) {
+            mSortedDrawItems.push_back(items[index]);
+        }
+        items.swap(mSortedDrawItems);
+    }
+
+    void Graphics::BuildIndirectDrawList(List<SceneDrawItem> &items) {
+        // The sort keys put objects sharing a texture next to each other, so they are drawn by the same batch. With
+        // the bindless table every object passes the same set and the whole scene is one batch.
+        VkDescriptorSet bindlessTextureSet = mBindlessTextureTable != nullptr
+                                             ? mBindlessTextureTable->GetDescriptorSet() : VK_NULL_HANDLE;
+        mIndirectDrawList->Begin(mCurrentFrame, static_cast<std::uint32_t>(items.size()));
+        for (const SceneDrawItem &item: items) {
+            VkDescriptorSet textureSet = bindlessTextureSet != VK_NULL_HANDLE ? bindlessTextureSet
+                                                                              : item.textureDescriptorSet;
+            mIndirectDrawList->Add(item.mesh, item.lod, textureSet, item.textureIndex);
+        }
+    }
+
+    void Graphics::RecordIndirectScene(VkCommandBuffer commandBuffer, DrawStatistics &statistics) {
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, mIndirectPipeline);
+        statistics.pipelineBinds++;
+        SetSceneViewportAndScissor(commandBuffer);
+
+        // The draw list binds the index buffer of every batch.
+        mGeometryArena->BindVertexBuffers(commandBuffer, VERTEX_ATTRIBUTE_ALL);
+        statistics.vertexBufferBinds++;
+
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, mIndirectPipelineLayout, 0, 1,
+                                &mViewProjectionDescriptorSet, 1, &mRendererContext.viewProjectionOffset);
+
+        // Same light sets as the direct path, the texture set in between is bound per batch by the draw list, which
+        // is once for the whole scene with the bindless texture table.
+        List<VkDescriptorSet> descriptorSets{};
+        List<std::uint32_t> dynamicOffsets{};
+        if (mDirectionalLight != nullptr) {
+            descriptorSets.push_back(mDirectionalLight->GetLightDescriptorSet());
+            dynamicOffsets.push_back(mDirectionalLight->GetLightUniformOffset());
+            descriptorSets.push_back(mShadowDescriptorSet);
+        }
+        descriptorSets.push_back(mPointLights->GetDescriptorSet());
+        dynamicOffsets.push_back(mPointLights->GetUniformOffset());
+        descriptorSets.push_back(mPointLights->GetShadowDescriptorSet(mCurrentFrame));
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, mIndirectPipelineLayout, 2,
+                                descriptorSets.size(), descriptorSets.data(), dynamicOffsets.size(),
+                                dynamicOffsets.data());
+        statistics.descriptorSetBinds += 1 + static_cast<std::uint32_t>(descriptorSets.size());
+
+        mIndirectDrawList->Record(commandBuffer, mIndirectPipelineLayout, 1, OBJECT_DATA_SET, statistics);
+    }
+
+    void Graphics::RecordSceneDrawItems(VkCommandBuffer commandBuffer, const SceneDrawItem *items, size_t count,
+                                        DrawStatistics &statistics) {
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, mPipeline);
+        statistics.pipelineBinds++;
+        SetSceneViewportAndScissor(commandBuffer);
+
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, mPipelineLayout, 0, 1,
+                                &mViewProjectionDescriptorSet, 1, &mRendererContext.viewProjectionOffset);
+        VkDescriptorSet instanceSet = mInstanceBuffer->GetDescriptorSet();
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, mPipelineLayout, OBJECT_DATA_SET, 1,
+                                &instanceSet, 0, nullptr);
+        statistics.descriptorSetBinds += 2;
+
+        // The light sets are the same for every object, only the texture changes between the draws.
+        List<VkDescriptorSet> descriptorSets{};
+        List<std::uint32_t> dynamicOffsets{};
+        if (mDirectionalLight != nullptr) {
+            descriptorSets.push_back(mDirectionalLight->GetLightDescriptorSet());
+            dynamicOffsets.push_back(mDirectionalLight->GetLightUniformOffset());
+            //   descriptorSets.push_back(mDirectionalLight->GetViewProjectionDescriptorSets(mCurrentImageIndex));
+            descriptorSets.push_back(mShadowDescriptorSet);
+        }
+        descriptorSets.push_back(mPointLights->GetDescriptorSet());
+        dynamicOffsets.push_back(mPointLights->GetUniformOffset());
+        descriptorSets.push_back(mPointLights->GetShadowDescriptorSet(mCurrentFrame));
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, mPipelineLayout, 2,
+                                descriptorSets.size(), descriptorSets.data(), dynamicOffsets.size(),
+                                dynamicOffsets.data());
+        statistics.descriptorSetBinds += static_cast<std::uint32_t>(descriptorSets.size());
+
+        // Binds that would not change the state are skipped, the meshes of the geometry arena all share its buffers.
+        VkDescriptorSet boundTextureSet = VK_NULL_HANDLE;
+        VkBuffer boundVertexBuffer = VK_NULL_HANDLE;
+        VkBuffer boundIndexBuffer = VK_NULL_HANDLE;
+        size_t runEnd = 0;
+        for (size_t i = 0; i < count; i = runEnd) {
+            const SceneDrawItem &item = items[i];
+            // Consecutive objects sharing the texture and the geometry are drawn as instances of one draw.
+            runEnd = i + 1;
+            while (runEnd < count && items[runEnd].textureDescriptorSet == item.textureDescriptorSet &&
+                   InstanceBuffer::SameGeometry(items[runEnd].mesh, items[runEnd].lod, item.mesh, item.lod)) {
+                runEnd++;
+            }
+            std::uint32_t instanceCount = static_cast<std::uint32_t>(runEnd - i);
+            ObjectData *instances = nullptr;
+            std::uint32_t firstInstance = mInstanceBuffer->Allocate(instanceCount, instances);
+            for (std::uint32_t instance = 0; instance < instanceCount; instance++) {
+                const StaticMesh *mesh = items[i + instance].mesh;
+                instances[instance].model = mesh->GetModelMatrix();
+                instances[instance].pickId = mesh->GetPickId();
+                instances[instance].textureIndex = items[i + instance].textureIndex;
+            }
+
+            VkBuffer vertexBuffer = item.mesh->GetVertexBuffer();
+            VkBuffer indexBuffer = item.mesh->GetIndexBuffer();
+
+            if (vertexBuffer != boundVertexBuffer) {
+                mGeometryArena->BindVertexBuffers(commandBuffer, VERTEX_ATTRIBUTE_ALL);
+                boundVertexBuffer = vertexBuffer;
+                statistics.vertexBufferBinds++;
+            }
+            if (indexBuffer != boundIndexBuffer) {
+                vkCmdBindIndexBuffer(commandBuffer, indexBuffer, 0, item.mesh->GetIndexType());
+                boundIndexBuffer = indexBuffer;
+                statistics.indexBufferBinds++;
+            }
+
+            if (item.textureDescriptorSet != boundTextureSet) {
+                vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, mPipelineLayout, 1, 1,
+                                        &item.textureDescriptorSet, 0, nullptr);
+                boundTextureSet = item.textureDescriptorSet;
+                statistics.descriptorSetBinds++;
+            }
+            vkCmdDrawIndexed(commandBuffer, item.mesh->GetStaticMeshIndicesCount(item.lod), instanceCount,
+                             item.mesh->GetFirstIndex(item.lod), item.mesh->GetVertexOffset(), firstInstance);
+            statistics.drawCalls++;
+        }
+    }
+
+    void Graphics::RecordSceneChunks(const List<SceneDrawItem> &items, size_t chunkCount,
+                                     List<VkCommandBuffer> &commandBuffers, DrawStatistics &statistics) {
+        if (chunkCount == 0 || items.empty()) {
+            return;
+        }
+        size_t firstChunk = commandBuffers.size();
+        size_t chunkSize = (items.size() + chunkCount - 1) / chunkCount;
+        commandBuffers.resize(firstChunk + chunkCount, VK_NULL_HANDLE);
+        // Every job counts into its own entry, they are summed once all jobs are done.
+        List<DrawStatistics> chunkStatistics(chunkCount);
+        for (size_t chunk = 0; chunk < chunkCount; chunk++) {
+            size_t begin = std::min(chunk * chunkSize, items.size());
+            size_t end = std::min(begin + chunkSize, items.size());
+            mJobSystem.Submit([this, &items, &commandBuffers, &chunkStatistics, firstChunk, chunk, begin,
+                                      end](std::uint32_t slot) {
+                VkCommandBuffer commandBuffer = BeginSecondaryCommandBuffer(slot);
+                RecordSceneDrawItems(commandBuffer, items.data() + begin, end - begin, chunkStatistics[chunk]);
+                vkEndCommandBuffer(commandBuffer);
+                // Chunks keep their slot in the list, so the draw order does not depend on the scheduling.
+                commandBuffers[firstChunk + chunk] = commandBuffer;
+            });
+        }
+        mJobSystem.Wait();
+        for (const DrawStatistics &chunk: chunkStatistics) {
+            statistics += chunk;
+        }
+    }
+
+    void Graphics::LogMemoryStatistics() const {
+        mMemoryAllocator->LogStatistics();
+        mUploadQueue->LogStatistics();
+        mOneShotCommands->LogStatistics();
+    }
+
+    void Graphics::ToggleDrawSorting() {
+        std::lock_guard<std::mutex> guard{mMutex};
+        mSortSceneDraws = !mSortSceneDraws;
+        LOG_INFO("Scene draw sorting {}", mSortSceneDraws ? "enabled" : "disabled");
+    }
+
+    void Graphics::LogDrawStatistics() const {
+        LOG_INFO("Scene draws ({}) : {} draw calls, {} pipeline binds, {} descriptor set binds, "
+                 "{} vertex buffer binds, {} index buffer binds", mSortSceneDraws ? "sorted" : "unsorted",
+                 mDrawStatistics.drawCalls, mDrawStatistics.pipelineBinds, mDrawStatistics.descriptorSetBinds,
+                 mDrawStatistics.vertexBufferBinds, mDrawStatistics.indexBufferBinds);
+    }
+
+    void Graphics::BenchmarkTextureSampling() {
+        std::lock_guard<std::mutex> guard{mMutex};
+        if (!mTimestampsSupported) {
+            LOG_WARN("Texture sampling benchmark needs timestamp queries on the graphics queue");
+            return;
+        }
+        if (mTextureBenchmark.phase != 0) {
+            LOG_WARN("Texture sampling benchmark is already running");
+            return;
+        }
+        mTextureBenchmark = TextureBenchmark{};
+        mTextureBenchmark.phase = 1;
+        LOG_INFO("Texture sampling benchmark : timing {} frames with mip chains, then {} frames with base levels only",
+                 TEXTURE_BENCHMARK_FRAMES, TEXTURE_BENCHMARK_FRAMES);
+    }
+
+    void Graphics::BenchmarkSceneRecording() {
+        std::lock_guard<std::mutex> guard{mMutex};
+        mSceneBenchmarkPending = true;
+    }
 
+    void Graphics::RunSceneRecordingBenchmark() {
+        if (mMeshes.Empty()) {
+            LOG_WARN("Scene recording benchmark needs at least one mesh in the scene");
+            return;
+        }
+        // Every pass starts the instance region over, which ages the retired buffers the other frames may still read.
+        WaitForFramesInFlight();
+        mUniformRing->BeginFrame(mCurrentFrame);
+        UpdateFrameConstants();
+        CollectSceneDrawItems();
+        SceneDrawItem item = mSceneDrawItems.front();
+
+        List<VkCommandBuffer> commandBuffers{};
+        DrawStatistics statistics{};
+        std::uint32_t slotCount = mJobSystem.GetSlotCount();
+        for (size_t objectCount: {1000, 10000, 50000}) {
+            List<SceneDrawItem> items(objectCount, item);
+            // One chunk per thread, so no more than threadCount jobs can run at the same time.
+            std::uint32_t threadCount = 1;
+            while (true) {
+                mSecondaryCommandPools->Reset(mCurrentFrame);
+                mInstanceBuffer->BeginFrame(mCurrentFrame);
+                mInstanceBuffer->Reserve(static_cast<std::uint32_t>(objectCount));
+                commandBuffers.clear();
+                // The copies share the geometry and the texture, so every chunk is a single instanced draw.
+                statistics = DrawStatistics{};
+                std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+                RecordSceneChunks(items, threadCount, commandBuffers, statistics);
+                std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+                LOG_INFO("Scene recording benchmark : {} objects, {} threads, {} draws, {:.3f} ms", objectCount,
+                         threadCount, statistics.drawCalls, elapsed.count());
+                if (threadCount == slotCount) {
+                    break;
+                }
+                threadCount = std::min(threadCount * 2, slotCount);
+            }
+            if (mIndirectDrawSupported) {
+                // The indirect time includes writing the object data and draw commands, not only the recording.
+                mSecondaryCommandPools->Reset(mCurrentFrame);
+                std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+                BuildIndirectDrawList(items);
+                VkCommandBuffer commandBuffer = BeginSecondaryCommandBuffer(slotCount - 1);
+                RecordIndirectScene(commandBuffer, statistics);
+                vkEndCommandBuffer(commandBuffer);
+                std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+                LOG_INFO("Scene recording benchmark : {} objects, indirect, {} batches, {:.3f} ms", objectCount,
+                         mIndirectDrawList->GetBatchCount(), elapsed.count());
+            }
+        }
+        mSecondaryCommandPools->Reset(mCurrentFrame);
     }
 
     void Graphics::EndFrame() {
@@ -1216,45 +1831,36 @@ namespace rn {
         ImGui_ImplVulkan_RenderDrawData(ImGui::GetDrawData(), mCommandBuffer);
         vkCmdEndRenderPass(mCommandBuffer);
         Utility::CheckVulkanError(vkEndCommandBuffer(mCommandBuffer), "Failed to end the Command Buffer");
-        VkSubmitInfo commandSubmitInfo{};
 
-        List<VkSemaphore> waitSemaphores{mGetImageSemaphore};
-        List<VkPipelineStageFlags> waitStageFlags{VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
-        if (mDirectionalLight != nullptr) {
-            waitSemaphores.push_back(mDirectionalLight->GetShadowMap()->GetShadowMapSemaphore());
-            waitStageFlags.push_back(VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
-        }
-        waitSemaphores.push_back(mPointLights->GetShadowMapSemaphore());
-        waitStageFlags.push_back(VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
-        VkPipelineStageFlags stageFlags = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-        commandSubmitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-        commandSubmitInfo.commandBufferCount = 1;
-        commandSubmitInfo.pCommandBuffers = &mCommandBuffer;
-        commandSubmitInfo.waitSemaphoreCount = waitSemaphores.size();
-        commandSubmitInfo.pWaitSemaphores = waitSemaphores.data();
-        commandSubmitInfo.signalSemaphoreCount = 1;
-        commandSubmitInfo.pSignalSemaphores = &mPresentImageSemaphore;
-        commandSubmitInfo.pWaitDstStageMask = waitStageFlags.data();
-
-        Utility::CheckVulkanError(vkQueueSubmit(mGraphicsQueue, 1, &commandSubmitInfo, mPresentFinishFence),
+        // Only the main pass waits for the swapchain image, the shadow batch before it can start right away.
+        mFrameSubmission.NextBatch();
+        mFrameSubmission.AddWaitSemaphore(mGetImageSemaphores[mCurrentFrame],
+                                          VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT);
+        mFrameSubmission.AddCommandBuffer(mCommandBuffer);
+        mFrameSubmission.AddSignalSemaphore(mPresentImageSemaphores[mCurrentFrame]);
+
+        // The presentation queue is usually the graphics queue, so the present is covered by the same lock.
+        std::unique_lock<std::mutex> queueLock{mGraphicsQueueMutex};
+        Utility::CheckVulkanError(mFrameSubmission.Submit(mGraphicsQueue, mInFlightFences[mCurrentFrame]),
                                   "Failed to submit the command to the queue");
 
         VkPresentInfoKHR presentInfo{};
         presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
         presentInfo.waitSemaphoreCount = 1;
-        presentInfo.pWaitSemaphores = &mPresentImageSemaphore;
+        presentInfo.pWaitSemaphores = &mPresentImageSemaphores[mCurrentFrame];
         presentInfo.swapchainCount = 1;
         presentInfo.pSwapchains = &mSwapChain;
         presentInfo.pImageIndices = &mCurrentImageIndex;
 
         VkResult presentResult = vkQueuePresentKHR(mPresentationQueue, &presentInfo);
+        queueLock.unlock();
         if (presentResult == VK_ERROR_OUT_OF_DATE_KHR || presentResult == VK_SUBOPTIMAL_KHR) {
             mRendererContext.AddRendererEvent({RendererEvent::Type::WINDOW_RESIZE});
         } else if (presentResult != VK_SUCCESS) {
             LOG_ERROR("Swapchain Present Error.. Render is Exiting");
             std::exit(EXIT_FAILURE);
         }
-        SetActiveClickObject();
+        mCurrentFrame = (mCurrentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
         mMutex.unlock();
     }
 
@@ -1308,18 +1914,12 @@ namespace rn {
         VkDescriptorSetLayoutBinding viewProjectionBinding{};
         viewProjectionBinding.binding = 0;
         viewProjectionBinding.descriptorCount = 1;
-        viewProjectionBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        viewProjectionBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
         viewProjectionBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
         viewProjectionBinding.pImmutableSamplers = nullptr;
 
-        VkDescriptorSetLayoutBinding modelDynamicBinding{};
-        modelDynamicBinding.binding = 1;
-        modelDynamicBinding.descriptorCount = 1;
-        modelDynamicBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
-        modelDynamicBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
-        modelDynamicBinding.pImmutableSamplers = nullptr;
-
-        List<VkDescriptorSetLayoutBinding> layoutBinding = {viewProjectionBinding, modelDynamicBinding};
+        // The per object data is read from the instance buffer, the set only holds the view projection.
+        List<VkDescriptorSetLayoutBinding> layoutBinding = {viewProjectionBinding};
 
         VkDescriptorSetLayoutCreateInfo layoutCreateInfo{};
         layoutCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
@@ -1349,7 +1949,7 @@ namespace rn {
 
         VkDescriptorSetLayoutBinding lightsLayoutBinding{};
         lightsLayoutBinding.binding = 0;
-        lightsLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        lightsLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
         lightsLayoutBinding.descriptorCount = 1;
         lightsLayoutBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
         lightsLayoutBinding.pImmutableSamplers = nullptr;
@@ -1377,7 +1977,7 @@ namespace rn {
         // Create the point light for the descriptor set layout;
         VkDescriptorSetLayoutBinding pointLightBinding{};
         pointLightBinding.binding = 0;
-        pointLightBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        pointLightBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
         pointLightBinding.descriptorCount = 1;
         pointLightBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
         pointLightBinding.pImmutableSamplers = nullptr;
@@ -1429,22 +2029,40 @@ namespace rn {
                                                               &mPointLightShadowLayout),
                                   "Failed to create the layout for the point light shadows");
         mRendererContext.pointLightShadowLayout = mPointLightShadowLayout;
+
+        // Per-object storage buffer of the scene and the shadow passes.
+        VkDescriptorSetLayoutBinding objectDataBinding{};
+        objectDataBinding.binding = 0;
+        objectDataBinding.descriptorCount = 1;
+        objectDataBinding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        objectDataBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+        objectDataBinding.pImmutableSamplers = nullptr;
+
+        VkDescriptorSetLayoutCreateInfo objectDataLayoutCreateInfo{};
+        objectDataLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        objectDataLayoutCreateInfo.bindingCount = 1;
+        objectDataLayoutCreateInfo.pBindings = &objectDataBinding;
+        Utility::CheckVulkanError(vkCreateDescriptorSetLayout(mDevices.logicalDevice, &objectDataLayoutCreateInfo,
+                                                              nullptr, &mObjectDataDescriptorSetLayout),
+                                  "Failed to create the layout for the object data");
+
+        if (mBindlessTexturesSupported) {
+            // Owns its layout, the indirect pipeline uses it as the texture set.
+            mBindlessTextureTable = new BindlessTextureTable(&mRendererContext, mBindlessTextureCapacity);
+            mRendererContext.bindlessTextureTable = mBindlessTextureTable;
+        }
     }
 
     void Graphics::CreateDescriptorPool() {
         VkDescriptorPoolSize viewProjectionPoolSize{};
-        viewProjectionPoolSize.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-        viewProjectionPoolSize.descriptorCount = static_cast<std::uint32_t>(mViewProjectionBuffers.size());
-
-        VkDescriptorPoolSize modelDynamicBufferPoolSize{};
-        modelDynamicBufferPoolSize.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
-        modelDynamicBufferPoolSize.descriptorCount = static_cast<std::uint32_t>(mDynamicBuffers.size());
+        viewProjectionPoolSize.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+        viewProjectionPoolSize.descriptorCount = 1;
 
-        List<VkDescriptorPoolSize> poolSize{viewProjectionPoolSize, modelDynamicBufferPoolSize};
+        List<VkDescriptorPoolSize> poolSize{viewProjectionPoolSize};
 
         VkDescriptorPoolCreateInfo viewProjectionDescriptorCreateInfo{};
         viewProjectionDescriptorCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-        viewProjectionDescriptorCreateInfo.maxSets = static_cast<std::uint32_t>(mSwapChainImageViews.size());
+        viewProjectionDescriptorCreateInfo.maxSets = 1;
         viewProjectionDescriptorCreateInfo.poolSizeCount = poolSize.size();
         viewProjectionDescriptorCreateInfo.pPoolSizes = poolSize.data();
 
@@ -1471,13 +2089,13 @@ namespace rn {
         mRendererContext.samplerDescriptorPool = mSamplerDescriptorPool;
         // Creating the descriptor pool for the lights;
         VkDescriptorPoolSize lightsPoolSize{};
-        lightsPoolSize.descriptorCount = static_cast<std::uint32_t>(mSwapChainImageViews.size()); // for directional lights and the point lights
-        lightsPoolSize.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        lightsPoolSize.descriptorCount = 1; // for directional lights and the point lights
+        lightsPoolSize.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
 
         List<VkDescriptorPoolSize> lightsDescriptorPoolSizes{lightsPoolSize};
         VkDescriptorPoolCreateInfo lightsPoolCreateInfo{};
         lightsPoolCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-        lightsPoolCreateInfo.maxSets = static_cast<std::uint32_t>(mSwapChainImageViews.size());
+        lightsPoolCreateInfo.maxSets = 1;
         lightsPoolCreateInfo.poolSizeCount = lightsDescriptorPoolSizes.size();
         lightsPoolCreateInfo.pPoolSizes = lightsDescriptorPoolSizes.data();
 
@@ -1489,14 +2107,14 @@ namespace rn {
         mRendererContext.lightsDescriptorPool = mLightDescriptorPool;
         // Creating the descriptor Pool for the point lights.
         VkDescriptorPoolSize pointLightPoolSize{};
-        pointLightPoolSize.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-        pointLightPoolSize.descriptorCount = mSwapChainImages.size();
+        pointLightPoolSize.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+        pointLightPoolSize.descriptorCount = 1;
 
 
         List<VkDescriptorPoolSize> pointLightPoolSizes{pointLightPoolSize};
         VkDescriptorPoolCreateInfo pointLightPoolCreateInfo{};
         pointLightPoolCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-        pointLightPoolCreateInfo.maxSets = static_cast<std::uint32_t>(mSwapChainImageViews.size());
+        pointLightPoolCreateInfo.maxSets = 1;
         pointLightPoolCreateInfo.poolSizeCount = pointLightPoolSizes.size();
         pointLightPoolCreateInfo.pPoolSizes = pointLightPoolSizes.data();
 
@@ -1525,12 +2143,12 @@ namespace rn {
         // Creating the descriptor Pool for the point light shadows;
         VkDescriptorPoolSize pointLightDescriptorPoolSize{};
         pointLightDescriptorPoolSize.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-        pointLightDescriptorPoolSize.descriptorCount = mSwapChainImageViews.size() * MAX_POINT_LIGHTS;
+        pointLightDescriptorPoolSize.descriptorCount = MAX_FRAMES_IN_FLIGHT * MAX_POINT_LIGHTS;
 
         List<VkDescriptorPoolSize> pointLightDescPoolSizes{pointLightDescriptorPoolSize};
         VkDescriptorPoolCreateInfo pointLightDescPoolCreateInfo{};
         pointLightDescPoolCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-        pointLightDescPoolCreateInfo.maxSets = mSwapChainImageViews.size();
+        pointLightDescPoolCreateInfo.maxSets = MAX_FRAMES_IN_FLIGHT;
         pointLightDescPoolCreateInfo.flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
         pointLightDescPoolCreateInfo.poolSizeCount = pointLightDescPoolSizes.size();
         pointLightDescPoolCreateInfo.pPoolSizes = pointLightDescPoolSizes.data();
@@ -1542,55 +2160,34 @@ namespace rn {
     }
 
     void Graphics::AllocateDescriptorSets() {
-        mViewProjectionDescriptorSets.resize(mSwapChainImageViews.size());
-        List<VkDescriptorSetLayout> mvpDescriptorLayouts(mSwapChainImageViews.size(),
-                                                         mViewProjectionDescriptorSetLayout);
-
         VkDescriptorSetAllocateInfo mvpDescriptorSetAllocateInfo{};
         mvpDescriptorSetAllocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-        mvpDescriptorSetAllocateInfo.descriptorSetCount = static_cast<std::uint32_t>(mSwapChainImageViews.size());
-        mvpDescriptorSetAllocateInfo.pSetLayouts = mvpDescriptorLayouts.data();
+        mvpDescriptorSetAllocateInfo.descriptorSetCount = 1;
+        mvpDescriptorSetAllocateInfo.pSetLayouts = &mViewProjectionDescriptorSetLayout;
         mvpDescriptorSetAllocateInfo.descriptorPool = mViewProjectionDescriptorPool;
 
         Utility::CheckVulkanError(vkAllocateDescriptorSets(mDevices.logicalDevice, &mvpDescriptorSetAllocateInfo,
-                                                           mViewProjectionDescriptorSets.data()),
+                                                           &mViewProjectionDescriptorSet),
                                   "Failed to allocate the descriptor set for the view and projection matrix");
-        mRendererContext.viewProjectionDescriptorSet = mViewProjectionDescriptorSets.data();
-        for (size_t i = 0; i < mSwapChainImageViews.size(); i++) {
-            VkDescriptorBufferInfo viewProjectionBufferInfo{};
-            viewProjectionBufferInfo.buffer = mViewProjectionBuffers[i];
-            viewProjectionBufferInfo.offset = 0;
-            viewProjectionBufferInfo.range = sizeof(ViewProjection);
-
-            VkWriteDescriptorSet viewProjectionWriteInfo{};
-            viewProjectionWriteInfo.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-            viewProjectionWriteInfo.descriptorCount = 1;
-            viewProjectionWriteInfo.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-            viewProjectionWriteInfo.dstBinding = 0;
-            viewProjectionWriteInfo.dstArrayElement = 0;
-            viewProjectionWriteInfo.pBufferInfo = &viewProjectionBufferInfo;
-            viewProjectionWriteInfo.dstSet = mViewProjectionDescriptorSets[i];
-
-            // Writing the Model dynamic info;
-            VkDescriptorBufferInfo modelBufferInfo{};
-            modelBufferInfo.buffer = mDynamicBuffers[i];
-            modelBufferInfo.offset = 0;
-            modelBufferInfo.range = sizeof(ModelUBO);
-
-            VkWriteDescriptorSet modelWriteInfo{};
-            modelWriteInfo.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-            modelWriteInfo.descriptorCount = 1;
-            modelWriteInfo.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
-            modelWriteInfo.dstBinding = 1;
-            modelWriteInfo.dstArrayElement = 0;
-            modelWriteInfo.pBufferInfo = &modelBufferInfo;
-            modelWriteInfo.dstSet = mViewProjectionDescriptorSets[i];
-
-
-            List<VkWriteDescriptorSet> writeInfo{viewProjectionWriteInfo, modelWriteInfo};
-            vkUpdateDescriptorSets(mDevices.logicalDevice, writeInfo.size(), writeInfo.data(),
-                                   0, nullptr);
-        }
+        mRendererContext.viewProjectionDescriptorSet = &mViewProjectionDescriptorSet;
+
+        VkDescriptorBufferInfo viewProjectionBufferInfo{};
+        viewProjectionBufferInfo.buffer = mUniformRing->GetBuffer();
+        viewProjectionBufferInfo.offset = 0;
+        viewProjectionBufferInfo.range = sizeof(ViewProjection);
+
+        VkWriteDescriptorSet viewProjectionWriteInfo{};
+        viewProjectionWriteInfo.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        viewProjectionWriteInfo.descriptorCount = 1;
+        viewProjectionWriteInfo.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+        viewProjectionWriteInfo.dstBinding = 0;
+        viewProjectionWriteInfo.dstArrayElement = 0;
+        viewProjectionWriteInfo.pBufferInfo = &viewProjectionBufferInfo;
+        viewProjectionWriteInfo.dstSet = mViewProjectionDescriptorSet;
+
+        List<VkWriteDescriptorSet> writeInfo{viewProjectionWriteInfo};
+        vkUpdateDescriptorSets(mDevices.logicalDevice, writeInfo.size(), writeInfo.data(),
+                               0, nullptr);
         // Allocating the descriptor set for the shadow Mapping.
 
 
@@ -1605,55 +2202,35 @@ namespace rn {
     }
 
     void Graphics::CreateUniformBuffers() {
-        mViewProjectionBuffers.resize(mSwapChainImageViews.size());
-        mViewProjectionMemory.resize(mSwapChainImageViews.size());
-        VkDeviceSize viewProjectionSize = sizeof(ViewProjection);
-
-        mDynamicBuffers.resize(mSwapChainImageViews.size());
-        mDynamicBufferMemory.resize(mSwapChainImageViews.size());
-        VkDeviceSize dynamicBufferSize = sizeof(ModelUBO) * Utility::MAX_OBJECTS;
+        // Every per frame uniform upload of the renderer is sub-allocated from this ring.
+        mUniformRing = new UniformRing(&mRendererContext, UNIFORM_RING_FRAME_SIZE);
+        mRendererContext.uniformRing = mUniformRing;
+    }
 
-        for (size_t i = 0; i < mSwapChainImageViews.size(); i++) {
-            std::string viewProjectionBufferName = "View Projection Buffer";
-            Utility::CreateBuffer(mRendererContext, mViewProjectionBuffers[i], VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
-                                  mViewProjectionMemory[i],
-                                  (VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT),
-                                  viewProjectionSize, viewProjectionBufferName);
-            std::string dynamicBufferName = "Model Dynamic Buffer";
-            Utility::CreateBuffer(mRendererContext, mDynamicBuffers[i], (VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT),
-                                  mDynamicBufferMemory[i],
-                                  (VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT),
-                                  dynamicBufferSize, dynamicBufferName);
+    void Graphics::CreateSceneBuffers() {
+        mGeometryArena = new GeometryArena(&mRendererContext, GEOMETRY_ARENA_VERTEX_COUNT, GEOMETRY_ARENA_INDEX_COUNT,
+                                           GEOMETRY_ARENA_SHORT_INDEX_COUNT);
+        mRendererContext.geometryArena = mGeometryArena;
+        mInstanceBuffer = new InstanceBuffer(&mRendererContext, mObjectDataDescriptorSetLayout,
+                                             INITIAL_FRAME_INSTANCES);
+        mRendererContext.instanceBuffer = mInstanceBuffer;
+        if (mIndirectDrawSupported) {
+            mIndirectDrawList = new IndirectDrawList(&mRendererContext, mObjectDataDescriptorSetLayout,
+                                                     INITIAL_INDIRECT_DRAW_OBJECTS, mMultiDrawIndirectSupported,
+                                                     mCmdDrawIndexedIndirectCount);
         }
     }
 
 
-    void
-    Graphics::UpdateMvpUniformBuffers(size_t currentImageIndex, std::uint32_t currentObjectIndex, glm::mat4 model,
-                                      std::uint32_t pickId) {
-        void *data;
-        // Updating the view and model matrix;
-        vkMapMemory(mDevices.logicalDevice, mViewProjectionMemory[currentImageIndex], 0, sizeof(ViewProjection), 0,
-                    &data);
-        memcpy(data, &mViewProjection, sizeof(ViewProjection));
-        vkUnmapMemory(mDevices.logicalDevice, mViewProjectionMemory[currentImageIndex]);
-
-        // Updating the Model Matrix;
-        // Getting the current Mesh Model Memory Index;
-        ModelUBO *pModel = (ModelUBO *) (
-                (std::uint64_t) mModelTransferSpace + currentObjectIndex * mModelMinAlignment);
-        pModel->model = model;
-        pModel->pickId = pickId;
-        vkMapMemory(mDevices.logicalDevice, mDynamicBufferMemory[currentImageIndex],
-                    currentObjectIndex * mModelMinAlignment, sizeof(ModelUBO), 0, &data);
-        memcpy(data, pModel, sizeof(ModelUBO));
-        vkUnmapMemory(mDevices.logicalDevice, mDynamicBufferMemory[currentImageIndex]);
-    }
+    void Graphics::UpdateFrameConstants() {
+        // The camera can be moved by the engine thread at any time, so the frame works on its own copy.
+        mRendererContext.frameViewProjection = mViewProjection;
+        mRendererContext.viewProjectionOffset = mUniformRing->Push(mRendererContext.frameViewProjection);
 
-    void Graphics::AllocateDynamicBufferTransferSpace() {
-        mModelMinAlignment = (sizeof(ModelUBO) + mBufferMinAlignment - 1) & ~(mBufferMinAlignment - 1);
-        mModelTransferSpace = (ModelUBO *) _aligned_malloc(mModelMinAlignment * Utility::MAX_OBJECTS,
-                                                           mModelMinAlignment);
+        if (mDirectionalLight != nullptr) {
+            mDirectionalLight->UpdateLightDescriptorSet();
+        }
+        mPointLights->UpdatePointLightBuffers();
     }
 
     ViewProjection Graphics::mViewProjection = {};
@@ -1674,8 +2251,8 @@ namespace rn {
                                               VK_FORMAT_D24_UNORM_S8_UINT};
             mDepthBufferFormat = ChooseSupportedFormats(requiredFormats, VK_IMAGE_TILING_OPTIMAL,
                                                         VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT);
-            mDepthBufferImages[i] = Utility::CreateImage("Depth BufferImage", mDevices.physicalDevice,
-                                                         mDevices.logicalDevice, mRendererContext.viewportExtends.width,
+            mDepthBufferImages[i] = Utility::CreateImage("Depth BufferImage", mRendererContext,
+                                                         mRendererContext.viewportExtends.width,
                                                          mRendererContext.viewportExtends.height, mDepthBufferFormat,
                                                          VK_IMAGE_TILING_OPTIMAL,
                                                          (VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT),
@@ -1719,7 +2296,8 @@ namespace rn {
         samplerCreateInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
         samplerCreateInfo.mipLodBias = 0.0f;
         samplerCreateInfo.minLod = 0.0f;
-        samplerCreateInfo.maxLod = 0.0f;
+        // Every level of the mip chain is sampled.
+        samplerCreateInfo.maxLod = VK_LOD_CLAMP_NONE;
         samplerCreateInfo.anisotropyEnable = VK_TRUE;
         samplerCreateInfo.maxAnisotropy = 16;
 
@@ -1727,25 +2305,39 @@ namespace rn {
                 vkCreateSampler(mDevices.logicalDevice, &samplerCreateInfo, nullptr, &mTextureSampler),
                 "Failed to create the sampler for the textures");
         mRendererContext.textureSampler = mTextureSampler;
+
+        samplerCreateInfo.maxLod = 0.0f;
+        Utility::CheckVulkanError(
+                vkCreateSampler(mDevices.logicalDevice, &samplerCreateInfo, nullptr, &mBaseLevelSampler),
+                "Failed to create the base level sampler for the textures");
     }
 
-    Texture *Graphics::RegisterTexture(std::string &textureId) {
-        Map<std::string, Texture *, std::hash<std::string>>::iterator iter = mTextureMap.find(textureId);
-        Texture *texture = nullptr;
-        if (iter == mTextureMap.end()) {
-            texture = new Texture(textureId.c_str(), &mRendererContext);
-            mTextureMap.insert({textureId, texture});
+    void Graphics::SetTextureSamplers(VkSampler sampler) {
+        for (Texture *texture: mTextures) {
+            texture->SetSampler(sampler);
+        }
+    }
 
-        } else {
+    TextureHandle Graphics::RegisterTexture(std::string &textureId) {
+        Map<std::string, TextureHandle, std::hash<std::string>>::iterator iter = mTextureIds.find(textureId);
+        if (iter != mTextureIds.end()) {
             LOG_WARN("Texture {} already Existing", textureId.c_str());
-            texture = iter->second;
+            return iter->second;
         }
-        return texture;
+        TextureHandle handle = mTextures.Insert(new Texture(textureId.c_str(), &mRendererContext));
+        mTextureIds.insert({textureId, handle});
+        // Meshes registered before their texture fell back to the default one.
+        for (StaticMesh *mesh: mMeshes) {
+            if (mesh->GetTextureHandle() == mDefaultTexture && mesh->GetTextureId() == textureId) {
+                mesh->SetTextureHandle(handle);
+            }
+        }
+        return handle;
     }
 
     void Graphics::CreateDefaultTexture(const std::string &defaultTexturePath) {
-        Texture *defaultTexture = new Texture(defaultTexturePath.c_str(), &mRendererContext);
-        mTextureMap.insert({defaultTexturePath, defaultTexture});
+        mDefaultTexture = mTextures.Insert(new Texture(defaultTexturePath.c_str(), &mRendererContext));
+        mTextureIds.insert({defaultTexturePath, mDefaultTexture});
 
         // Testing the default lights;
 //        OmniDirectionalInfo testInfo = {{0, -0.5, -1, 0}, {1, 1, 1, 0}, {.5, 0.5, 0, 0}};
@@ -1756,8 +2348,31 @@ namespace rn {
         mDirectionalLight = directionalLight;
     }
 
-    Map<std::string, StaticMesh *, std::hash<std::string>> *Graphics::GetSceneObjectMap() {
-        return &meshObjectList;
+    MeshRegistry *Graphics::GetSceneMeshes() {
+        return &mMeshes;
+    }
+
+    MeshHandle Graphics::RegisterMeshObject(StaticMesh *meshObject) {
+        // The texture path is resolved once here instead of hashing it for every draw.
+        Map<std::string, TextureHandle, std::hash<std::string>>::iterator textureIter =
+                mTextureIds.find(meshObject->GetTextureId());
+        meshObject->SetTextureHandle(textureIter != mTextureIds.end() ? textureIter->second : mDefaultTexture);
+        MeshHandle handle = mMeshes.Insert(meshObject);
+        mMeshPickIds[meshObject->GetPickId()] = handle;
+        return handle;
+    }
+
+    void Graphics::UnregisterMeshObject(MeshHandle handle) {
+        StaticMesh **mesh = mMeshes.Get(handle);
+        if (mesh == nullptr) {
+            return;
+        }
+        Map<std::uint32_t, MeshHandle, std::hash<std::uint32_t>>::iterator pickIter =
+                mMeshPickIds.find((*mesh)->GetPickId());
+        if (pickIter != mMeshPickIds.end() && pickIter->second == handle) {
+            mMeshPickIds.erase(pickIter);
+        }
+        mMeshes.Remove(handle);
     }
 
     void Graphics::CreateOffScreenBindings() {
@@ -1825,11 +2440,23 @@ namespace rn {
     }
 
     void Graphics::CreateMousePickingBuffers() {
+        mMousePickQueries.resize(MAX_FRAMES_IN_FLIGHT);
+        for (MousePickQuery &query: mMousePickQueries) {
+            Utility::CreateBuffer(mRendererContext, query.buffer, VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                  query.memory,
+                                  (VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT),
+                                  sizeof(uint32_t), "Mouse Picking Buffer");
+            // Host visible allocations stay mapped, reading it back is then just a load.
+            query.mappedId = static_cast<std::uint32_t *>(query.memory.mappedData);
+        }
+    }
 
-        Utility::CreateBuffer(mRendererContext, mMousePickingBuffer, VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-                              mMousePickingBufferMemory,
-                              (VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT),
-                              sizeof(uint32_t), "Mouse Picking Buffer");
+    void Graphics::DestroyMousePickingBuffers() {
+        for (MousePickQuery &query: mMousePickQueries) {
+            Utility::DestroyBuffer(mRendererContext, query.buffer, query.memory);
+        }
+        mMousePickQueries.clear();
+        mPendingMousePickCount = 0;
     }
 
     void Graphics::CopyMouseImageToBuffer() {
@@ -1843,9 +2470,15 @@ namespace rn {
             region.imageOffset = {static_cast<int32_t>(mMouseXPos), static_cast<int32_t>(mMouseYPos), 0};
             region.imageExtent = {1, 1, 1};
 
+            MousePickQuery &query = mMousePickQueries[mCurrentFrame];
             vkCmdCopyImageToBuffer(mCommandBuffer, mMousePickingImages[mCurrentImageIndex],
-                                   VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, mMousePickingBuffer, 1, &region);
+                                   VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, query.buffer, 1, &region);
             mRendererContext.beginGizmoDrag = true;
+            // The slot was resolved in BeginFrame after this frame's fence, so it is always free here.
+            if (!query.pending) {
+                query.pending = true;
+                mPendingMousePickCount++;
+            }
         }
         isViewPortClicked = false;
     }
@@ -1854,19 +2487,28 @@ namespace rn {
         return mActiveClickObject;
     }
 
-    void Graphics::SetActiveClickObject() {
-        uint32_t *data;
-        vkWaitForFences(mDevices.logicalDevice, 1, &mPresentFinishFence, VK_TRUE, UINT64_MAX);
-        vkMapMemory(mDevices.logicalDevice, mMousePickingBufferMemory, 0, sizeof(uint32_t), 0, (void **) &data);
+    void Graphics::ResolveMousePickQueries() {
+        // Called right after waiting on the current frame's fence, so the copy recorded into this slot has landed.
+        if (mPendingMousePickCount == 0) {
+            return;
+        }
+        MousePickQuery &query = mMousePickQueries[mCurrentFrame];
+        if (!query.pending) {
+            return;
+        }
+        query.pending = false;
+        mPendingMousePickCount--;
+        SetActiveClickObject(*query.mappedId);
+    }
+
+    void Graphics::SetActiveClickObject(std::uint32_t pickId) {
         activeGizmoAxis = AXIS::NONE;
-        if (*data > 1000) {
-            uint32_t id = *data % 1000;
+        if (pickId > 1000) {
+            uint32_t id = pickId % 1000;
             activeGizmoAxis = static_cast<AXIS>(id);
-            vkUnmapMemory(mDevices.logicalDevice, mMousePickingBufferMemory);
             return;
         }
-        mActiveClickObject = *data;
-        vkUnmapMemory(mDevices.logicalDevice, mMousePickingBufferMemory);
+        mActiveClickObject = pickId;
     }
 
 
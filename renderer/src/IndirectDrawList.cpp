@@ -0,0 +1,193 @@
+//
+// Created by ghima on 22-10-2025.
+//
+#include "IndirectDrawList.h"
+#include "StaticMesh.h"
+
+namespace rn {
+    IndirectDrawList::IndirectDrawList(RendererContext *ctx, VkDescriptorSetLayout objectDataLayout,
+                                       std::uint32_t capacity, bool multiDrawSupported,
+                                       PFN_vkCmdDrawIndexedIndirectCountKHR cmdDrawIndexedIndirectCount)
+            : mCtx{ctx}, mObjectDataLayout{objectDataLayout}, mCapacity{capacity},
+              mMultiDrawSupported{multiDrawSupported}, mCmdDrawIndexedIndirectCount{cmdDrawIndexedIndirectCount},
+              mDeferredRelease{ctx} {
+        CreateBuffers();
+        CreateDescriptorSets();
+    }
+
+    IndirectDrawList::~IndirectDrawList() {
+        vkDestroyDescriptorPool(mCtx->logicalDevice, mDescriptorPool, nullptr);
+        Utility::DestroyBuffer(*mCtx, mObjectBuffer, mObjectBufferMemory);
+        Utility::DestroyBuffer(*mCtx, mCommandBuffer, mCommandBufferMemory);
+        Utility::DestroyBuffer(*mCtx, mCountBuffer, mCountBufferMemory);
+    }
+
+    void IndirectDrawList::CreateBuffers() {
+        VkPhysicalDeviceProperties properties{};
+        vkGetPhysicalDeviceProperties(mCtx->physicalDevice, &properties);
+        VkDeviceSize alignment = properties.limits.minStorageBufferOffsetAlignment;
+        // The descriptor of every frame starts at its region, so the regions have to respect the storage alignment.
+        mObjectRegionSize = (sizeof(ObjectData) * mCapacity + alignment - 1) & ~(alignment - 1);
+
+        VkMemoryPropertyFlags hostFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+        Utility::CreateBuffer(*mCtx, mObjectBuffer, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, mObjectBufferMemory, hostFlags,
+                              mObjectRegionSize * MAX_FRAMES_IN_FLIGHT, "Indirect Object Data Buffer");
+        Utility::CreateBuffer(*mCtx, mCommandBuffer, VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT, mCommandBufferMemory,
+                              hostFlags, sizeof(VkDrawIndexedIndirectCommand) * mCapacity * MAX_FRAMES_IN_FLIGHT,
+                              "Indirect Command Buffer");
+        // One count per batch, there can never be more batches than draws.
+        Utility::CreateBuffer(*mCtx, mCountBuffer, VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT, mCountBufferMemory, hostFlags,
+                              sizeof(std::uint32_t) * mCapacity * MAX_FRAMES_IN_FLIGHT, "Indirect Count Buffer");
+
+        mObjects = static_cast<ObjectData *>(mObjectBufferMemory.mappedData);
+        mCommands = static_cast<VkDrawIndexedIndirectCommand *>(mCommandBufferMemory.mappedData);
+        mCounts = static_cast<std::uint32_t *>(mCountBufferMemory.mappedData);
+    }
+
+    void IndirectDrawList::CreateDescriptorSets() {
+        VkDescriptorPoolSize poolSize{};
+        poolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        poolSize.descriptorCount = MAX_FRAMES_IN_FLIGHT;
+
+        VkDescriptorPoolCreateInfo poolCreateInfo{};
+        poolCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        poolCreateInfo.maxSets = MAX_FRAMES_IN_FLIGHT;
+        poolCreateInfo.poolSizeCount = 1;
+        poolCreateInfo.pPoolSizes = &poolSize;
+        Utility::CheckVulkanError(vkCreateDescriptorPool(mCtx->logicalDevice, &poolCreateInfo, nullptr,
+                                                         &mDescriptorPool),
+                                  "Failed to create the descriptor pool for the indirect object data");
+
+        List<VkDescriptorSetLayout> layouts(MAX_FRAMES_IN_FLIGHT, mObjectDataLayout);
+        mDescriptorSets.resize(MAX_FRAMES_IN_FLIGHT);
+        VkDescriptorSetAllocateInfo allocateInfo{};
+        allocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        allocateInfo.descriptorPool = mDescriptorPool;
+        allocateInfo.descriptorSetCount = layouts.size();
+        allocateInfo.pSetLayouts = layouts.data();
+        Utility::CheckVulkanError(vkAllocateDescriptorSets(mCtx->logicalDevice, &allocateInfo, mDescriptorSets.data()),
+                                  "Failed to allocate the descriptor sets for the indirect object data");
+
+        List<VkDescriptorBufferInfo> bufferInfos(MAX_FRAMES_IN_FLIGHT);
+        List<VkWriteDescriptorSet> writeInfos(MAX_FRAMES_IN_FLIGHT);
+        for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+            bufferInfos[i].buffer = mObjectBuffer;
+            bufferInfos[i].offset = mObjectRegionSize * i;
+            bufferInfos[i].range = sizeof(ObjectData) * mCapacity;
+
+            writeInfos[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            writeInfos[i].descriptorCount = 1;
+            writeInfos[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            writeInfos[i].dstBinding = 0;
+            writeInfos[i].dstArrayElement = 0;
+            writeInfos[i].dstSet = mDescriptorSets[i];
+            writeInfos[i].pBufferInfo = &bufferInfos[i];
+        }
+        vkUpdateDescriptorSets(mCtx->logicalDevice, writeInfos.size(), writeInfos.data(), 0, nullptr);
+    }
+
+    void IndirectDrawList::Grow(std::uint32_t objectCount) {
+        while (mCapacity < objectCount) {
+            mCapacity *= 2;
+        }
+        // Nothing of this frame is written yet, the frames in flight keep reading the old buffers until they end.
+        mDeferredRelease.Retire(mObjectBuffer, mObjectBufferMemory, mDescriptorPool);
+        mDeferredRelease.Retire(mCommandBuffer, mCommandBufferMemory, VK_NULL_HANDLE);
+        mDeferredRelease.Retire(mCountBuffer, mCountBufferMemory, VK_NULL_HANDLE);
+        CreateBuffers();
+        CreateDescriptorSets();
+        LOG_INFO("Indirect draw list grown to {} objects per frame", mCapacity);
+    }
+
+    void IndirectDrawList::Begin(size_t currentFrameIndex, std::uint32_t objectCount) {
+        mDeferredRelease.BeginFrame();
+        if (objectCount > mCapacity) {
+            Grow(objectCount);
+        }
+        mFrameIndex = currentFrameIndex;
+        mObjectCount = 0;
+        mDrawCount = 0;
+        mBatches.clear();
+    }
+
+    void IndirectDrawList::Add(const StaticMesh *mesh, std::uint32_t lod, VkDescriptorSet textureDescriptorSet,
+                               std::uint32_t textureIndex) {
+        if (mObjectCount == mCapacity) {
+            LOG_ERROR("Indirect draw list overflow, more objects were added than passed to Begin");
+            std::exit(EXIT_FAILURE);
+        }
+        std::uint32_t objectIndex = mObjectCount++;
+        size_t frameBegin = static_cast<size_t>(mCapacity) * mFrameIndex;
+
+        ObjectData &object = *reinterpret_cast<ObjectData *>(reinterpret_cast<std::uint8_t *>(mObjects) +
+                                                             mObjectRegionSize * mFrameIndex +
+                                                             sizeof(ObjectData) * objectIndex);
+        object.model = mesh->GetModelMatrix();
+        object.pickId = mesh->GetPickId();
+        object.textureIndex = textureIndex;
+
+        bool sameBatch = !mBatches.empty() && mBatches.back().textureDescriptorSet == textureDescriptorSet &&
+                         mBatches.back().indexType == mesh->GetIndexType();
+        // The previous object used the same geometry, its command only needs one more instance. The commands are
+        // only written, reading back the mapped memory can be slow.
+        if (sameBatch && mesh->GetFirstIndex(lod) == mLastCommand.firstIndex &&
+            mesh->GetVertexOffset() == mLastCommand.vertexOffset &&
+            mesh->GetStaticMeshIndicesCount(lod) == mLastCommand.indexCount) {
+            mCommands[frameBegin + mDrawCount - 1].instanceCount = ++mLastCommand.instanceCount;
+            return;
+        }
+        std::uint32_t drawIndex = mDrawCount++;
+        mLastCommand.indexCount = mesh->GetStaticMeshIndicesCount(lod);
+        mLastCommand.instanceCount = 1;
+        mLastCommand.firstIndex = mesh->GetFirstIndex(lod);
+        mLastCommand.vertexOffset = mesh->GetVertexOffset();
+        // Selects the object data element in the vertex shader.
+        mLastCommand.firstInstance = objectIndex;
+        mCommands[frameBegin + drawIndex] = mLastCommand;
+
+        if (!sameBatch) {
+            mBatches.push_back({textureDescriptorSet, mesh->GetIndexType(), drawIndex, 0});
+        }
+        mBatches.back().commandCount++;
+        mCounts[frameBegin + mBatches.size() - 1] = mBatches.back().commandCount;
+    }
+
+    void IndirectDrawList::Record(VkCommandBuffer commandBuffer, VkPipelineLayout layout, std::uint32_t textureSet,
+                                  std::uint32_t objectDataSet, DrawStatistics &statistics) const {
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, layout, objectDataSet, 1,
+                                &mDescriptorSets[mFrameIndex], 0, nullptr);
+        statistics.descriptorSetBinds += 1 + static_cast<std::uint32_t>(mBatches.size());
+
+        const std::uint32_t stride = sizeof(VkDrawIndexedIndirectCommand);
+        VkDeviceSize commandBegin = static_cast<VkDeviceSize>(stride) * mCapacity * mFrameIndex;
+        VkDeviceSize countBegin = sizeof(std::uint32_t) * static_cast<VkDeviceSize>(mCapacity) * mFrameIndex;
+        VkIndexType boundIndexType = VK_INDEX_TYPE_MAX_ENUM;
+        for (size_t i = 0; i < mBatches.size(); i++) {
+            const Batch &batch = mBatches[i];
+            if (batch.indexType != boundIndexType) {
+                mCtx->geometryArena->BindIndexBuffer(commandBuffer, batch.indexType);
+                boundIndexType = batch.indexType;
+                statistics.indexBufferBinds++;
+            }
+            vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, layout, textureSet, 1,
+                                    &batch.textureDescriptorSet, 0, nullptr);
+            VkDeviceSize commandOffset = commandBegin + static_cast<VkDeviceSize>(stride) * batch.firstCommand;
+            if (mCmdDrawIndexedIndirectCount != nullptr) {
+                // The count lives in a buffer, so a later GPU culling pass can shrink the batch without a re-record.
+                mCmdDrawIndexedIndirectCount(commandBuffer, mCommandBuffer, commandOffset, mCountBuffer,
+                                             countBegin + sizeof(std::uint32_t) * i, batch.commandCount, stride);
+                statistics.drawCalls++;
+            } else if (mMultiDrawSupported) {
+                vkCmdDrawIndexedIndirect(commandBuffer, mCommandBuffer, commandOffset, batch.commandCount, stride);
+                statistics.drawCalls++;
+            } else {
+                statistics.drawCalls += batch.commandCount;
+                // Without multiDrawIndirect every indirect draw can only carry one command.
+                for (std::uint32_t command = 0; command < batch.commandCount; command++) {
+                    vkCmdDrawIndexedIndirect(commandBuffer, mCommandBuffer, commandOffset + stride * command, 1,
+                                             stride);
+                }
+            }
+        }
+    }
+}
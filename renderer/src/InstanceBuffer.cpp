@@ -0,0 +1,155 @@
+//
+// Created by ghima on 22-10-2025.
+//
+#include "InstanceBuffer.h"
+#include "StaticMesh.h"
+
+namespace rn {
+    InstanceBuffer::InstanceBuffer(RendererContext *ctx, VkDescriptorSetLayout objectDataLayout,
+                                   std::uint32_t capacity) : mCtx{ctx}, mLayout{objectDataLayout},
+                                                             mCapacity{capacity}, mDeferredRelease{ctx} {
+        CreateBuffer();
+        CreateDescriptorSets();
+    }
+
+    InstanceBuffer::~InstanceBuffer() {
+        vkDestroyDescriptorPool(mCtx->logicalDevice, mDescriptorPool, nullptr);
+        Utility::DestroyBuffer(*mCtx, mBuffer, mMemory);
+    }
+
+    void InstanceBuffer::CreateBuffer() {
+        VkPhysicalDeviceProperties properties{};
+        vkGetPhysicalDeviceProperties(mCtx->physicalDevice, &properties);
+        VkDeviceSize alignment = properties.limits.minStorageBufferOffsetAlignment;
+        // The descriptor of every frame starts at its region, so the regions have to respect the storage alignment.
+        mRegionSize = (sizeof(ObjectData) * mCapacity + alignment - 1) & ~(alignment - 1);
+
+        Utility::CreateBuffer(*mCtx, mBuffer, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, mMemory,
+                              (VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT),
+                              mRegionSize * MAX_FRAMES_IN_FLIGHT, "Instance Buffer");
+        mMappedData = static_cast<std::uint8_t *>(mMemory.mappedData);
+    }
+
+    void InstanceBuffer::CreateDescriptorSets() {
+        VkDescriptorPoolSize poolSize{};
+        poolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        poolSize.descriptorCount = MAX_FRAMES_IN_FLIGHT;
+
+        VkDescriptorPoolCreateInfo poolCreateInfo{};
+        poolCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        poolCreateInfo.maxSets = MAX_FRAMES_IN_FLIGHT;
+        poolCreateInfo.poolSizeCount = 1;
+        poolCreateInfo.pPoolSizes = &poolSize;
+        Utility::CheckVulkanError(vkCreateDescriptorPool(mCtx->logicalDevice, &poolCreateInfo, nullptr,
+                                                         &mDescriptorPool),
+                                  "Failed to create the descriptor pool for the instance buffer");
+
+        List<VkDescriptorSetLayout> layouts(MAX_FRAMES_IN_FLIGHT, mLayout);
+        mDescriptorSets.resize(MAX_FRAMES_IN_FLIGHT);
+        VkDescriptorSetAllocateInfo allocateInfo{};
+        allocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        allocateInfo.descriptorPool = mDescriptorPool;
+        allocateInfo.descriptorSetCount = layouts.size();
+        allocateInfo.pSetLayouts = layouts.data();
+        Utility::CheckVulkanError(vkAllocateDescriptorSets(mCtx->logicalDevice, &allocateInfo, mDescriptorSets.data()),
+                                  "Failed to allocate the descriptor sets for the instance buffer");
+
+        List<VkDescriptorBufferInfo> bufferInfos(MAX_FRAMES_IN_FLIGHT);
+        List<VkWriteDescriptorSet> writeInfos(MAX_FRAMES_IN_FLIGHT);
+        for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+            bufferInfos[i].buffer = mBuffer;
+            bufferInfos[i].offset = mRegionSize * i;
+            bufferInfos[i].range = sizeof(ObjectData) * mCapacity;
+
+            writeInfos[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            writeInfos[i].descriptorCount = 1;
+            writeInfos[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            writeInfos[i].dstBinding = 0;
+            writeInfos[i].dstArrayElement = 0;
+            writeInfos[i].dstSet = mDescriptorSets[i];
+            writeInfos[i].pBufferInfo = &bufferInfos[i];
+        }
+        vkUpdateDescriptorSets(mCtx->logicalDevice, writeInfos.size(), writeInfos.data(), 0, nullptr);
+    }
+
+    void InstanceBuffer::BeginFrame(size_t currentFrameIndex) {
+        mFrameIndex = currentFrameIndex;
+        mFrameHead.store(0, std::memory_order_relaxed);
+        mDeferredRelease.BeginFrame();
+    }
+
+    void InstanceBuffer::Reserve(std::uint32_t count) {
+        std::uint32_t frameHead = mFrameHead.load(std::memory_order_relaxed);
+        if (frameHead + count <= mCapacity) {
+            return;
+        }
+        // Sized for the whole frame, so the following frames fit without growing again.
+        std::uint32_t required = frameHead + count;
+        while (mCapacity < required) {
+            mCapacity *= 2;
+        }
+        // The instances written so far are only read through the old set, the new buffer starts empty. The frames
+        // in flight and the command buffers already recorded for this one keep the old buffer alive until they end.
+        mDeferredRelease.Retire(mBuffer, mMemory, mDescriptorPool);
+        CreateBuffer();
+        CreateDescriptorSets();
+        mFrameHead.store(0, std::memory_order_relaxed);
+        LOG_INFO("Instance buffer grown to {} instances per frame", mCapacity);
+    }
+
+    std::uint32_t InstanceBuffer::Allocate(std::uint32_t count, ObjectData *&instances) {
+        std::uint32_t first = mFrameHead.fetch_add(count, std::memory_order_relaxed);
+        if (first + count > mCapacity) {
+            LOG_ERROR("Instance buffer overflow, {} instances were allocated without a Reserve", first + count);
+            std::exit(EXIT_FAILURE);
+        }
+        instances = reinterpret_cast<ObjectData *>(mMappedData + mRegionSize * mFrameIndex) + first;
+        return first;
+    }
+
+    void InstanceBuffer::BuildRuns(List<const StaticMesh *> &meshes, List<InstanceRun> &runs,
+                                   std::uint32_t lodBias) {
+        runs.clear();
+        if (meshes.empty()) {
+            return;
+        }
+        std::sort(meshes.begin(), meshes.end(), [lodBias](const StaticMesh *a, const StaticMesh *b) -> bool {
+            if (a->GetIndexType() != b->GetIndexType()) {
+                return a->GetIndexType() < b->GetIndexType();
+            }
+            return a->GetFirstIndex(a->GetLod(lodBias)) < b->GetFirstIndex(b->GetLod(lodBias));
+        });
+        ObjectData *instances = nullptr;
+        std::uint32_t firstInstance = Allocate(static_cast<std::uint32_t>(meshes.size()), instances);
+        for (size_t i = 0; i < meshes.size(); i++) {
+            const StaticMesh *mesh = meshes[i];
+            instances[i].model = mesh->GetModelMatrix();
+            instances[i].pickId = mesh->GetPickId();
+            instances[i].textureIndex = 0;
+            std::uint32_t lod = mesh->GetLod(lodBias);
+            if (runs.empty() || !SameGeometry(runs.back().mesh, runs.back().lod, mesh, lod)) {
+                runs.push_back({mesh, lod, firstInstance + static_cast<std::uint32_t>(i), 0});
+            }
+            runs.back().instanceCount++;
+        }
+    }
+
+    void InstanceBuffer::DrawRuns(VkCommandBuffer commandBuffer, const List<InstanceRun> &runs) {
+        VkIndexType boundIndexType = VK_INDEX_TYPE_MAX_ENUM;
+        for (const InstanceRun &run: runs) {
+            if (run.mesh->GetIndexType() != boundIndexType) {
+                vkCmdBindIndexBuffer(commandBuffer, run.mesh->GetIndexBuffer(), 0, run.mesh->GetIndexType());
+                boundIndexType = run.mesh->GetIndexType();
+            }
+            vkCmdDrawIndexed(commandBuffer, run.mesh->GetStaticMeshIndicesCount(run.lod), run.instanceCount,
+                             run.mesh->GetFirstIndex(run.lod), run.mesh->GetVertexOffset(), run.firstInstance);
+        }
+    }
+
+    bool InstanceBuffer::SameGeometry(const StaticMesh *a, std::uint32_t lodA, const StaticMesh *b,
+                                      std::uint32_t lodB) {
+        return a->GetIndexType() == b->GetIndexType() && a->GetFirstIndex(lodA) == b->GetFirstIndex(lodB) &&
+               a->GetVertexOffset() == b->GetVertexOffset() &&
+               a->GetStaticMeshIndicesCount(lodA) == b->GetStaticMeshIndicesCount(lodB);
+    }
+}
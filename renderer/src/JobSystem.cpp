@@ -0,0 +1,107 @@
+//
+// Created by ghima on 20-10-2025.
+//
+#include "JobSystem.h"
+
+namespace rn {
+    JobSystem::JobSystem(std::uint32_t workerCount) {
+        if (workerCount == 0) {
+            std::uint32_t hardwareThreads = std::thread::hardware_concurrency();
+            workerCount = hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+        }
+        for (std::uint32_t i = 0; i < workerCount + 1; i++) {
+            mQueues.push_back(std::make_unique<WorkerQueue>());
+        }
+        for (std::uint32_t i = 0; i < workerCount; i++) {
+            mWorkers.emplace_back(&JobSystem::WorkerLoop, this, i);
+        }
+        LOG_INFO("Job system started with {} workers", workerCount);
+    }
+
+    JobSystem::~JobSystem() {
+        {
+            std::lock_guard<std::mutex> lockGuard{mMutex};
+            mStop = true;
+        }
+        mCondition.notify_all();
+        for (std::thread &worker: mWorkers) {
+            worker.join();
+        }
+    }
+
+    void JobSystem::Submit(Job &&job) {
+        // Round robin over the workers, stealing evens out whatever imbalance is left.
+        std::uint32_t queueIndex = mNextQueue.fetch_add(1, std::memory_order_relaxed) % mWorkers.size();
+        mPendingJobs.fetch_add(1);
+        {
+            std::lock_guard<std::mutex> lockGuard{mQueues[queueIndex]->mutex};
+            mQueues[queueIndex]->jobs.push_back(std::move(job));
+        }
+        mQueuedJobs.fetch_add(1);
+        {
+            std::lock_guard<std::mutex> lockGuard{mMutex};
+        }
+        mCondition.notify_all();
+    }
+
+    bool JobSystem::TryRunJob(std::uint32_t slot) {
+        Job job{};
+        bool found = false;
+        {
+            WorkerQueue &ownQueue = *mQueues[slot];
+            std::lock_guard<std::mutex> lockGuard{ownQueue.mutex};
+            if (!ownQueue.jobs.empty()) {
+                job = std::move(ownQueue.jobs.back());
+                ownQueue.jobs.pop_back();
+                found = true;
+            }
+        }
+        for (size_t i = 1; i < mQueues.size() && !found; i++) {
+            WorkerQueue &victim = *mQueues[(slot + i) % mQueues.size()];
+            std::lock_guard<std::mutex> lockGuard{victim.mutex};
+            if (!victim.jobs.empty()) {
+                job = std::move(victim.jobs.front());
+                victim.jobs.pop_front();
+                found = true;
+            }
+        }
+        if (!found) {
+            return false;
+        }
+        mQueuedJobs.fetch_sub(1);
+        job(slot);
+        if (mPendingJobs.fetch_sub(1) == 1) {
+            {
+                std::lock_guard<std::mutex> lockGuard{mMutex};
+            }
+            mCondition.notify_all();
+        }
+        return true;
+    }
+
+    void JobSystem::WorkerLoop(std::uint32_t slot) {
+        while (true) {
+            if (TryRunJob(slot)) {
+                continue;
+            }
+            std::unique_lock<std::mutex> lock{mMutex};
+            mCondition.wait(lock, [this]() -> bool { return mStop || mQueuedJobs.load() > 0; });
+            if (mStop) {
+                return;
+            }
+        }
+    }
+
+    void JobSystem::Wait() {
+        std::uint32_t callerSlot = mQueues.size() - 1;
+        while (mPendingJobs.load() > 0) {
+            if (TryRunJob(callerSlot)) {
+                continue;
+            }
+            std::unique_lock<std::mutex> lock{mMutex};
+            mCondition.wait(lock, [this]() -> bool {
+                return mPendingJobs.load() == 0 || mQueuedJobs.load() > 0;
+            });
+        }
+    }
+}
@@ -0,0 +1,358 @@
+//
+// Created by ghima on 22-10-2025.
+//
+#include "MemoryAllocator.h"
+
+namespace rn {
+    // Power of two classes from MIN_SIZE_CLASS up to and including MAX_SIZE_CLASS.
+    static constexpr std::uint32_t CountSizeClasses() {
+        std::uint32_t count = 1;
+        for (VkDeviceSize slotSize = MIN_SIZE_CLASS; slotSize < MAX_SIZE_CLASS; slotSize *= 2) {
+            count++;
+        }
+        return count;
+    }
+
+    static const std::uint32_t SIZE_CLASS_COUNT = CountSizeClasses();
+    // Pools per memory type and resource kind, the size classes first and the free list pool last.
+    static const std::uint32_t POOLS_PER_KIND = SIZE_CLASS_COUNT + 1;
+
+    struct MemoryBlock {
+        struct FreeRange {
+            VkDeviceSize offset;
+            VkDeviceSize size;
+        };
+        VkDeviceMemory memory{};
+        VkDeviceSize size = 0;
+        std::uint8_t *mappedData = nullptr;
+        std::uint32_t memoryTypeIndex = 0;
+        std::uint32_t poolIndex = 0;
+        // Size class blocks hand out equal slots, the other blocks keep a free list sorted by offset.
+        VkDeviceSize slotSize = 0;
+        List<std::uint32_t> freeSlots{};
+        List<FreeRange> freeRanges{};
+        std::uint32_t allocationCount = 0;
+    };
+
+    MemoryAllocator::MemoryAllocator(VkPhysicalDevice physicalDevice, VkDevice logicalDevice)
+            : mLogicalDevice{logicalDevice}, mPhysicalDevice{physicalDevice} {
+        vkGetPhysicalDeviceMemoryProperties(mPhysicalDevice, &mMemoryProperties);
+        mPools.resize(mMemoryProperties.memoryTypeCount * 2 * POOLS_PER_KIND);
+        mHeapStatistics.resize(mMemoryProperties.memoryHeapCount);
+        for (std::uint32_t i = 0; i < mMemoryProperties.memoryHeapCount; i++) {
+            mHeapStatistics[i].heapSize = mMemoryProperties.memoryHeaps[i].size;
+        }
+    }
+
+    MemoryAllocator::~MemoryAllocator() {
+        // Dedicated allocations still alive at this point belong to leaked resources and go with the device.
+        for (List<MemoryBlock *> &pool: mPools) {
+            for (MemoryBlock *block: pool) {
+                vkFreeMemory(mLogicalDevice, block->memory, nullptr);
+                delete block;
+            }
+        }
+    }
+
+    MemoryAllocation MemoryAllocator::AllocateBuffer(VkBuffer buffer, VkMemoryPropertyFlags memoryFlags,
+                                                     const std::string &name) {
+        VkMemoryRequirements requirements{};
+        vkGetBufferMemoryRequirements(mLogicalDevice, buffer, &requirements);
+        MemoryAllocation allocation = Allocate(requirements, memoryFlags, false, name);
+        Utility::CheckVulkanError(vkBindBufferMemory(mLogicalDevice, buffer, allocation.memory, allocation.offset),
+                                  "Failed to bind the memory for the buffer");
+        return allocation;
+    }
+
+    MemoryAllocation MemoryAllocator::AllocateImage(VkImage image, VkImageTiling tiling,
+                                                    VkMemoryPropertyFlags memoryFlags, const std::string &name) {
+        VkMemoryRequirements requirements{};
+        vkGetImageMemoryRequirements(mLogicalDevice, image, &requirements);
+        MemoryAllocation allocation = Allocate(requirements, memoryFlags, tiling == VK_IMAGE_TILING_OPTIMAL, name);
+        Utility::CheckVulkanError(vkBindImageMemory(mLogicalDevice, image, allocation.memory, allocation.offset),
+                                  "Failed to bind the memory for the image");
+        return allocation;
+    }
+
+    MemoryAllocation MemoryAllocator::Allocate(const VkMemoryRequirements &requirements,
+                                               VkMemoryPropertyFlags memoryFlags, bool optimalTiling,
+                                               const std::string &name) {
+        std::uint32_t memoryTypeIndex = Utility::FindMemoryIndices(mPhysicalDevice, requirements.memoryTypeBits,
+                                                                   memoryFlags, name);
+        std::lock_guard<std::mutex> guard{mMutex};
+        if (requirements.size >= DEDICATED_ALLOCATION_SIZE) {
+            return AllocateDedicated(memoryTypeIndex, requirements.size, name);
+        }
+        std::uint32_t kindPoolIndex = (memoryTypeIndex * 2 + (optimalTiling ? 1 : 0)) * POOLS_PER_KIND;
+        MemoryAllocation allocation{};
+        allocation.memoryTypeIndex = memoryTypeIndex;
+
+        // Slots are aligned to their own size, so the class has to cover the alignment as well.
+        VkDeviceSize slotSize = MIN_SIZE_CLASS;
+        std::uint32_t sizeClass = 0;
+        while (slotSize < requirements.size || slotSize < requirements.alignment) {
+            slotSize *= 2;
+            sizeClass++;
+        }
+        bool allocated = false;
+        if (sizeClass < SIZE_CLASS_COUNT) {
+            allocated = AllocateFromSizeClass(kindPoolIndex + sizeClass, slotSize, allocation);
+        } else {
+            allocated = AllocateFromFreeList(kindPoolIndex + SIZE_CLASS_COUNT, requirements.size,
+                                             requirements.alignment, allocation);
+        }
+        if (!allocated) {
+            // The heap can be too fragmented or too small for another block, a dedicated allocation may still fit.
+            return AllocateDedicated(memoryTypeIndex, requirements.size, name);
+        }
+        allocation.size = requirements.size;
+        if (allocation.block->mappedData != nullptr) {
+            allocation.mappedData = allocation.block->mappedData + allocation.offset;
+        }
+        allocation.block->allocationCount++;
+        Track(memoryTypeIndex, allocation.reservedSize, true);
+        return allocation;
+    }
+
+    bool MemoryAllocator::AllocateDeviceMemory(std::uint32_t memoryTypeIndex, VkDeviceSize size,
+                                               VkDeviceMemory &memory, std::uint8_t *&mappedData) {
+        VkMemoryAllocateInfo allocateInfo{};
+        allocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+        allocateInfo.allocationSize = size;
+        allocateInfo.memoryTypeIndex = memoryTypeIndex;
+        if (vkAllocateMemory(mLogicalDevice, &allocateInfo, nullptr, &memory) != VK_SUCCESS) {
+            return false;
+        }
+        mappedData = nullptr;
+        if (mMemoryProperties.memoryTypes[memoryTypeIndex].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) {
+            Utility::CheckVulkanError(
+                    vkMapMemory(mLogicalDevice, memory, 0, VK_WHOLE_SIZE, 0, (void **) &mappedData),
+                    "Failed to map the device memory block");
+        }
+        MemoryHeapStatistics &statistics = mHeapStatistics[mMemoryProperties.memoryTypes[memoryTypeIndex].heapIndex];
+        statistics.reservedBytes += size;
+        statistics.deviceAllocationCount++;
+        return true;
+    }
+
+    void MemoryAllocator::FreeDeviceMemory(std::uint32_t memoryTypeIndex, VkDeviceSize size, VkDeviceMemory memory) {
+        // Freeing implicitly unmaps the memory.
+        vkFreeMemory(mLogicalDevice, memory, nullptr);
+        MemoryHeapStatistics &statistics = mHeapStatistics[mMemoryProperties.memoryTypes[memoryTypeIndex].heapIndex];
+        statistics.reservedBytes -= size;
+        statistics.deviceAllocationCount--;
+    }
+
+    MemoryAllocation MemoryAllocator::AllocateDedicated(std::uint32_t memoryTypeIndex, VkDeviceSize size,
+                                                        const std::string &name) {
+        MemoryAllocation allocation{};
+        std::uint8_t *mappedData = nullptr;
+        if (!AllocateDeviceMemory(memoryTypeIndex, size, allocation.memory, mappedData)) {
+            LOG_ERROR("Failed to allocate {} bytes of device memory for {}", size, name);
+            std::exit(EXIT_FAILURE);
+        }
+        allocation.size = size;
+        allocation.reservedSize = size;
+        allocation.memoryTypeIndex = memoryTypeIndex;
+        allocation.mappedData = mappedData;
+        Track(memoryTypeIndex, size, true);
+        return allocation;
+    }
+
+    MemoryBlock *MemoryAllocator::CreateBlock(std::uint32_t poolIndex, std::uint32_t memoryTypeIndex,
+                                              VkDeviceSize size, VkDeviceSize slotSize) {
+        MemoryBlock *block = new MemoryBlock{};
+        if (!AllocateDeviceMemory(memoryTypeIndex, size, block->memory, block->mappedData)) {
+            delete block;
+            return nullptr;
+        }
+        block->size = size;
+        block->memoryTypeIndex = memoryTypeIndex;
+        block->poolIndex = poolIndex;
+        block->slotSize = slotSize;
+        if (slotSize != 0) {
+            // Filled backwards so the slots are handed out from the start of the block.
+            std::uint32_t slotCount = static_cast<std::uint32_t>(size / slotSize);
+            block->freeSlots.reserve(slotCount);
+            for (std::uint32_t slot = slotCount; slot > 0; slot--) {
+                block->freeSlots.push_back(slot - 1);
+            }
+        } else {
+            block->freeRanges.push_back({0, size});
+        }
+        mPools[poolIndex].push_back(block);
+        return block;
+    }
+
+    bool MemoryAllocator::AllocateFromSizeClass(std::uint32_t poolIndex, VkDeviceSize slotSize,
+                                                MemoryAllocation &allocation) {
+        MemoryBlock *block = nullptr;
+        for (MemoryBlock *candidate: mPools[poolIndex]) {
+            if (!candidate->freeSlots.empty()) {
+                block = candidate;
+                break;
+            }
+        }
+        if (block == nullptr) {
+            block = CreateBlock(poolIndex, allocation.memoryTypeIndex, SIZE_CLASS_BLOCK_SIZE, slotSize);
+            if (block == nullptr) {
+                return false;
+            }
+        }
+        std::uint32_t slot = block->freeSlots.back();
+        block->freeSlots.pop_back();
+        allocation.memory = block->memory;
+        allocation.block = block;
+        allocation.offset = slot * slotSize;
+        allocation.reservedOffset = allocation.offset;
+        allocation.reservedSize = slotSize;
+        return true;
+    }
+
+    bool MemoryAllocator::AllocateFromFreeList(std::uint32_t poolIndex, VkDeviceSize size, VkDeviceSize alignment,
+                                               MemoryAllocation &allocation) {
+        for (size_t attempt = 0; attempt < 2; attempt++) {
+            for (MemoryBlock *block: mPools[poolIndex]) {
+                for (size_t i = 0; i < block->freeRanges.size(); i++) {
+                    MemoryBlock::FreeRange &range = block->freeRanges[i];
+                    VkDeviceSize alignedOffset = (range.offset + alignment - 1) / alignment * alignment;
+                    if (alignedOffset + size > range.offset + range.size) {
+                        continue;
+                    }
+                    // The alignment padding stays with the allocation and is returned together with it.
+                    allocation.memory = block->memory;
+                    allocation.block = block;
+                    allocation.offset = alignedOffset;
+                    allocation.reservedOffset = range.offset;
+                    allocation.reservedSize = alignedOffset + size - range.offset;
+                    range.offset += allocation.reservedSize;
+                    range.size -= allocation.reservedSize;
+                    if (range.size == 0) {
+                        block->freeRanges.erase(block->freeRanges.begin() + i);
+                    }
+                    return true;
+                }
+            }
+            if (attempt == 0 && CreateBlock(poolIndex, allocation.memoryTypeIndex, MEMORY_BLOCK_SIZE, 0) == nullptr) {
+                return false;
+            }
+        }
+        return false;
+    }
+
+    void MemoryAllocator::Free(MemoryAllocation &allocation) {
+        if (allocation.memory == VK_NULL_HANDLE) {
+            return;
+        }
+        std::lock_guard<std::mutex> guard{mMutex};
+        Track(allocation.memoryTypeIndex, allocation.reservedSize, false);
+        MemoryBlock *block = allocation.block;
+        if (block == nullptr) {
+            FreeDeviceMemory(allocation.memoryTypeIndex, allocation.reservedSize, allocation.memory);
+        } else if (block->slotSize != 0) {
+            block->freeSlots.push_back(static_cast<std::uint32_t>(allocation.offset / block->slotSize));
+            block->allocationCount--;
+            ReleaseBlockIfUnused(block);
+        } else {
+            List<MemoryBlock::FreeRange> &ranges = block->freeRanges;
+            List<MemoryBlock::FreeRange>::iterator next = std::lower_bound(
+                    ranges.begin(), ranges.end(), allocation.reservedOffset,
+                    [](const MemoryBlock::FreeRange &range, VkDeviceSize offset) -> bool {
+                        return range.offset < offset;
+                    });
+            next = ranges.insert(next, {allocation.reservedOffset, allocation.reservedSize});
+            // Merging with the following range first, so the iterator to the released range stays valid.
+            if (next + 1 != ranges.end() && next->offset + next->size == (next + 1)->offset) {
+                next->size += (next + 1)->size;
+                ranges.erase(next + 1);
+            }
+            if (next != ranges.begin() && (next - 1)->offset + (next - 1)->size == next->offset) {
+                (next - 1)->size += next->size;
+                ranges.erase(next);
+            }
+            block->allocationCount--;
+            ReleaseBlockIfUnused(block);
+        }
+        allocation = MemoryAllocation{};
+    }
+
+    LinearPool *MemoryAllocator::CreateLinearPool(VkBufferUsageFlags usage, VkDeviceSize frameSize,
+                                                  VkDeviceSize alignment, const std::string &name) {
+        // Keeping every frame region aligned so the offsets inside it only depend on the head.
+        LinearPool *pool = new LinearPool{name, (frameSize + alignment - 1) & ~(alignment - 1), alignment};
+        VkBufferCreateInfo createBufferInfo{};
+        createBufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+        createBufferInfo.size = pool->mFrameSize * MAX_FRAMES_IN_FLIGHT;
+        createBufferInfo.usage = usage;
+        createBufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        std::string errorMessage = "Failed to create " + name;
+        Utility::CheckVulkanError(vkCreateBuffer(mLogicalDevice, &createBufferInfo, nullptr, &pool->mBuffer),
+                                  errorMessage.c_str());
+        pool->mMemory = AllocateBuffer(pool->mBuffer, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+                                                      VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, name);
+        return pool;
+    }
+
+    void MemoryAllocator::DestroyLinearPool(LinearPool *pool) {
+        vkDestroyBuffer(mLogicalDevice, pool->mBuffer, nullptr);
+        Free(pool->mMemory);
+        delete pool;
+    }
+
+    LinearPool::LinearPool(const std::string &name, VkDeviceSize frameSize, VkDeviceSize alignment)
+            : mName{name}, mFrameSize{frameSize}, mAlignment{alignment} {
+    }
+
+    void LinearPool::BeginFrame(size_t currentFrameIndex) {
+        mFrameBegin = mFrameSize * currentFrameIndex;
+        mFrameHead.store(0, std::memory_order_relaxed);
+    }
+
+    LinearAllocation LinearPool::Allocate(VkDeviceSize size) {
+        VkDeviceSize alignedSize = (size + mAlignment - 1) & ~(mAlignment - 1);
+        VkDeviceSize offset = mFrameHead.fetch_add(alignedSize, std::memory_order_relaxed);
+        if (offset + alignedSize > mFrameSize) {
+            LOG_ERROR("{} overflow, the frame needs more than {} bytes", mName, mFrameSize);
+            std::exit(EXIT_FAILURE);
+        }
+        return {static_cast<std::uint8_t *>(mMemory.mappedData) + mFrameBegin + offset, mFrameBegin + offset};
+    }
+
+    void MemoryAllocator::ReleaseBlockIfUnused(MemoryBlock *block) {
+        List<MemoryBlock *> &pool = mPools[block->poolIndex];
+        // One empty block is kept per pool so a create and destroy loop does not hit vkAllocateMemory every time.
+        if (block->allocationCount != 0 || pool.size() == 1) {
+            return;
+        }
+        pool.erase(std::find(pool.begin(), pool.end(), block));
+        FreeDeviceMemory(block->memoryTypeIndex, block->size, block->memory);
+        delete block;
+    }
+
+    void MemoryAllocator::Track(std::uint32_t memoryTypeIndex, VkDeviceSize size, bool allocated) {
+        MemoryHeapStatistics &statistics = mHeapStatistics[mMemoryProperties.memoryTypes[memoryTypeIndex].heapIndex];
+        if (allocated) {
+            statistics.usedBytes += size;
+            statistics.allocationCount++;
+        } else {
+            statistics.usedBytes -= size;
+            statistics.allocationCount--;
+        }
+    }
+
+    List<MemoryHeapStatistics> MemoryAllocator::GetHeapStatistics() const {
+        std::lock_guard<std::mutex> guard{mMutex};
+        return mHeapStatistics;
+    }
+
+    void MemoryAllocator::LogStatistics() const {
+        List<MemoryHeapStatistics> heapStatistics = GetHeapStatistics();
+        for (size_t i = 0; i < heapStatistics.size(); i++) {
+            const MemoryHeapStatistics &statistics = heapStatistics[i];
+            LOG_INFO("Memory heap {} : {:.2f} MB used of {:.2f} MB reserved ({:.2f} MB heap), {} resources in {} "
+                     "device allocations", i, statistics.usedBytes / (1024.0 * 1024.0),
+                     statistics.reservedBytes / (1024.0 * 1024.0), statistics.heapSize / (1024.0 * 1024.0),
+                     statistics.allocationCount, statistics.deviceAllocationCount);
+        }
+    }
+}
@@ -0,0 +1,236 @@
+//
+// Created by ghima on 22-10-2025.
+//
+#include "MeshOptimizer.h"
+
+namespace rn {
+    VertexCacheStatistics MeshOptimizer::AnalyzeVertexCache(const List<std::uint32_t> &indices,
+                                                            std::uint32_t vertexCount) {
+        VertexCacheStatistics statistics{};
+        if (indices.size() < 3) {
+            return statistics;
+        }
+        // A vertex is still cached while fewer than VERTEX_CACHE_SIZE misses happened since it was loaded.
+        const std::uint64_t notCached = ~0ull;
+        List<std::uint64_t> loadedAt(vertexCount, notCached);
+        std::uint64_t misses = 0;
+        std::uint32_t referenced = 0;
+        for (std::uint32_t index: indices) {
+            if (loadedAt[index] == notCached) {
+                referenced++;
+            } else if (misses - loadedAt[index] < VERTEX_CACHE_SIZE) {
+                continue;
+            }
+            loadedAt[index] = misses++;
+        }
+        statistics.acmr = static_cast<float>(misses) / static_cast<float>(indices.size() / 3);
+        statistics.atvr = static_cast<float>(misses) / static_cast<float>(referenced);
+        return statistics;
+    }
+
+    MeshOptimizationReport MeshOptimizer::Optimize(List<Vertex> &vertices, List<std::uint32_t> &indices) {
+        MeshOptimizationReport report{};
+        std::uint32_t vertexCount = static_cast<std::uint32_t>(vertices.size());
+        report.before = AnalyzeVertexCache(indices, vertexCount);
+        if (indices.size() < 3) {
+            report.after = report.before;
+            return report;
+        }
+
+        List<std::uint32_t> clusters = OrderForVertexCache(indices, vertexCount);
+        float cacheOrderAcmr = AnalyzeVertexCache(indices, vertexCount).acmr;
+        List<std::uint32_t> cacheOrder = indices;
+        OrderForOverdraw(indices, vertices, clusters);
+        // The clusters end where Tipsify had to jump anyway, so the overdraw order rarely costs much, but a mesh
+        // split into many small clusters can lose the reuse across them.
+        if (AnalyzeVertexCache(indices, vertexCount).acmr > cacheOrderAcmr * OVERDRAW_ACMR_THRESHOLD) {
+            indices.swap(cacheOrder);
+        } else {
+            report.overdrawOrdered = true;
+        }
+
+        OrderForVertexFetch(vertices, indices);
+        report.after = AnalyzeVertexCache(indices, static_cast<std::uint32_t>(vertices.size()));
+        return report;
+    }
+
+    List<std::uint32_t> MeshOptimizer::OrderForVertexCache(List<std::uint32_t> &indices, std::uint32_t vertexCount) {
+        std::uint32_t triangleCount = static_cast<std::uint32_t>(indices.size() / 3);
+        // Triangles of every vertex, packed into one list with an offset per vertex.
+        List<std::uint32_t> adjacencyOffsets(vertexCount + 1, 0);
+        for (size_t i = 0; i < triangleCount * 3; i++) {
+            adjacencyOffsets[indices[i] + 1]++;
+        }
+        for (std::uint32_t vertex = 0; vertex < vertexCount; vertex++) {
+            adjacencyOffsets[vertex + 1] += adjacencyOffsets[vertex];
+        }
+        List<std::uint32_t> adjacency(adjacencyOffsets.back());
+        List<std::uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+        for (std::uint32_t triangle = 0; triangle < triangleCount; triangle++) {
+            for (std::uint32_t corner = 0; corner < 3; corner++) {
+                adjacency[fill[indices[triangle * 3 + corner]]++] = triangle;
+            }
+        }
+
+        // Triangles still to be emitted around every vertex.
+        List<std::uint32_t> liveTriangles(vertexCount);
+        for (std::uint32_t vertex = 0; vertex < vertexCount; vertex++) {
+            liveTriangles[vertex] = adjacencyOffsets[vertex + 1] - adjacencyOffsets[vertex];
+        }
+        // Timestamp of the cache load of every vertex, it is cached while time - cacheTime < VERTEX_CACHE_SIZE.
+        List<std::uint32_t> cacheTime(vertexCount, 0);
+        std::uint32_t time = VERTEX_CACHE_SIZE + 1;
+        List<bool> emitted(triangleCount, false);
+        List<std::uint32_t> deadEnds{};
+        List<std::uint32_t> candidates{};
+        List<std::uint32_t> output{};
+        output.reserve(triangleCount * 3);
+        List<std::uint32_t> clusters{0};
+        std::uint32_t cursor = 0;
+
+        const std::uint32_t none = ~0u;
+        std::uint32_t fan = none;
+        while (cursor < vertexCount && fan == none) {
+            if (liveTriangles[cursor] > 0) {
+                fan = cursor;
+            }
+            cursor++;
+        }
+        while (fan != none) {
+            // Emits every remaining triangle around the fanning vertex.
+            candidates.clear();
+            for (std::uint32_t i = adjacencyOffsets[fan]; i < adjacencyOffsets[fan + 1]; i++) {
+                std::uint32_t triangle = adjacency[i];
+                if (emitted[triangle]) {
+                    continue;
+                }
+                emitted[triangle] = true;
+                for (std::uint32_t corner = 0; corner < 3; corner++) {
+                    std::uint32_t vertex = indices[triangle * 3 + corner];
+                    output.push_back(vertex);
+                    deadEnds.push_back(vertex);
+                    candidates.push_back(vertex);
+                    liveTriangles[vertex]--;
+                    if (time - cacheTime[vertex] > VERTEX_CACHE_SIZE) {
+                        cacheTime[vertex] = time++;
+                    }
+                }
+            }
+
+            // The next fan is the oldest vertex that stays in the cache while its own triangles are emitted.
+            fan = none;
+            std::int64_t bestPriority = -1;
+            for (std::uint32_t vertex: candidates) {
+                if (liveTriangles[vertex] == 0) {
+                    continue;
+                }
+                std::int64_t priority = 0;
+                if (time - cacheTime[vertex] + 2 * liveTriangles[vertex] <= VERTEX_CACHE_SIZE) {
+                    priority = time - cacheTime[vertex];
+                }
+                if (priority > bestPriority) {
+                    bestPriority = priority;
+                    fan = vertex;
+                }
+            }
+            if (fan != none) {
+                continue;
+            }
+            // Dead end, resume at the most recently used vertex with triangles left, or at the next unused one.
+            while (!deadEnds.empty() && fan == none) {
+                if (liveTriangles[deadEnds.back()] > 0) {
+                    fan = deadEnds.back();
+                }
+                deadEnds.pop_back();
+            }
+            while (cursor < vertexCount && fan == none) {
+                if (liveTriangles[cursor] > 0) {
+                    fan = cursor;
+                }
+                cursor++;
+            }
+            if (fan != none) {
+                clusters.push_back(static_cast<std::uint32_t>(output.size() / 3));
+            }
+        }
+        clusters.push_back(triangleCount);
+        indices.swap(output);
+        return clusters;
+    }
+
+    void MeshOptimizer::OrderForOverdraw(List<std::uint32_t> &indices, const List<Vertex> &vertices,
+                                         const List<std::uint32_t> &clusters) {
+        struct Cluster {
+            std::uint32_t firstTriangle;
+            std::uint32_t triangleCount;
+            float sortKey;
+        };
+        size_t clusterCount = clusters.size() - 1;
+        if (clusterCount < 2) {
+            return;
+        }
+        // Area weighted centre and normal of every cluster, the cross product is twice the area along the normal.
+        List<glm::vec3> centres(clusterCount, glm::vec3{0.0f});
+        List<glm::vec3> normals(clusterCount, glm::vec3{0.0f});
+        List<float> areas(clusterCount, 0.0f);
+        glm::vec3 meshCentre{0.0f};
+        float meshArea = 0.0f;
+        for (size_t cluster = 0; cluster < clusterCount; cluster++) {
+            for (std::uint32_t triangle = clusters[cluster]; triangle < clusters[cluster + 1]; triangle++) {
+                const glm::vec3 &a = vertices[indices[triangle * 3]].pos;
+                const glm::vec3 &b = vertices[indices[triangle * 3 + 1]].pos;
+                const glm::vec3 &c = vertices[indices[triangle * 3 + 2]].pos;
+                glm::vec3 normal = glm::cross(b - a, c - a);
+                float area = glm::length(normal);
+                centres[cluster] += (a + b + c) * (area / 3.0f);
+                normals[cluster] += normal;
+                areas[cluster] += area;
+            }
+            meshCentre += centres[cluster];
+            meshArea += areas[cluster];
+        }
+        if (meshArea <= 0.0f) {
+            return;
+        }
+        meshCentre /= meshArea;
+
+        List<Cluster> order(clusterCount);
+        for (size_t cluster = 0; cluster < clusterCount; cluster++) {
+            order[cluster].firstTriangle = clusters[cluster];
+            order[cluster].triangleCount = clusters[cluster + 1] - clusters[cluster];
+            float normalLength = glm::length(normals[cluster]);
+            order[cluster].sortKey = 0.0f;
+            if (areas[cluster] > 0.0f && normalLength > 0.0f) {
+                glm::vec3 centre = centres[cluster] / areas[cluster];
+                order[cluster].sortKey = glm::dot(centre - meshCentre, normals[cluster] / normalLength);
+            }
+        }
+        // Clusters facing away from the centre are the outside of the mesh and occlude the ones further in.
+        std::stable_sort(order.begin(), order.end(), [](const Cluster &a, const Cluster &b) -> bool {
+            return a.sortKey > b.sortKey;
+        });
+
+        List<std::uint32_t> output{};
+        output.reserve(indices.size());
+        for (const Cluster &cluster: order) {
+            output.insert(output.end(), indices.begin() + cluster.firstTriangle * 3,
+                          indices.begin() + (cluster.firstTriangle + cluster.triangleCount) * 3);
+        }
+        indices.swap(output);
+    }
+
+    void MeshOptimizer::OrderForVertexFetch(List<Vertex> &vertices, List<std::uint32_t> &indices) {
+        const std::uint32_t unused = ~0u;
+        List<std::uint32_t> remap(vertices.size(), unused);
+        List<Vertex> output{};
+        output.reserve(vertices.size());
+        for (std::uint32_t &index: indices) {
+            if (remap[index] == unused) {
+                remap[index] = static_cast<std::uint32_t>(output.size());
+                output.push_back(vertices[index]);
+            }
+            index = remap[index];
+        }
+        vertices.swap(output);
+    }
+}
@@ -0,0 +1,315 @@
+//
+// Created by ghima on 22-10-2025.
+//
+#include "MeshSimplifier.h"
+
+namespace rn {
+    void MeshSimplifier::Quadric::AddPlane(const glm::vec3 &normal, float distance, float weight) {
+        a2 += weight * normal.x * normal.x;
+        b2 += weight * normal.y * normal.y;
+        c2 += weight * normal.z * normal.z;
+        ab += weight * normal.x * normal.y;
+        ac += weight * normal.x * normal.z;
+        bc += weight * normal.y * normal.z;
+        ad += weight * normal.x * distance;
+        bd += weight * normal.y * distance;
+        cd += weight * normal.z * distance;
+        d2 += weight * distance * distance;
+        this->weight += weight;
+    }
+
+    void MeshSimplifier::Quadric::Add(const Quadric &other) {
+        a2 += other.a2;
+        b2 += other.b2;
+        c2 += other.c2;
+        ab += other.ab;
+        ac += other.ac;
+        bc += other.bc;
+        ad += other.ad;
+        bd += other.bd;
+        cd += other.cd;
+        d2 += other.d2;
+        weight += other.weight;
+    }
+
+    double MeshSimplifier::Quadric::Evaluate(const glm::vec3 &position) const {
+        double x = position.x;
+        double y = position.y;
+        double z = position.z;
+        double error = a2 * x * x + b2 * y * y + c2 * z * z + 2.0 * (ab * x * y + ac * x * z + bc * y * z) +
+                       2.0 * (ad * x + bd * y + cd * z) + d2;
+        // Rounding can push the error of a vertex on all of its planes slightly below zero.
+        return weight > 0.0 ? std::max(error, 0.0) / weight : 0.0;
+    }
+
+    float MeshSimplifier::Simplify(const List<Vertex> &vertices, const List<std::uint32_t> &indices,
+                                   size_t targetIndexCount, float targetError, List<std::uint32_t> &result) {
+        struct Collapse {
+            std::uint32_t from;
+            std::uint32_t to;
+            double error;
+        };
+        result = indices;
+        if (indices.size() < 3 || vertices.empty()) {
+            return 0.0f;
+        }
+        glm::vec3 minPos = vertices[0].pos;
+        glm::vec3 maxPos = vertices[0].pos;
+        for (const Vertex &vertex: vertices) {
+            minPos = glm::min(minPos, vertex.pos);
+            maxPos = glm::max(maxPos, vertex.pos);
+        }
+        glm::vec3 extents = maxPos - minPos;
+        float extent = std::max(extents.x, std::max(extents.y, extents.z));
+        if (extent <= 0.0f) {
+            return 0.0f;
+        }
+
+        // Welds the attribute splits, the collapses work on positions and the triangles keep their vertices.
+        Map<std::string, std::uint32_t, std::hash<std::string>> positionIds{};
+        List<std::uint32_t> positionOf(vertices.size());
+        List<glm::vec3> positions{};
+        for (size_t i = 0; i < vertices.size(); i++) {
+            std::string key(reinterpret_cast<const char *>(&vertices[i].pos), sizeof(glm::vec3));
+            Map<std::string, std::uint32_t, std::hash<std::string>>::iterator found = positionIds.find(key);
+            if (found == positionIds.end()) {
+                found = positionIds.emplace(key, static_cast<std::uint32_t>(positions.size())).first;
+                // Scaled to a unit extent, so the errors are relative to the mesh size.
+                positions.push_back((vertices[i].pos - minPos) / extent);
+            }
+            positionOf[i] = found->second;
+        }
+        size_t positionCount = positions.size();
+
+        List<std::uint32_t> &triangles = result;
+        size_t triangleCount = triangles.size() / 3;
+        triangles.resize(triangleCount * 3);
+        List<bool> removed(triangleCount, false);
+        size_t liveTriangles = triangleCount;
+        List<List<std::uint32_t>> adjacency(positionCount);
+        List<Quadric> quadrics(positionCount);
+        for (std::uint32_t triangle = 0; triangle < triangleCount; triangle++) {
+            const glm::vec3 &a = positions[positionOf[triangles[triangle * 3]]];
+            const glm::vec3 &b = positions[positionOf[triangles[triangle * 3 + 1]]];
+            const glm::vec3 &c = positions[positionOf[triangles[triangle * 3 + 2]]];
+            glm::vec3 normal = glm::cross(b - a, c - a);
+            float doubleArea = glm::length(normal);
+            for (std::uint32_t corner = 0; corner < 3; corner++) {
+                adjacency[positionOf[triangles[triangle * 3 + corner]]].push_back(triangle);
+            }
+            if (doubleArea > 0.0f) {
+                normal /= doubleArea;
+                for (std::uint32_t corner = 0; corner < 3; corner++) {
+                    quadrics[positionOf[triangles[triangle * 3 + corner]]].AddPlane(normal, -glm::dot(normal, a),
+                                                                                     doubleArea * 0.5f);
+                }
+            }
+        }
+
+        // Triangles per position edge, one means a border and more than two a non-manifold edge.
+        Map<std::uint64_t, std::uint32_t, std::hash<std::uint64_t>> edgeTriangles{};
+        auto edgeKey = [](std::uint32_t a, std::uint32_t b) -> std::uint64_t {
+            return (static_cast<std::uint64_t>(std::min(a, b)) << 32) | std::max(a, b);
+        };
+        auto countEdges = [&]() -> void {
+            edgeTriangles.clear();
+            for (std::uint32_t triangle = 0; triangle < triangleCount; triangle++) {
+                if (removed[triangle]) {
+                    continue;
+                }
+                for (std::uint32_t corner = 0; corner < 3; corner++) {
+                    edgeTriangles[edgeKey(positionOf[triangles[triangle * 3 + corner]],
+                                          positionOf[triangles[triangle * 3 + (corner + 1) % 3]])]++;
+                }
+            }
+        };
+
+        // Planes through the border edges, perpendicular to their triangle, keep the outline in place.
+        countEdges();
+        for (std::uint32_t triangle = 0; triangle < triangleCount; triangle++) {
+            const glm::vec3 &a = positions[positionOf[triangles[triangle * 3]]];
+            const glm::vec3 &b = positions[positionOf[triangles[triangle * 3 + 1]]];
+            const glm::vec3 &c = positions[positionOf[triangles[triangle * 3 + 2]]];
+            glm::vec3 faceNormal = glm::cross(b - a, c - a);
+            if (glm::dot(faceNormal, faceNormal) == 0.0f) {
+                continue;
+            }
+            faceNormal = glm::normalize(faceNormal);
+            for (std::uint32_t corner = 0; corner < 3; corner++) {
+                std::uint32_t start = positionOf[triangles[triangle * 3 + corner]];
+                std::uint32_t end = positionOf[triangles[triangle * 3 + (corner + 1) % 3]];
+                if (edgeTriangles[edgeKey(start, end)] != 1) {
+                    continue;
+                }
+                glm::vec3 edge = positions[end] - positions[start];
+                float length = glm::length(edge);
+                if (length == 0.0f) {
+                    continue;
+                }
+                glm::vec3 normal = glm::normalize(glm::cross(edge, faceNormal));
+                float distance = -glm::dot(normal, positions[start]);
+                quadrics[start].AddPlane(normal, distance, length * length * MESH_LOD_BORDER_WEIGHT);
+                quadrics[end].AddPlane(normal, distance, length * length * MESH_LOD_BORDER_WEIGHT);
+            }
+        }
+
+        const double maxError = static_cast<double>(targetError) * targetError;
+        double reachedError = 0.0;
+        List<std::uint8_t> border(positionCount);
+        List<std::uint8_t> locked(positionCount);
+        List<std::uint8_t> touched(positionCount);
+        List<Collapse> collapses{};
+        // Vertex of the target position every vertex of the collapsing position moves to.
+        Map<std::uint32_t, std::uint32_t, std::hash<std::uint32_t>> wedgeMap{};
+        while (liveTriangles * 3 > targetIndexCount) {
+            countEdges();
+            std::fill(border.begin(), border.end(), 0);
+            std::fill(locked.begin(), locked.end(), 0);
+            std::fill(touched.begin(), touched.end(), 0);
+            for (const std::pair<const std::uint64_t, std::uint32_t> &edge: edgeTriangles) {
+                std::uint32_t a = static_cast<std::uint32_t>(edge.first >> 32);
+                std::uint32_t b = static_cast<std::uint32_t>(edge.first & 0xFFFFFFFFu);
+                if (edge.second == 1) {
+                    border[a] = border[b] = 1;
+                } else if (edge.second > 2) {
+                    locked[a] = locked[b] = 1;
+                }
+            }
+
+            collapses.clear();
+            for (const std::pair<const std::uint64_t, std::uint32_t> &edge: edgeTriangles) {
+                std::uint32_t a = static_cast<std::uint32_t>(edge.first >> 32);
+                std::uint32_t b = static_cast<std::uint32_t>(edge.first & 0xFFFFFFFFu);
+                Quadric quadric = quadrics[a];
+                quadric.Add(quadrics[b]);
+                // A border vertex may only slide along its border.
+                bool canMoveA = !locked[a] && (!border[a] || edge.second == 1);
+                bool canMoveB = !locked[b] && (!border[b] || edge.second == 1);
+                double errorA = canMoveA ? quadric.Evaluate(positions[b]) : maxError * 2.0 + 1.0;
+                double errorB = canMoveB ? quadric.Evaluate(positions[a]) : maxError * 2.0 + 1.0;
+                if (errorA <= errorB && errorA <= maxError) {
+                    collapses.push_back({a, b, errorA});
+                } else if (errorB < errorA && errorB <= maxError) {
+                    collapses.push_back({b, a, errorB});
+                }
+            }
+            std::sort(collapses.begin(), collapses.end(), [](const Collapse &a, const Collapse &b) -> bool {
+                return a.error < b.error;
+            });
+
+            size_t passCollapses = 0;
+            for (const Collapse &collapse: collapses) {
+                if (liveTriangles * 3 <= targetIndexCount) {
+                    break;
+                }
+                if (touched[collapse.from] || touched[collapse.to]) {
+                    continue;
+                }
+                // Every vertex of the moving position needs a vertex of the target position on a shared triangle,
+                // otherwise the collapse would tear a seam open.
+                wedgeMap.clear();
+                bool valid = true;
+                for (std::uint32_t triangle: adjacency[collapse.from]) {
+                    if (removed[triangle]) {
+                        continue;
+                    }
+                    std::uint32_t fromVertex = ~0u;
+                    std::uint32_t toVertex = ~0u;
+                    for (std::uint32_t corner = 0; corner < 3; corner++) {
+                        std::uint32_t vertex = triangles[triangle * 3 + corner];
+                        if (positionOf[vertex] == collapse.from) {
+                            fromVertex = vertex;
+                        } else if (positionOf[vertex] == collapse.to) {
+                            toVertex = vertex;
+                        }
+                    }
+                    if (toVertex != ~0u) {
+                        wedgeMap.emplace(fromVertex, toVertex);
+                    }
+                }
+                for (std::uint32_t triangle: adjacency[collapse.from]) {
+                    if (removed[triangle] || !valid) {
+                        continue;
+                    }
+                    std::uint32_t fromCorner = 0;
+                    bool hasTarget = false;
+                    for (std::uint32_t corner = 0; corner < 3; corner++) {
+                        std::uint32_t position = positionOf[triangles[triangle * 3 + corner]];
+                        if (position == collapse.from) {
+                            fromCorner = corner;
+                        } else if (position == collapse.to) {
+                            hasTarget = true;
+                        }
+                    }
+                    if (hasTarget) {
+                        continue;
+                    }
+                    if (wedgeMap.find(triangles[triangle * 3 + fromCorner]) == wedgeMap.end()) {
+                        valid = false;
+                        continue;
+                    }
+                    // The remaining triangles must not flip or fold over when the vertex moves.
+                    glm::vec3 a = positions[positionOf[triangles[triangle * 3]]];
+                    glm::vec3 b = positions[positionOf[triangles[triangle * 3 + 1]]];
+                    glm::vec3 c = positions[positionOf[triangles[triangle * 3 + 2]]];
+                    glm::vec3 before = glm::cross(b - a, c - a);
+                    std::array<glm::vec3 *, 3> corners{&a, &b, &c};
+                    *corners[fromCorner] = positions[collapse.to];
+                    glm::vec3 after = glm::cross(b - a, c - a);
+                    float lengths = glm::length(before) * glm::length(after);
+                    if (lengths == 0.0f || glm::dot(before, after) < MESH_LOD_MIN_NORMAL_DOT * lengths) {
+                        valid = false;
+                    }
+                }
+                if (!valid) {
+                    continue;
+                }
+
+                for (std::uint32_t triangle: adjacency[collapse.from]) {
+                    if (removed[triangle]) {
+                        continue;
+                    }
+                    bool degenerate = false;
+                    for (std::uint32_t corner = 0; corner < 3; corner++) {
+                        if (positionOf[triangles[triangle * 3 + corner]] == collapse.to) {
+                            degenerate = true;
+                        }
+                    }
+                    if (degenerate) {
+                        removed[triangle] = true;
+                        liveTriangles--;
+                        continue;
+                    }
+                    for (std::uint32_t corner = 0; corner < 3; corner++) {
+                        std::uint32_t &vertex = triangles[triangle * 3 + corner];
+                        if (positionOf[vertex] == collapse.from) {
+                            vertex = wedgeMap[vertex];
+                        }
+                    }
+                    adjacency[collapse.to].push_back(triangle);
+                }
+                adjacency[collapse.from].clear();
+                quadrics[collapse.to].Add(quadrics[collapse.from]);
+                touched[collapse.from] = touched[collapse.to] = 1;
+                reachedError = std::max(reachedError, collapse.error);
+                passCollapses++;
+            }
+            if (passCollapses == 0) {
+                break;
+            }
+        }
+
+        size_t written = 0;
+        for (size_t triangle = 0; triangle < triangleCount; triangle++) {
+            if (removed[triangle]) {
+                continue;
+            }
+            for (std::uint32_t corner = 0; corner < 3; corner++) {
+                triangles[written * 3 + corner] = triangles[triangle * 3 + corner];
+            }
+            written++;
+        }
+        triangles.resize(written * 3);
+        return static_cast<float>(std::sqrt(reachedError));
+    }
+}
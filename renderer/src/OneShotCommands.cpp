@@ -0,0 +1,189 @@
+//
+// Created by ghima on 22-10-2025.
+//
+#include "OneShotCommands.h"
+
+namespace rn {
+    OneShotCommands::OneShotCommands(RendererContext *ctx) : mCtx{ctx} {
+    }
+
+    OneShotCommands::~OneShotCommands() {
+        for (std::unique_ptr<ThreadPool> &pool: mPools) {
+            for (Context &context: pool->contexts) {
+                if (context.submission != 0) {
+                    vkWaitForFences(mCtx->logicalDevice, 1, &context.fence, VK_TRUE, UINT64_MAX);
+                }
+                vkDestroyFence(mCtx->logicalDevice, context.fence, nullptr);
+            }
+            // Destroying the pool frees its command buffers.
+            vkDestroyCommandPool(mCtx->logicalDevice, pool->commandPool, nullptr);
+        }
+    }
+
+    OneShotCommands::ThreadPool &OneShotCommands::GetThreadPool(std::uint32_t &poolIndex) {
+        std::lock_guard<std::mutex> guard{mPoolsMutex};
+        auto iter = mThreadPools.find(std::this_thread::get_id());
+        if (iter != mThreadPools.end()) {
+            poolIndex = iter->second;
+            return *mPools[poolIndex];
+        }
+
+        auto pool = std::make_unique<ThreadPool>();
+        VkCommandPoolCreateInfo commandPoolCreateInfo{};
+        commandPoolCreateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+        // Command buffers are short lived and reset one by one when they are begun again.
+        commandPoolCreateInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT |
+                                      VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+        commandPoolCreateInfo.queueFamilyIndex = mCtx->graphicsQueueIndex;
+        Utility::CheckVulkanError(
+                vkCreateCommandPool(mCtx->logicalDevice, &commandPoolCreateInfo, nullptr, &pool->commandPool),
+                "Failed to create the one shot command pool");
+        poolIndex = static_cast<std::uint32_t>(mPools.size());
+        mPools.push_back(std::move(pool));
+        mThreadPools[std::this_thread::get_id()] = poolIndex;
+        return *mPools[poolIndex];
+    }
+
+    OneShotCommands::ThreadPool &OneShotCommands::GetPool(std::uint32_t poolIndex) {
+        std::lock_guard<std::mutex> guard{mPoolsMutex};
+        return *mPools[poolIndex];
+    }
+
+    void OneShotCommands::Recycle(ThreadPool &pool) {
+        for (Context &context: pool.contexts) {
+            if (context.submission != 0 && vkGetFenceStatus(mCtx->logicalDevice, context.fence) == VK_SUCCESS) {
+                context.submission = 0;
+            }
+        }
+    }
+
+    VkCommandBuffer OneShotCommands::Begin() {
+        std::uint32_t poolIndex = 0;
+        ThreadPool &pool = GetThreadPool(poolIndex);
+        std::lock_guard<std::mutex> guard{pool.mutex};
+        mBeginCount++;
+
+        Recycle(pool);
+        Context *context = nullptr;
+        for (Context &candidate: pool.contexts) {
+            if (candidate.submission == 0 && !candidate.recording) {
+                context = &candidate;
+                break;
+            }
+        }
+        if (context == nullptr) {
+            Context newContext{};
+            VkCommandBufferAllocateInfo allocateInfo{};
+            allocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+            allocateInfo.commandPool = pool.commandPool;
+            allocateInfo.commandBufferCount = 1;
+            allocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+            Utility::CheckVulkanError(
+                    vkAllocateCommandBuffers(mCtx->logicalDevice, &allocateInfo, &newContext.commandBuffer),
+                    "Failed to allocate the one shot command buffer");
+
+            VkFenceCreateInfo fenceCreateInfo{};
+            fenceCreateInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+            Utility::CheckVulkanError(vkCreateFence(mCtx->logicalDevice, &fenceCreateInfo, nullptr, &newContext.fence),
+                                      "Failed to create the one shot fence");
+            pool.contexts.push_back(newContext);
+            context = &pool.contexts.back();
+            mCreatedCount++;
+        } else {
+            vkResetFences(mCtx->logicalDevice, 1, &context->fence);
+        }
+        context->recording = true;
+
+        VkCommandBufferBeginInfo beginInfo{};
+        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        // Begin implicitly resets a command buffer from a pool created with the reset flag.
+        Utility::CheckVulkanError(vkBeginCommandBuffer(context->commandBuffer, &beginInfo),
+                                  "Failed to begin the one shot command buffer");
+        return context->commandBuffer;
+    }
+
+    OneShotHandle OneShotCommands::Submit(VkCommandBuffer commandBuffer, bool wait) {
+        OneShotHandle handle{};
+        ThreadPool &pool = GetThreadPool(handle.poolIndex);
+        std::lock_guard<std::mutex> guard{pool.mutex};
+        Context *context = nullptr;
+        for (Context &candidate: pool.contexts) {
+            if (candidate.recording && candidate.commandBuffer == commandBuffer) {
+                context = &candidate;
+                break;
+            }
+        }
+        if (context == nullptr) {
+            LOG_ERROR("One shot command buffer was not begun on this thread.. Render is Exiting");
+            std::exit(EXIT_FAILURE);
+        }
+        Utility::CheckVulkanError(vkEndCommandBuffer(commandBuffer), "Failed to end the one shot command buffer");
+
+        VkSubmitInfo submitInfo{};
+        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submitInfo.commandBufferCount = 1;
+        submitInfo.pCommandBuffers = &commandBuffer;
+        {
+            std::lock_guard<std::mutex> queueGuard{*mCtx->graphicsQueueMutex};
+            Utility::CheckVulkanError(vkQueueSubmit(mCtx->graphicsQueue, 1, &submitInfo, context->fence),
+                                      "Failed to submit the one shot command buffer");
+        }
+        context->recording = false;
+        handle.submission = mNextSubmission++;
+        context->submission = handle.submission;
+        if (wait) {
+            vkWaitForFences(mCtx->logicalDevice, 1, &context->fence, VK_TRUE, UINT64_MAX);
+            context->submission = 0;
+        }
+        return handle;
+    }
+
+    OneShotHandle OneShotCommands::Submit(VkCommandBuffer commandBuffer) {
+        return Submit(commandBuffer, false);
+    }
+
+    void OneShotCommands::SubmitAndWait(VkCommandBuffer commandBuffer) {
+        Submit(commandBuffer, true);
+    }
+
+    bool OneShotCommands::IsComplete(OneShotHandle handle) {
+        if (handle.submission == 0) {
+            return true;
+        }
+        ThreadPool &pool = GetPool(handle.poolIndex);
+        std::lock_guard<std::mutex> guard{pool.mutex};
+        for (Context &context: pool.contexts) {
+            if (context.submission == handle.submission) {
+                if (vkGetFenceStatus(mCtx->logicalDevice, context.fence) != VK_SUCCESS) {
+                    return false;
+                }
+                context.submission = 0;
+                return true;
+            }
+        }
+        // Already recycled, which only happens after the fence signalled.
+        return true;
+    }
+
+    void OneShotCommands::Wait(OneShotHandle handle) {
+        if (handle.submission == 0) {
+            return;
+        }
+        ThreadPool &pool = GetPool(handle.poolIndex);
+        std::lock_guard<std::mutex> guard{pool.mutex};
+        for (Context &context: pool.contexts) {
+            if (context.submission == handle.submission) {
+                vkWaitForFences(mCtx->logicalDevice, 1, &context.fence, VK_TRUE, UINT64_MAX);
+                context.submission = 0;
+                return;
+            }
+        }
+    }
+
+    void OneShotCommands::LogStatistics() const {
+        std::lock_guard<std::mutex> guard{mPoolsMutex};
+        LOG_INFO("One shot commands : {} recorded with {} command buffers and fences across {} threads",
+                 mBeginCount.load(), mCreatedCount.load(), mPools.size());
+    }
+}
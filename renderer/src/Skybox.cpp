@@ -3,6 +3,7 @@
 //
 #include "SkyBox.h"
 #include "StaticMesh.h"
+#include "UploadQueue.h"
 
 #define STB_IMAGE_RESIZE2_IMPLEMENTATION
 
@@ -37,24 +38,9 @@ namespace rn {
 
         List<VkPipelineShaderStageCreateInfo> shaderStages{vertexShaderStageCreateInfo, fragShaderStageCreateInfo};
 
-        VkVertexInputBindingDescription vertexInputBindingDescription{};
-        vertexInputBindingDescription.binding = 0;
-        vertexInputBindingDescription.stride = sizeof(Vertex);
-        vertexInputBindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
-
-        VkVertexInputAttributeDescription positionAttribute{};
-        positionAttribute.binding = 0;
-        positionAttribute.location = 0;
-        positionAttribute.offset = 0;
-        positionAttribute.format = VK_FORMAT_R32G32B32_SFLOAT;
-
-        List<VkVertexInputAttributeDescription> attributeDescriptions{positionAttribute};
-        VkPipelineVertexInputStateCreateInfo vertexInputStateCreateInfo{};
-        vertexInputStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-        vertexInputStateCreateInfo.pVertexBindingDescriptions = &vertexInputBindingDescription;
-        vertexInputStateCreateInfo.vertexBindingDescriptionCount = 1;
-        vertexInputStateCreateInfo.vertexAttributeDescriptionCount = attributeDescriptions.size();
-        vertexInputStateCreateInfo.pVertexAttributeDescriptions = attributeDescriptions.data();
+        // The cube only needs the position stream of the geometry arena.
+        VertexInputDescription vertexInput = GeometryArena::DescribeVertexInput(VERTEX_ATTRIBUTE_POSITION);
+        VkPipelineVertexInputStateCreateInfo vertexInputStateCreateInfo = vertexInput.GetCreateInfo();
 
         VkPipelineInputAssemblyStateCreateInfo inputAssemblyStateCreateInfo{};
         inputAssemblyStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
@@ -158,8 +144,8 @@ namespace rn {
         vkDestroyShaderModule(mCtx->logicalDevice, fragShaderModule, nullptr);
     }
 
-    void Skybox::RenderSkyBox() {
-        vkCmdBindPipeline(mCtx->mainCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, mPipeline);
+    void Skybox::RenderSkyBox(VkCommandBuffer commandBuffer) {
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, mPipeline);
         VkViewport viewport{};
         viewport.x = 0.0f;
         viewport.y = 0.0f;
@@ -171,22 +157,21 @@ namespace rn {
         VkRect2D scissor{};
         scissor.offset = {0, 0};
         scissor.extent = mCtx->viewportExtends;
-        VkBuffer vertexBuffer = mCubeMesh->GetVertexBuffer();
-        vkCmdSetViewport(mCtx->mainCommandBuffer, 0, 1, &viewport);
-        vkCmdSetScissor(mCtx->mainCommandBuffer, 0, 1, &scissor);
+        vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+        vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
 
-        VkDeviceSize offset = {};
-        vkCmdBindVertexBuffers(mCtx->mainCommandBuffer, 0, 1, &vertexBuffer, &offset);
-        vkCmdBindIndexBuffer(mCtx->mainCommandBuffer, mCubeMesh->GetIndexBuffer(), offset, VK_INDEX_TYPE_UINT32);
+        mCtx->geometryArena->BindVertexBuffers(commandBuffer, VERTEX_ATTRIBUTE_POSITION);
+        vkCmdBindIndexBuffer(commandBuffer, mCubeMesh->GetIndexBuffer(), 0, mCubeMesh->GetIndexType());
 
-        ViewProjection viewProjection = *mCtx->GetViewProjectionMatrix();
+        const ViewProjection &viewProjection = mCtx->frameViewProjection;
         glm::mat4 VP = viewProjection.projection * glm::mat4(glm::mat3(viewProjection.view)); // drop translation
-        vkCmdPushConstants(mCtx->mainCommandBuffer, mLayout, VK_SHADER_STAGE_VERTEX_BIT,
+        vkCmdPushConstants(commandBuffer, mLayout, VK_SHADER_STAGE_VERTEX_BIT,
                            0, sizeof(glm::mat4), &VP);
-        vkCmdBindDescriptorSets(mCtx->mainCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, mLayout, 0, 1,
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, mLayout, 0, 1,
                                 &mDescriptorSets, 0,
                                 nullptr);
-        vkCmdDrawIndexed(mCtx->mainCommandBuffer, mCubeMesh->GetStaticMeshIndicesCount(), 1, 0, 0, 0);
+        vkCmdDrawIndexed(commandBuffer, mCubeMesh->GetStaticMeshIndicesCount(), 1, mCubeMesh->GetFirstIndex(),
+                         mCubeMesh->GetVertexOffset(), 0);
 
     }
 
@@ -283,48 +268,31 @@ namespace rn {
     }
 
     void Skybox::CreateImageAndImageViews() {
-        mSkyBoxImage = Utility::CreateImage("Sky box Image", mCtx->physicalDevice, mCtx->logicalDevice,
+        mSkyBoxImage = Utility::CreateImage("Sky box Image", *mCtx,
                                             SKY_BOX_RESOLUTION, SKY_BOX_RESOLUTION, VK_FORMAT_R8G8B8A8_SRGB,
                                             VK_IMAGE_TILING_OPTIMAL,
                                             (VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT),
                                             VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
                                             mSkyBoxImageMemory, 6, VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT);
-        Utility::TransitionImageLayout(*mCtx, mSkyBoxImage, VK_IMAGE_LAYOUT_UNDEFINED,
-                                       VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_ASPECT_COLOR_BIT, 6, 0);
         // Creating the image view with 6 layers.
         Utility::CreateImageView(mCtx->logicalDevice, mSkyBoxImage, VK_FORMAT_R8G8B8A8_SRGB, mSkyBoxImageView,
                                  VK_IMAGE_ASPECT_COLOR_BIT, 0, 6, VK_IMAGE_VIEW_TYPE_CUBE);
-        mStagingBuffers.resize(6);
-        mStagingBufferMemory.resize(6);
-
-        for (int i = 0; i < 6; i++) {
-            int height, width;
-            VkDeviceSize imageSize;
-            uint8_t *imageData = Utility::LoadTextureImage(R"(D:\cProjects\SmallVkEngine\textures\Textile.jpg)", width,
-                                                           height, imageSize);
-            VkDeviceSize SkyBoxImageSize = 4 * SKY_BOX_RESOLUTION * SKY_BOX_RESOLUTION;
-            unsigned char *resizeData = new unsigned char[4 * SKY_BOX_RESOLUTION * SKY_BOX_RESOLUTION]{};
-            stbir_resize_uint8_linear(reinterpret_cast<unsigned char *>(imageData), width, height, 0, resizeData,
-                                      SKY_BOX_RESOLUTION, SKY_BOX_RESOLUTION,
-                                      0, STBIR_RGBA);
-
-            Utility::CreateBuffer(*mCtx, mStagingBuffers[i], VK_BUFFER_USAGE_TRANSFER_SRC_BIT, mStagingBufferMemory[i],
-                                  VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-                                  4 * SKY_BOX_RESOLUTION * SKY_BOX_RESOLUTION, "Sky Box Buffer");
-            void *data;
-            vkMapMemory(mCtx->logicalDevice, mStagingBufferMemory[i], 0, SkyBoxImageSize, 0, &data);
-            memcpy(data, resizeData, SkyBoxImageSize);
-            vkUnmapMemory(mCtx->logicalDevice, mStagingBufferMemory[i]);
-            stbi_image_free(imageData);
-            delete[] resizeData;
-
-            Utility::CopyBufferToImage(*mCtx, mStagingBuffers[i], mSkyBoxImage, SKY_BOX_RESOLUTION, SKY_BOX_RESOLUTION,
-                                       VK_IMAGE_ASPECT_COLOR_BIT, i);
-            vkDestroyBuffer(mCtx->logicalDevice, mStagingBuffers[i], nullptr);
-            vkFreeMemory(mCtx->logicalDevice, mStagingBufferMemory[i], nullptr);
-        }
-        Utility::TransitionImageLayout(*mCtx, mSkyBoxImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-                                       VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_ASPECT_COLOR_BIT, 6, 0);
+        // All six faces are resized straight into staging memory and go out as a single upload.
+        VkDeviceSize SkyBoxImageSize = 4 * SKY_BOX_RESOLUTION * SKY_BOX_RESOLUTION;
+        mCtx->uploadQueue->UploadImage(mSkyBoxImage, VK_FORMAT_R8G8B8A8_SRGB, SKY_BOX_RESOLUTION, SKY_BOX_RESOLUTION, 6,
+                                       1, [SkyBoxImageSize](void *data) -> void {
+            auto faceData = static_cast<unsigned char *>(data);
+            for (int i = 0; i < 6; i++) {
+                int height, width;
+                VkDeviceSize imageSize;
+                uint8_t *imageData = Utility::LoadTextureImage(R"(D:\cProjects\SmallVkEngine\textures\Textile.jpg)",
+                                                               width, height, imageSize);
+                stbir_resize_uint8_linear(reinterpret_cast<unsigned char *>(imageData), width, height, 0,
+                                          faceData + i * SkyBoxImageSize, SKY_BOX_RESOLUTION, SKY_BOX_RESOLUTION,
+                                          0, STBIR_RGBA);
+                stbi_image_free(imageData);
+            }
+        });
     }
 
     void Skybox::CreateSamplerAndWriteDescriptorSet() {
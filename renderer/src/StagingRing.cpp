@@ -0,0 +1,41 @@
+//
+// Created by ghima on 22-10-2025.
+//
+#include "StagingRing.h"
+
+namespace rn {
+    StagingRing::StagingRing(RendererContext *ctx, VkDeviceSize size) : mCtx{ctx}, mSize{size} {
+        Utility::CreateBuffer(*mCtx, mBuffer, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, mMemory,
+                              (VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT), mSize,
+                              "Staging Ring Buffer");
+    }
+
+    StagingRing::~StagingRing() {
+        Utility::DestroyBuffer(*mCtx, mBuffer, mMemory);
+    }
+
+    bool StagingRing::Allocate(VkDeviceSize size, VkDeviceSize alignment, StagingAllocation &allocation) {
+        // Nothing is alive, starting from the beginning of the buffer keeps large uploads from wrapping early.
+        if (mHead == mTail) {
+            mHead = (mHead + mSize - 1) / mSize * mSize;
+            mTail = mHead;
+        }
+        VkDeviceSize position = (mHead + alignment - 1) / alignment * alignment;
+        // An allocation never straddles the end of the buffer, the rest of the lap is skipped instead.
+        if (position % mSize + size > mSize) {
+            position = (position / mSize + 1) * mSize;
+        }
+        if (position + size - mTail > mSize) {
+            return false;
+        }
+        mHead = position + size;
+        allocation.buffer = mBuffer;
+        allocation.offset = position % mSize;
+        allocation.data = static_cast<std::uint8_t *>(mMemory.mappedData) + allocation.offset;
+        return true;
+    }
+
+    void StagingRing::Release(VkDeviceSize head) {
+        mTail = std::max(mTail, head);
+    }
+}
@@ -3,14 +3,17 @@
 //
 #include "StaticMesh.h"
 #include "Texture.h"
+#include "MeshSimplifier.h"
+#include "MeshOptimizer.h"
 
 namespace rn {
     StaticMesh::StaticMesh(RendererContext &ctx, List<rn::Vertex> &Vertices, List<std::uint32_t> &indices,
                            std::uint32_t pickId,
-                           std::string &textureId, bool calculateNormals)
+                           std::string &textureId, bool calculateNormals, bool generateLods)
             : mRenderContext{ctx}, mVertList{Vertices}, mIndicesList{indices}, mPickId{pickId}, mTextureId{textureId},
-              mCalculateNormals{calculateNormals} {
+              mCalculateNormals{calculateNormals}, mGenerateLods{generateLods} {
         mIndicesCount = indices.size();
+        mLods[0] = {0, mIndicesCount, 0.0f};
         Init();
     }
 
@@ -33,25 +36,67 @@ namespace rn {
         }
     }
 
+    void StaticMesh::CalculateBoundingSphere() {
+        if (mVertList.empty()) {
+            return;
+        }
+        glm::vec3 minPos = mVertList[0].pos;
+        glm::vec3 maxPos = mVertList[0].pos;
+        for (const Vertex &vert: mVertList) {
+            minPos = glm::min(minPos, vert.pos);
+            maxPos = glm::max(maxPos, vert.pos);
+        }
+        glm::vec3 center = (minPos + maxPos) * 0.5f;
+        float radius = 0.0f;
+        for (const Vertex &vert: mVertList) {
+            radius = std::max(radius, glm::length(vert.pos - center));
+        }
+        mBoundingSphere = glm::vec4{center, radius};
+    }
+
     void StaticMesh::Init() {
 
 
         if (mCalculateNormals) {
             CalculateAverageNormals();
         }
-        // Creating the vertex buffers;
-        CreateMeshBuffer<Vertex>(mVertList, (VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT),
-                                 mVertexBuffer, mVertexBufferMemory, "VertexBuffer");
-        // Creating the indices mesh
-        CreateMeshBuffer<std::uint32_t>(mIndicesList,
-                                        (VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT),
-                                        mIndexBuffer, mIndexBufferMemory, "IndexBuffer");
+        CalculateBoundingSphere();
+        // Uploading the vertices and indices into the shared geometry arena, the LODs follow the full mesh in the
+        // same index range.
+        if (mGenerateLods) {
+            List<std::uint32_t> arenaIndices = mIndicesList;
+            GenerateLods(arenaIndices);
+            mGeometryRange = mRenderContext.geometryArena->Allocate(mVertList, arenaIndices);
+        } else {
+            mGeometryRange = mRenderContext.geometryArena->Allocate(mVertList, mIndicesList);
+        }
+    }
+
+    void StaticMesh::GenerateLods(List<std::uint32_t> &arenaIndices) {
+        List<std::uint32_t> previous = mIndicesList;
+        List<std::uint32_t> simplified{};
+        std::uint32_t vertexCount = static_cast<std::uint32_t>(mVertList.size());
+        while (mLodCount < MAX_MESH_LODS) {
+            size_t targetIndexCount = static_cast<size_t>(previous.size() / 3 * MESH_LOD_REDUCTION) * 3;
+            float error = MeshSimplifier::Simplify(mVertList, previous, targetIndexCount, MESH_LOD_MAX_ERROR,
+                                                   simplified);
+            // Flat shaded low poly meshes run out of collapses within the error early, their coarser levels would
+            // only cost index memory.
+            if (simplified.empty() || simplified.size() > previous.size() * MESH_LOD_MIN_REDUCTION) {
+                break;
+            }
+            MeshOptimizer::OrderForVertexCache(simplified, vertexCount);
+            MeshLod &lod = mLods[mLodCount];
+            lod.firstIndex = static_cast<std::uint32_t>(arenaIndices.size());
+            lod.indexCount = static_cast<std::uint32_t>(simplified.size());
+            lod.error = mLods[mLodCount - 1].error + error;
+            arenaIndices.insert(arenaIndices.end(), simplified.begin(), simplified.end());
+            previous.swap(simplified);
+            mLodCount++;
+        }
     }
 
     StaticMesh::~StaticMesh() {
-        vkDestroyBuffer(mRenderContext.logicalDevice, mVertexBuffer, nullptr);
-        vkDestroyBuffer(mRenderContext.logicalDevice, mIndexBuffer, nullptr);
-        vkFreeMemory(mRenderContext.logicalDevice, mVertexBufferMemory, nullptr);
-        vkFreeMemory(mRenderContext.logicalDevice, mIndexBufferMemory, nullptr);
+        mRenderContext.geometryArena->Free(mGeometryRange);
     }
 }
\ No newline at end of file
@@ -2,6 +2,11 @@
 // Created by ghima on 10-09-2025.
 //
 #include "Texture.h"
+#include "UploadQueue.h"
+#include "CookedTexture.h"
+#include "BlockCompression.h"
+#include "BindlessTextureTable.h"
+#include "stb_image_resize2.h"
 
 namespace rn {
 
@@ -10,48 +15,175 @@ namespace rn {
     }
 
     Texture::~Texture() {
+        if (mCtx->bindlessTextureTable != nullptr) {
+            mCtx->bindlessTextureTable->Release(mBindlessIndex);
+        }
         vkDestroyImageView(mCtx->logicalDevice, mTextureImageView, nullptr);
-        vkDestroyImage(mCtx->logicalDevice, mTextureImage, nullptr);
-        vkFreeMemory(mCtx->logicalDevice, mTextureImageMemory, nullptr);
+        Utility::DestroyImage(*mCtx, mTextureImage, mTextureImageMemory);
 
     }
 
     void Texture::CreateTexture(const char *fileName) {
         CreateTextureImage(fileName);
-        Utility::CreateImageView(mCtx->logicalDevice, mTextureImage, VK_FORMAT_R8G8B8A8_SRGB, mTextureImageView,
-                                 VK_IMAGE_ASPECT_COLOR_BIT);
+        Utility::CreateImageView(mCtx->logicalDevice, mTextureImage, mFormat, mTextureImageView,
+                                 VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, VK_IMAGE_VIEW_TYPE_2D, mMipLevels);
         CreateTextureDescriptorSets(mTextureImageView);
+        if (mCtx->bindlessTextureTable != nullptr) {
+            mBindlessIndex = mCtx->bindlessTextureTable->Register(mTextureImageView, mCtx->textureSampler);
+        }
+    }
+
+    void Texture::SetSampler(VkSampler sampler) {
+        WriteTextureDescriptorSet(sampler);
+        if (mCtx->bindlessTextureTable != nullptr) {
+            mCtx->bindlessTextureTable->Update(mBindlessIndex, mTextureImageView, sampler);
+        }
     }
 
     void Texture::CreateTextureImage(const char *fileName) {
+        // Either the cooked file itself or a source image with a cooked file next to it.
+        std::string cookedFileName{fileName};
+        std::string extension{COOKED_TEXTURE_EXTENSION};
+        if (cookedFileName.size() < extension.size() ||
+            cookedFileName.compare(cookedFileName.size() - extension.size(), extension.size(), extension) != 0) {
+            cookedFileName += extension;
+        }
+        if (LoadCookedTexture(cookedFileName)) {
+            return;
+        }
         int width, height;
         VkDeviceSize imageSize;
         stbi_uc *imageData = Utility::LoadTextureImage(fileName, width, height, imageSize);
-        VkBuffer stagingBuffer{};
-        VkDeviceMemory stagingBufferMemory{};
-        std::string stagingBufferName = "StagingBufferTexture";
-        Utility::CreateBuffer(*mCtx, stagingBuffer, (VK_BUFFER_USAGE_TRANSFER_SRC_BIT), stagingBufferMemory,
-                              (VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT), imageSize,
-                              stagingBufferName);
-        void *data;
-        vkMapMemory(mCtx->logicalDevice, stagingBufferMemory, 0, imageSize, 0, &data);
-        memcpy(data, imageData, imageSize);
-        vkUnmapMemory(mCtx->logicalDevice, stagingBufferMemory);
+        mWidth = width;
+        mHeight = height;
+        mMipLevels = Utility::GetMipLevelCount(mWidth, mHeight);
+        mTextureImage = Utility::CreateImage("Texture Image", *mCtx, width, height,
+                                             VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_TILING_OPTIMAL,
+                                             (VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT),
+                                             (VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT), mTextureImageMemory, 1, 0,
+                                             VK_IMAGE_LAYOUT_UNDEFINED, mMipLevels);
+        // The chain is built on the CPU while loading, the upload then only copies, which a transfer only queue can do.
+        // Both layout transitions and the copies of all levels are recorded into the next upload batch.
+        mCtx->uploadQueue->UploadImage(mTextureImage, VK_FORMAT_R8G8B8A8_SRGB, mWidth, mHeight, 1, mMipLevels,
+                                       [this, imageData](void *data) -> void {
+                                           WriteMipChain(imageData, static_cast<std::uint8_t *>(data));
+                                       });
         stbi_image_free(imageData);
+    }
 
+    bool Texture::IsFormatSampleable(VkFormat format) const {
+        if (BlockCompression::IsBlockCompressed(format) && !mCtx->textureCompressionBCSupported) {
+            return false;
+        }
+        VkFormatProperties formatProperties{};
+        vkGetPhysicalDeviceFormatProperties(mCtx->physicalDevice, format, &formatProperties);
+        return (formatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT) != 0;
+    }
 
-        mTextureImage = Utility::CreateImage("Texture Image", mCtx->physicalDevice, mCtx->logicalDevice, width, height,
-                                             VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_TILING_OPTIMAL,
+    bool Texture::LoadCookedTexture(const std::string &fileName) {
+        std::ifstream stream{};
+        CookedTextureHeader header{};
+        List<CookedTextureLevel> levels{};
+        if (!CookedTexture::Open(fileName, stream, header, levels)) {
+            return false;
+        }
+        VkFormat cookedFormat = static_cast<VkFormat>(header.format);
+        mWidth = header.width;
+        mHeight = header.height;
+        mMipLevels = header.levelCount;
+        VkDeviceSize dataSize = 0;
+        for (const CookedTextureLevel &level: levels) {
+            dataSize += level.size;
+        }
+        std::streampos dataBegin = stream.tellg();
+        stream.seekg(0, std::ios::end);
+        std::streamoff available = stream.tellg() - dataBegin;
+        stream.seekg(dataBegin);
+        if (available < static_cast<std::streamoff>(dataSize)) {
+            LOG_ERROR("Cooked texture {} is truncated, loading the source image instead", fileName);
+            return false;
+        }
+
+        bool decode = !IsFormatSampleable(cookedFormat);
+        VkFormat format = decode ? BlockCompression::GetFallbackFormat(cookedFormat) : cookedFormat;
+        if (decode) {
+            LOG_WARN("Texture format {} of {} can not be sampled on this device, decoding it to RGBA8",
+                     static_cast<std::uint32_t>(cookedFormat), fileName);
+        }
+        List<std::uint8_t> blocks{};
+        if (decode) {
+            blocks.resize(dataSize);
+            if (!stream.read(reinterpret_cast<char *>(blocks.data()), static_cast<std::streamsize>(dataSize))) {
+                LOG_ERROR("Failed to read cooked texture {}, loading the source image instead", fileName);
+                return false;
+            }
+        }
+        mTextureImage = Utility::CreateImage("Cooked Texture Image", *mCtx, mWidth, mHeight, format,
+                                             VK_IMAGE_TILING_OPTIMAL,
                                              (VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT),
-                                             (VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT), mTextureImageMemory);
-        Utility::TransitionImageLayout(*mCtx, mTextureImage, VK_IMAGE_LAYOUT_UNDEFINED,
-                                       VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_ASPECT_COLOR_BIT);
-        Utility::CopyBufferToImage(*mCtx, stagingBuffer, mTextureImage, width, height, VK_IMAGE_ASPECT_COLOR_BIT);
-        Utility::TransitionImageLayout(*mCtx, mTextureImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-                                       VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_ASPECT_COLOR_BIT);
-
-        vkDestroyBuffer(mCtx->logicalDevice, stagingBuffer, nullptr);
-        vkFreeMemory(mCtx->logicalDevice, stagingBufferMemory, nullptr);
+                                             (VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT), mTextureImageMemory, 1, 0,
+                                             VK_IMAGE_LAYOUT_UNDEFINED, mMipLevels);
+        if (!decode) {
+            // The levels are stored in upload order, so the file is read straight into staging memory.
+            bool readFailed = false;
+            UploadTicket ticket = mCtx->uploadQueue->UploadImage(
+                    mTextureImage, format, mWidth, mHeight, 1, mMipLevels,
+                    [&stream, dataSize, &readFailed](void *data) -> void {
+                        readFailed = !stream.read(static_cast<char *>(data), static_cast<std::streamsize>(dataSize));
+                    });
+            if (readFailed) {
+                // The copy is already recorded, the image can only go once it has run.
+                LOG_ERROR("Failed to read cooked texture {}, loading the source image instead", fileName);
+                mCtx->uploadQueue->Wait(ticket);
+                Utility::DestroyImage(*mCtx, mTextureImage, mTextureImageMemory);
+                return false;
+            }
+        } else {
+            mCtx->uploadQueue->UploadImage(mTextureImage, format, mWidth, mHeight, 1, mMipLevels,
+                                           [this, &blocks, cookedFormat, format](void *data) -> void {
+                                               auto staging = static_cast<std::uint8_t *>(data);
+                                               const std::uint8_t *source = blocks.data();
+                                               for (std::uint32_t level = 0; level < mMipLevels; level++) {
+                                                   std::uint32_t levelWidth = std::max(mWidth >> level, 1u);
+                                                   std::uint32_t levelHeight = std::max(mHeight >> level, 1u);
+                                                   BlockCompression::DecompressLevel(cookedFormat, source, levelWidth,
+                                                                                     levelHeight, staging);
+                                                   source += Utility::GetImageLevelSize(cookedFormat, mWidth,
+                                                                                        mHeight, level);
+                                                   staging += Utility::GetImageLevelSize(format, mWidth, mHeight,
+                                                                                         level);
+                                               }
+                                           });
+        }
+        mFormat = format;
+        return true;
+    }
+
+    void Texture::WriteMipChain(const std::uint8_t *imageData, std::uint8_t *staging) const {
+        VkDeviceSize levelSize = Utility::GetImageLevelSize(VK_FORMAT_R8G8B8A8_SRGB, mWidth, mHeight, 0);
+        memcpy(staging, imageData, levelSize);
+        staging += levelSize;
+
+        // Staging memory is write combined and slow to read back, so every level is downsampled from the previous one
+        // in host memory and copied into staging once.
+        List<std::uint8_t> previous{};
+        List<std::uint8_t> current{};
+        const std::uint8_t *source = imageData;
+        for (std::uint32_t level = 1; level < mMipLevels; level++) {
+            int sourceWidth = static_cast<int>(std::max(mWidth >> (level - 1), 1u));
+            int sourceHeight = static_cast<int>(std::max(mHeight >> (level - 1), 1u));
+            int levelWidth = static_cast<int>(std::max(mWidth >> level, 1u));
+            int levelHeight = static_cast<int>(std::max(mHeight >> level, 1u));
+            levelSize = Utility::GetImageLevelSize(VK_FORMAT_R8G8B8A8_SRGB, mWidth, mHeight, level);
+            current.resize(levelSize);
+            // Filtered in linear space, averaging the sRGB values directly would darken every level.
+            stbir_resize_uint8_srgb(source, sourceWidth, sourceHeight, 0, current.data(), levelWidth, levelHeight, 0,
+                                    STBIR_RGBA);
+            memcpy(staging, current.data(), levelSize);
+            staging += levelSize;
+            previous.swap(current);
+            source = previous.data();
+        }
     }
 
     void Texture::CreateTextureDescriptorSets(VkImageView imageView) {
@@ -64,11 +196,14 @@ namespace rn {
 
         Utility::CheckVulkanError(vkAllocateDescriptorSets(mCtx->logicalDevice, &allocateInfo, &mTextureDescriptorSet),
                                   "Failed to allocate Descriptor set for the texture");
+        WriteTextureDescriptorSet(mCtx->textureSampler);
+    }
 
+    void Texture::WriteTextureDescriptorSet(VkSampler sampler) {
         VkDescriptorImageInfo imageInfo{};
         imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-        imageInfo.sampler = mCtx->textureSampler;
-        imageInfo.imageView = imageView;
+        imageInfo.sampler = sampler;
+        imageInfo.imageView = mTextureImageView;
 
         VkWriteDescriptorSet writeInfo{};
         writeInfo.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
@@ -0,0 +1,53 @@
+//
+// Created by ghima on 21-10-2025.
+//
+#include "ThreadCommandPools.h"
+
+namespace rn {
+    ThreadCommandPools::ThreadCommandPools(RendererContext *ctx, VkCommandBufferLevel level, std::uint32_t slotCount)
+            : mCtx{ctx}, mLevel{level}, mSlotCount{slotCount} {
+        mPools.resize(MAX_FRAMES_IN_FLIGHT * mSlotCount);
+        VkCommandPoolCreateInfo commandPoolCreateInfo{};
+        commandPoolCreateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+        commandPoolCreateInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+        commandPoolCreateInfo.queueFamilyIndex = mCtx->graphicsQueueIndex;
+        for (SlotPool &pool: mPools) {
+            Utility::CheckVulkanError(
+                    vkCreateCommandPool(mCtx->logicalDevice, &commandPoolCreateInfo, nullptr, &pool.commandPool),
+                    "Failed to create the per thread command pool");
+        }
+    }
+
+    ThreadCommandPools::~ThreadCommandPools() {
+        for (SlotPool &pool: mPools) {
+            vkDestroyCommandPool(mCtx->logicalDevice, pool.commandPool, nullptr);
+        }
+    }
+
+    void ThreadCommandPools::Reset(size_t currentFrameIndex) {
+        for (std::uint32_t slot = 0; slot < mSlotCount; slot++) {
+            SlotPool &pool = mPools[currentFrameIndex * mSlotCount + slot];
+            if (pool.usedCount > 0) {
+                vkResetCommandPool(mCtx->logicalDevice, pool.commandPool, 0);
+                pool.usedCount = 0;
+            }
+        }
+    }
+
+    VkCommandBuffer ThreadCommandPools::Acquire(size_t currentFrameIndex, std::uint32_t slot) {
+        SlotPool &pool = mPools[currentFrameIndex * mSlotCount + slot];
+        if (pool.usedCount == pool.commandBuffers.size()) {
+            VkCommandBufferAllocateInfo allocateInfo{};
+            allocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+            allocateInfo.commandBufferCount = 1;
+            allocateInfo.level = mLevel;
+            allocateInfo.commandPool = pool.commandPool;
+
+            VkCommandBuffer commandBuffer{};
+            Utility::CheckVulkanError(vkAllocateCommandBuffers(mCtx->logicalDevice, &allocateInfo, &commandBuffer),
+                                      "Failed to allocate the per thread command buffer");
+            pool.commandBuffers.push_back(commandBuffer);
+        }
+        return pool.commandBuffers[pool.usedCount++];
+    }
+}
@@ -0,0 +1,28 @@
+//
+// Created by ghima on 19-10-2025.
+//
+#include "UniformRing.h"
+
+namespace rn {
+    UniformRing::UniformRing(RendererContext *ctx, VkDeviceSize frameSize) : mCtx{ctx} {
+        VkPhysicalDeviceProperties properties{};
+        vkGetPhysicalDeviceProperties(mCtx->physicalDevice, &properties);
+        mPool = mCtx->memoryAllocator->CreateLinearPool(VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, frameSize,
+                                                        properties.limits.minUniformBufferOffsetAlignment,
+                                                        "Uniform Ring Buffer");
+    }
+
+    UniformRing::~UniformRing() {
+        mCtx->memoryAllocator->DestroyLinearPool(mPool);
+    }
+
+    void UniformRing::BeginFrame(size_t currentFrameIndex) {
+        // The caller has already waited on this frame's fence, so the whole region is free again.
+        mPool->BeginFrame(currentFrameIndex);
+    }
+
+    UniformAllocation UniformRing::Allocate(VkDeviceSize size) {
+        LinearAllocation allocation = mPool->Allocate(size);
+        return {allocation.data, static_cast<std::uint32_t>(allocation.offset)};
+    }
+}
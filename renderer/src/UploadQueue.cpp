@@ -0,0 +1,393 @@
+//
+// Created by ghima on 22-10-2025.
+//
+#include "UploadQueue.h"
+
+namespace rn {
+    UploadQueue::UploadQueue(RendererContext *ctx, std::uint32_t transferQueueIndex, VkQueue transferQueue,
+                             VkDeviceSize stagingSize) : mCtx{ctx}, mTransferQueueIndex{transferQueueIndex},
+                                                         mTransferQueue{transferQueue},
+                                                         mStagingRing{ctx, stagingSize} {
+        mDedicatedTransferQueue = mTransferQueueIndex != mCtx->graphicsQueueIndex;
+
+        VkCommandPoolCreateInfo poolCreateInfo{};
+        poolCreateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+        // Batches are recycled, their command buffers are reset one by one when they are begun again.
+        poolCreateInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+        poolCreateInfo.queueFamilyIndex = mTransferQueueIndex;
+        Utility::CheckVulkanError(
+                vkCreateCommandPool(mCtx->logicalDevice, &poolCreateInfo, nullptr, &mTransferCommandPool),
+                "Failed to create the upload command pool");
+        if (mDedicatedTransferQueue) {
+            poolCreateInfo.queueFamilyIndex = mCtx->graphicsQueueIndex;
+            Utility::CheckVulkanError(
+                    vkCreateCommandPool(mCtx->logicalDevice, &poolCreateInfo, nullptr, &mGraphicsCommandPool),
+                    "Failed to create the upload ownership command pool");
+        }
+        mOpenBatch.ticket = 1;
+    }
+
+    UploadQueue::~UploadQueue() {
+        std::lock_guard<std::mutex> guard{mMutex};
+        FlushLocked();
+        RetireBatches(UINT64_MAX);
+        for (Batch &batch: mFreeBatches) {
+            DestroyBatch(batch);
+        }
+        vkDestroyCommandPool(mCtx->logicalDevice, mTransferCommandPool, nullptr);
+        if (mDedicatedTransferQueue) {
+            vkDestroyCommandPool(mCtx->logicalDevice, mGraphicsCommandPool, nullptr);
+        }
+    }
+
+    StagingAllocation UploadQueue::Stage(VkDeviceSize size, const StagingWriter &writer) {
+        // Image copies need offsets aligned to the texel size, 16 covers every format the renderer uploads.
+        const VkDeviceSize alignment = 16;
+        StagingAllocation allocation{};
+        bool fits = size <= mStagingRing.GetSize();
+        bool reserved = fits && mStagingRing.Allocate(size, alignment, allocation);
+        if (!reserved && fits) {
+            mStagingStallCount++;
+            // The open batch holds part of the ring, submitting it lets the ring drain completely.
+            FlushLocked();
+        }
+        while (!reserved && fits && !mInFlightBatches.empty()) {
+            RetireBatches(mInFlightBatches.front().ticket);
+            reserved = mStagingRing.Allocate(size, alignment, allocation);
+        }
+        if (reserved) {
+            writer(allocation.data);
+            return allocation;
+        }
+
+        MemoryAllocation memory{};
+        Utility::CreateBuffer(*mCtx, allocation.buffer, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, memory,
+                              (VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT), size,
+                              "Oversized Upload Staging Buffer");
+        allocation.offset = 0;
+        allocation.data = memory.mappedData;
+        writer(allocation.data);
+        mOpenBatch.oversizedBuffers.push_back(allocation.buffer);
+        mOpenBatch.oversizedMemory.push_back(memory);
+        return allocation;
+    }
+
+    UploadTicket UploadQueue::UploadBuffer(VkBuffer buffer, VkDeviceSize dstOffset, VkDeviceSize size,
+                                           VkPipelineStageFlags dstStage, VkAccessFlags dstAccess,
+                                           const StagingWriter &writer) {
+        std::lock_guard<std::mutex> guard{mMutex};
+        StagingAllocation staging = Stage(size, writer);
+        BufferUpload upload{};
+        upload.source = staging.buffer;
+        upload.buffer = buffer;
+        upload.region.srcOffset = staging.offset;
+        upload.region.size = size;
+        upload.region.dstOffset = dstOffset;
+        upload.dstStage = dstStage;
+        upload.dstAccess = dstAccess;
+        mBufferUploads.push_back(upload);
+        mUploadCount++;
+        return mOpenBatch.ticket;
+    }
+
+    UploadTicket UploadQueue::UploadBuffer(VkBuffer buffer, VkDeviceSize dstOffset, const void *data,
+                                           VkDeviceSize size, VkPipelineStageFlags dstStage,
+                                           VkAccessFlags dstAccess) {
+        return UploadBuffer(buffer, dstOffset, size, dstStage, dstAccess, [data, size](void *staging) -> void {
+            memcpy(staging, data, size);
+        });
+    }
+
+    UploadTicket UploadQueue::UploadImage(VkImage image, VkFormat format, std::uint32_t width, std::uint32_t height,
+                                          std::uint32_t layerCount, std::uint32_t mipLevels,
+                                          const StagingWriter &writer) {
+        VkDeviceSize size = 0;
+        for (std::uint32_t level = 0; level < mipLevels; level++) {
+            size += Utility::GetImageLevelSize(format, width, height, level) * layerCount;
+        }
+        std::lock_guard<std::mutex> guard{mMutex};
+        StagingAllocation staging = Stage(size, writer);
+        ImageUpload upload{};
+        upload.source = staging.buffer;
+        upload.image = image;
+        upload.layerCount = layerCount;
+        upload.mipLevels = mipLevels;
+        // One region per level, the layers of a level are tightly packed so a single region covers all of them.
+        VkDeviceSize levelOffset = staging.offset;
+        for (std::uint32_t level = 0; level < mipLevels; level++) {
+            VkBufferImageCopy region{};
+            region.bufferOffset = levelOffset;
+            region.imageExtent = {std::max(width >> level, 1u), std::max(height >> level, 1u), 1};
+            region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            region.imageSubresource.mipLevel = level;
+            region.imageSubresource.baseArrayLayer = 0;
+            region.imageSubresource.layerCount = layerCount;
+            upload.regions.push_back(region);
+            levelOffset += Utility::GetImageLevelSize(format, width, height, level) * layerCount;
+        }
+        mImageUploads.push_back(std::move(upload));
+        mUploadCount++;
+        return mOpenBatch.ticket;
+    }
+
+    UploadTicket UploadQueue::UploadImage(VkImage image, std::uint32_t width, std::uint32_t height, const void *data,
+                                          VkDeviceSize size, std::uint32_t layerCount) {
+        return UploadImage(image, VK_FORMAT_R8G8B8A8_UNORM, width, height, layerCount, 1,
+                           [data, size](void *staging) -> void {
+                               memcpy(staging, data, size);
+                           });
+    }
+
+    void UploadQueue::PrepareBatch(Batch &batch) {
+        if (!mFreeBatches.empty()) {
+            batch = std::move(mFreeBatches.back());
+            mFreeBatches.pop_back();
+            return;
+        }
+        VkCommandBufferAllocateInfo allocateInfo{};
+        allocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        allocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        allocateInfo.commandBufferCount = 1;
+        allocateInfo.commandPool = mTransferCommandPool;
+        Utility::CheckVulkanError(
+                vkAllocateCommandBuffers(mCtx->logicalDevice, &allocateInfo, &batch.transferCommandBuffer),
+                "Failed to allocate the upload command buffer");
+
+        VkFenceCreateInfo fenceCreateInfo{};
+        fenceCreateInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+        Utility::CheckVulkanError(vkCreateFence(mCtx->logicalDevice, &fenceCreateInfo, nullptr, &batch.fence),
+                                  "Failed to create the upload fence");
+        if (mDedicatedTransferQueue) {
+            allocateInfo.commandPool = mGraphicsCommandPool;
+            Utility::CheckVulkanError(
+                    vkAllocateCommandBuffers(mCtx->logicalDevice, &allocateInfo, &batch.graphicsCommandBuffer),
+                    "Failed to allocate the upload ownership command buffer");
+            VkSemaphoreCreateInfo semaphoreCreateInfo{};
+            semaphoreCreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+            Utility::CheckVulkanError(
+                    vkCreateSemaphore(mCtx->logicalDevice, &semaphoreCreateInfo, nullptr, &batch.ownershipSemaphore),
+                    "Failed to create the upload ownership semaphore");
+        }
+    }
+
+    void UploadQueue::RecordTransfer(VkCommandBuffer commandBuffer) {
+        List<VkImageMemoryBarrier> imageBarriers{};
+        for (const ImageUpload &upload: mImageUploads) {
+            VkImageMemoryBarrier barrier{};
+            barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+            barrier.image = upload.image;
+            barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+            barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+            barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            barrier.srcAccessMask = 0;
+            barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            barrier.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, upload.mipLevels, 0, upload.layerCount};
+            imageBarriers.push_back(barrier);
+        }
+        if (!imageBarriers.empty()) {
+            vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+                                 0, nullptr, 0, nullptr, imageBarriers.size(), imageBarriers.data());
+        }
+
+        for (const BufferUpload &upload: mBufferUploads) {
+            vkCmdCopyBuffer(commandBuffer, upload.source, upload.buffer, 1, &upload.region);
+        }
+        for (const ImageUpload &upload: mImageUploads) {
+            vkCmdCopyBufferToImage(commandBuffer, upload.source, upload.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                   upload.regions.size(), upload.regions.data());
+        }
+
+        // Without a dedicated queue this is the final barrier, otherwise it releases the resources to the graphics
+        // queue and the destination stages are only used by the acquire.
+        VkPipelineStageFlags dstStages = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+        List<VkBufferMemoryBarrier> bufferBarriers{};
+        for (const BufferUpload &upload: mBufferUploads) {
+            VkBufferMemoryBarrier barrier{};
+            barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+            barrier.buffer = upload.buffer;
+            barrier.offset = upload.region.dstOffset;
+            barrier.size = upload.region.size;
+            barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            barrier.dstAccessMask = mDedicatedTransferQueue ? 0 : upload.dstAccess;
+            barrier.srcQueueFamilyIndex = mDedicatedTransferQueue ? mTransferQueueIndex : VK_QUEUE_FAMILY_IGNORED;
+            barrier.dstQueueFamilyIndex = mDedicatedTransferQueue ? mCtx->graphicsQueueIndex : VK_QUEUE_FAMILY_IGNORED;
+            bufferBarriers.push_back(barrier);
+            dstStages |= upload.dstStage;
+        }
+        imageBarriers.clear();
+        for (const ImageUpload &upload: mImageUploads) {
+            VkImageMemoryBarrier barrier{};
+            barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+            barrier.image = upload.image;
+            barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+            barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+            barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            barrier.dstAccessMask = mDedicatedTransferQueue ? 0 : VK_ACCESS_SHADER_READ_BIT;
+            barrier.srcQueueFamilyIndex = mDedicatedTransferQueue ? mTransferQueueIndex : VK_QUEUE_FAMILY_IGNORED;
+            barrier.dstQueueFamilyIndex = mDedicatedTransferQueue ? mCtx->graphicsQueueIndex : VK_QUEUE_FAMILY_IGNORED;
+            barrier.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, upload.mipLevels, 0, upload.layerCount};
+            imageBarriers.push_back(barrier);
+            dstStages |= VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+        }
+        if (mDedicatedTransferQueue) {
+            dstStages = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+        }
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, dstStages, 0,
+                             0, nullptr, bufferBarriers.size(), bufferBarriers.data(),
+                             imageBarriers.size(), imageBarriers.data());
+    }
+
+    void UploadQueue::RecordAcquire(VkCommandBuffer commandBuffer) {
+        VkPipelineStageFlags dstStages = 0;
+        List<VkBufferMemoryBarrier> bufferBarriers{};
+        for (const BufferUpload &upload: mBufferUploads) {
+            VkBufferMemoryBarrier barrier{};
+            barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+            barrier.buffer = upload.buffer;
+            barrier.offset = upload.region.dstOffset;
+            barrier.size = upload.region.size;
+            barrier.srcAccessMask = 0;
+            barrier.dstAccessMask = upload.dstAccess;
+            barrier.srcQueueFamilyIndex = mTransferQueueIndex;
+            barrier.dstQueueFamilyIndex = mCtx->graphicsQueueIndex;
+            bufferBarriers.push_back(barrier);
+            dstStages |= upload.dstStage;
+        }
+        List<VkImageMemoryBarrier> imageBarriers{};
+        for (const ImageUpload &upload: mImageUploads) {
+            VkImageMemoryBarrier barrier{};
+            barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+            barrier.image = upload.image;
+            barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+            barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+            barrier.srcAccessMask = 0;
+            barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+            barrier.srcQueueFamilyIndex = mTransferQueueIndex;
+            barrier.dstQueueFamilyIndex = mCtx->graphicsQueueIndex;
+            barrier.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, upload.mipLevels, 0, upload.layerCount};
+            imageBarriers.push_back(barrier);
+            dstStages |= VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+        }
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, dstStages, 0,
+                             0, nullptr, bufferBarriers.size(), bufferBarriers.data(),
+                             imageBarriers.size(), imageBarriers.data());
+    }
+
+    void UploadQueue::FlushLocked() {
+        if (mBufferUploads.empty() && mImageUploads.empty()) {
+            return;
+        }
+        Batch batch{};
+        PrepareBatch(batch);
+        batch.ticket = mOpenBatch.ticket;
+        batch.stagingEnd = mStagingRing.GetHead();
+        batch.oversizedBuffers = std::move(mOpenBatch.oversizedBuffers);
+        batch.oversizedMemory = std::move(mOpenBatch.oversizedMemory);
+        mOpenBatch.oversizedBuffers.clear();
+        mOpenBatch.oversizedMemory.clear();
+
+        VkCommandBufferBeginInfo beginInfo{};
+        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        Utility::CheckVulkanError(vkBeginCommandBuffer(batch.transferCommandBuffer, &beginInfo),
+                                  "Failed to begin the upload command buffer");
+        RecordTransfer(batch.transferCommandBuffer);
+        vkEndCommandBuffer(batch.transferCommandBuffer);
+
+        VkSubmitInfo submitInfo{};
+        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submitInfo.commandBufferCount = 1;
+        submitInfo.pCommandBuffers = &batch.transferCommandBuffer;
+        // Without a dedicated transfer queue every submit below goes to the graphics queue.
+        std::lock_guard<std::mutex> queueGuard{*mCtx->graphicsQueueMutex};
+        if (!mDedicatedTransferQueue) {
+            Utility::CheckVulkanError(vkQueueSubmit(mTransferQueue, 1, &submitInfo, batch.fence),
+                                      "Failed to submit the upload batch");
+            mSubmitCount++;
+        } else {
+            submitInfo.signalSemaphoreCount = 1;
+            submitInfo.pSignalSemaphores = &batch.ownershipSemaphore;
+            Utility::CheckVulkanError(vkQueueSubmit(mTransferQueue, 1, &submitInfo, VK_NULL_HANDLE),
+                                      "Failed to submit the upload batch");
+
+            Utility::CheckVulkanError(vkBeginCommandBuffer(batch.graphicsCommandBuffer, &beginInfo),
+                                      "Failed to begin the upload ownership command buffer");
+            RecordAcquire(batch.graphicsCommandBuffer);
+            vkEndCommandBuffer(batch.graphicsCommandBuffer);
+
+            // Submitted ahead of the frame on the graphics queue, so the frame is ordered after the acquire.
+            VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+            VkSubmitInfo acquireInfo{};
+            acquireInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+            acquireInfo.commandBufferCount = 1;
+            acquireInfo.pCommandBuffers = &batch.graphicsCommandBuffer;
+            acquireInfo.waitSemaphoreCount = 1;
+            acquireInfo.pWaitSemaphores = &batch.ownershipSemaphore;
+            acquireInfo.pWaitDstStageMask = &waitStage;
+            Utility::CheckVulkanError(vkQueueSubmit(mCtx->graphicsQueue, 1, &acquireInfo, batch.fence),
+                                      "Failed to submit the upload ownership batch");
+            mSubmitCount += 2;
+        }
+        mInFlightBatches.push_back(std::move(batch));
+        mBufferUploads.clear();
+        mImageUploads.clear();
+        mOpenBatch.ticket++;
+    }
+
+    void UploadQueue::RetireBatches(UploadTicket waitTicket) {
+        while (!mInFlightBatches.empty()) {
+            Batch &batch = mInFlightBatches.front();
+            if (batch.ticket <= waitTicket) {
+                vkWaitForFences(mCtx->logicalDevice, 1, &batch.fence, VK_TRUE, UINT64_MAX);
+            } else if (vkGetFenceStatus(mCtx->logicalDevice, batch.fence) != VK_SUCCESS) {
+                break;
+            }
+            vkResetFences(mCtx->logicalDevice, 1, &batch.fence);
+            for (size_t i = 0; i < batch.oversizedBuffers.size(); i++) {
+                Utility::DestroyBuffer(*mCtx, batch.oversizedBuffers[i], batch.oversizedMemory[i]);
+            }
+            batch.oversizedBuffers.clear();
+            batch.oversizedMemory.clear();
+            mLastCompletedTicket = batch.ticket;
+            mStagingRing.Release(batch.stagingEnd);
+            mFreeBatches.push_back(std::move(batch));
+            mInFlightBatches.erase(mInFlightBatches.begin());
+        }
+    }
+
+    void UploadQueue::DestroyBatch(Batch &batch) {
+        vkDestroyFence(mCtx->logicalDevice, batch.fence, nullptr);
+        if (mDedicatedTransferQueue) {
+            vkDestroySemaphore(mCtx->logicalDevice, batch.ownershipSemaphore, nullptr);
+        }
+    }
+
+    UploadTicket UploadQueue::Flush() {
+        std::lock_guard<std::mutex> guard{mMutex};
+        FlushLocked();
+        RetireBatches(0);
+        return mOpenBatch.ticket - 1;
+    }
+
+    bool UploadQueue::IsComplete(UploadTicket ticket) {
+        std::lock_guard<std::mutex> guard{mMutex};
+        RetireBatches(0);
+        return ticket <= mLastCompletedTicket;
+    }
+
+    void UploadQueue::Wait(UploadTicket ticket) {
+        std::lock_guard<std::mutex> guard{mMutex};
+        if (ticket >= mOpenBatch.ticket) {
+            FlushLocked();
+        }
+        RetireBatches(ticket);
+    }
+
+    void UploadQueue::LogStatistics() const {
+        std::lock_guard<std::mutex> guard{mMutex};
+        LOG_INFO("Upload queue : {} uploads in {} submits, {} waits for staging space, {} on a dedicated transfer "
+                 "queue", mUploadCount, mSubmitCount, mStagingStallCount,
+                 mDedicatedTransferQueue ? "running" : "not running");
+    }
+}
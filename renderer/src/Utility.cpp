@@ -4,6 +4,9 @@
 #define STB_IMAGE_IMPLEMENTATION
 
 #include "Utility.h"
+#include "MemoryAllocator.h"
+#include "OneShotCommands.h"
+#include "BlockCompression.h"
 
 namespace rn {
     std::uint32_t Utility::MAX_OBJECTS = 1000;
@@ -23,7 +26,7 @@ namespace rn {
     }
 
     void Utility::CreateBuffer(rn::RendererContext &ctx, VkBuffer &buffer, VkBufferUsageFlags usageFlags,
-                               VkDeviceMemory &bufferMemory, VkMemoryPropertyFlags bufferMemoryFlags,
+                               MemoryAllocation &bufferMemory, VkMemoryPropertyFlags bufferMemoryFlags,
                                VkDeviceSize requiredBufferSize, const std::string &bufferName) {
         VkBufferCreateInfo createBufferInfo{};
         createBufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
@@ -35,67 +38,33 @@ namespace rn {
         CheckVulkanError(vkCreateBuffer(ctx.logicalDevice, &createBufferInfo, nullptr, &buffer),
                          errorMessage.c_str());
 
-        VkMemoryRequirements bufferMemoryRequirements{};
-        vkGetBufferMemoryRequirements(ctx.logicalDevice, buffer, &bufferMemoryRequirements);
+        bufferMemory = ctx.memoryAllocator->AllocateBuffer(buffer, bufferMemoryFlags, bufferName);
+    }
 
-        VkMemoryAllocateInfo allocateInfo{};
-        allocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-        allocateInfo.allocationSize = bufferMemoryRequirements.size;
-        allocateInfo.memoryTypeIndex = FindMemoryIndices(ctx.physicalDevice, bufferMemoryRequirements.memoryTypeBits,
-                                                         bufferMemoryFlags, bufferName);
+    void Utility::DestroyBuffer(rn::RendererContext &ctx, VkBuffer &buffer, MemoryAllocation &bufferMemory) {
+        vkDestroyBuffer(ctx.logicalDevice, buffer, nullptr);
+        ctx.memoryAllocator->Free(bufferMemory);
+        buffer = VK_NULL_HANDLE;
+    }
 
-        CheckVulkanError(vkAllocateMemory(ctx.logicalDevice, &allocateInfo, nullptr, &bufferMemory),
-                         "Failed to allocate the memory for the buffer");
-        vkBindBufferMemory(ctx.logicalDevice, buffer, bufferMemory, 0);
+    void Utility::DestroyImage(rn::RendererContext &ctx, VkImage &image, MemoryAllocation &imageMemory) {
+        vkDestroyImage(ctx.logicalDevice, image, nullptr);
+        ctx.memoryAllocator->Free(imageMemory);
+        image = VK_NULL_HANDLE;
     }
 
     VkCommandBuffer Utility::BeginCommandBuffer(rn::RendererContext ctx) {
-        VkCommandBuffer commandBuffer{};
-        VkCommandBufferAllocateInfo allocateInfo{};
-        allocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-        allocateInfo.commandPool = ctx.commandPool;
-        allocateInfo.commandBufferCount = 1;
-        allocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-
-        CheckVulkanError(vkAllocateCommandBuffers(ctx.logicalDevice, &allocateInfo, &commandBuffer),
-                         "Failed to allocate the command buffer");
-        VkCommandBufferBeginInfo beginInfo{};
-        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-        CheckVulkanError(vkBeginCommandBuffer(commandBuffer, &beginInfo), "Failed to begin the command buffer");
-
-        return commandBuffer;
+        return ctx.oneShotCommands->Begin();
     }
 
     void Utility::SubmitCommandBuffer(rn::RendererContext &ctx, VkCommandBuffer &commandBuffer) {
-        vkEndCommandBuffer(commandBuffer);
-
-        VkSubmitInfo submitInfo{};
-        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-        submitInfo.commandBufferCount = 1;
-        submitInfo.pCommandBuffers = &commandBuffer;
-
-        VkFence submitFence{};
-        VkFenceCreateInfo fenceCreateInfo{};
-        fenceCreateInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-        vkCreateFence(ctx.logicalDevice, &fenceCreateInfo, nullptr, &submitFence);
-
-        vkQueueSubmit(ctx.graphicsQueue, 1, &submitInfo, submitFence);
-        vkWaitForFences(ctx.logicalDevice, 1, &submitFence, VK_TRUE, UINT64_MAX);
-        vkDestroyFence(ctx.logicalDevice, submitFence, nullptr);
-        vkFreeCommandBuffers(ctx.logicalDevice, ctx.commandPool, 1, &commandBuffer);
+        ctx.oneShotCommands->SubmitAndWait(commandBuffer);
+        commandBuffer = VK_NULL_HANDLE;
     }
 
-    void Utility::CopyBuffers(rn::RendererContext &ctx, VkBuffer srcBuffer, VkBuffer dstBuffer,
-                              VkDeviceSize bufferSize) {
-        VkCommandBuffer commandBuffer = BeginCommandBuffer(ctx);
-        VkBufferCopy region{};
-        region.size = bufferSize;
-        region.dstOffset = 0;
-        region.srcOffset = 0;
-
-        vkCmdCopyBuffer(commandBuffer, srcBuffer, dstBuffer, 1, &region);
-        SubmitCommandBuffer(ctx, commandBuffer);
+    void Utility::WaitDeviceIdle(rn::RendererContext &ctx) {
+        std::lock_guard<std::mutex> queueGuard{*ctx.graphicsQueueMutex};
+        vkDeviceWaitIdle(ctx.logicalDevice);
     }
 
     std::uint8_t *Utility::LoadTextureImage(const char *fileName, int &width, int &height, VkDeviceSize &imageSize) {
@@ -110,12 +79,13 @@ namespace rn {
         return imageData;
     }
 
-    VkImage Utility::CreateImage(std::string &&imageName, VkPhysicalDevice physicalDevice, VkDevice logicalDevice,
+    VkImage Utility::CreateImage(std::string &&imageName, rn::RendererContext &ctx,
                                  uint32_t width, uint32_t height,
                                  VkFormat format,
                                  VkImageTiling imageTiling,
                                  VkImageUsageFlags imageUsageFlags, VkMemoryPropertyFlags memoryPropertyFlags,
-                                 VkDeviceMemory &memory, int layers, int flags, VkImageLayout initialLayout) {
+                                 MemoryAllocation &memory, int layers, int flags, VkImageLayout initialLayout,
+                                 std::uint32_t mipLevels) {
         VkImageCreateInfo depthImageCreateInfo{};
         depthImageCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
         depthImageCreateInfo.format = format;
@@ -125,7 +95,7 @@ namespace rn {
         depthImageCreateInfo.initialLayout = initialLayout;
         depthImageCreateInfo.extent.depth = 1;
         depthImageCreateInfo.arrayLayers = layers;
-        depthImageCreateInfo.mipLevels = 1;
+        depthImageCreateInfo.mipLevels = mipLevels;
         depthImageCreateInfo.usage = imageUsageFlags;
         depthImageCreateInfo.imageType = VK_IMAGE_TYPE_2D;
         depthImageCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
@@ -134,24 +104,10 @@ namespace rn {
 
         std::string imageCreationErrorMessage = "Failed to create the Image " + imageName;
         VkImage image{};
-        Utility::CheckVulkanError(vkCreateImage(logicalDevice, &depthImageCreateInfo, nullptr, &image),
+        Utility::CheckVulkanError(vkCreateImage(ctx.logicalDevice, &depthImageCreateInfo, nullptr, &image),
                                   imageCreationErrorMessage.c_str());
 
-        VkMemoryRequirements memoryRequirements{};
-        vkGetImageMemoryRequirements(logicalDevice, image, &memoryRequirements);
-        VkMemoryAllocateInfo memoryAllocateInfo{};
-        memoryAllocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-
-        memoryAllocateInfo.memoryTypeIndex = Utility::FindMemoryIndices(physicalDevice,
-                                                                        memoryRequirements.memoryTypeBits,
-                                                                        memoryPropertyFlags, imageName);
-        memoryAllocateInfo.allocationSize = memoryRequirements.size;
-
-        Utility::CheckVulkanError(vkAllocateMemory(logicalDevice, &memoryAllocateInfo, nullptr, &memory),
-                                  "Failed to allocate memory to Image");
-
-
-        vkBindImageMemory(logicalDevice, image, memory, 0);
+        memory = ctx.memoryAllocator->AllocateImage(image, imageTiling, memoryPropertyFlags, imageName);
         return image;
 
     }
@@ -159,7 +115,7 @@ namespace rn {
     void
     Utility::CreateImageView(VkDevice logicalDevice, VkImage &image, VkFormat format, VkImageView &imageView,
                              VkImageAspectFlags imageAspect, int baseArrayLayer, int layerCount,
-                             VkImageViewType viewType) {
+                             VkImageViewType viewType, std::uint32_t levelCount) {
         VkImageViewCreateInfo imageViewCreateInfo{};
         imageViewCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
         imageViewCreateInfo.format = format;
@@ -172,29 +128,33 @@ namespace rn {
         imageViewCreateInfo.subresourceRange.aspectMask = imageAspect;
         imageViewCreateInfo.subresourceRange.baseMipLevel = 0;
         imageViewCreateInfo.subresourceRange.layerCount = layerCount;
-        imageViewCreateInfo.subresourceRange.levelCount = 1;
+        imageViewCreateInfo.subresourceRange.levelCount = levelCount;
         imageViewCreateInfo.subresourceRange.baseArrayLayer = baseArrayLayer;
 
         Utility::CheckVulkanError(vkCreateImageView(logicalDevice, &imageViewCreateInfo, nullptr, &imageView),
                                   "Failed to create the image View");
     }
 
-    void Utility::CopyBufferToImage(RendererContext &ctx, VkBuffer srcBuffer, VkImage dstImage, uint32_t width,
-                                    uint32_t height, VkImageAspectFlags aspectFlags, int arrayLayer) {
-        VkCommandBuffer commandBuffer = BeginCommandBuffer(ctx);
-        VkBufferImageCopy imageCopy{};
-        imageCopy.imageExtent = {width, height, 1};
-        imageCopy.imageSubresource.aspectMask = aspectFlags;
-        imageCopy.imageSubresource.layerCount = 1;
-        imageCopy.imageSubresource.baseArrayLayer = arrayLayer;
-        imageCopy.imageSubresource.mipLevel = 0;
-        imageCopy.imageOffset = {0, 0};
-        imageCopy.bufferRowLength = 0;
-        imageCopy.bufferOffset = 0;
-        imageCopy.bufferImageHeight = 0;
+    std::uint32_t Utility::GetMipLevelCount(std::uint32_t width, std::uint32_t height) {
+        std::uint32_t levels = 1;
+        std::uint32_t size = std::max(width, height);
+        while (size > 1) {
+            size >>= 1;
+            levels++;
+        }
+        return levels;
+    }
 
-        vkCmdCopyBufferToImage(commandBuffer, srcBuffer, dstImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &imageCopy);
-        SubmitCommandBuffer(ctx, commandBuffer);
+    VkDeviceSize Utility::GetImageLevelSize(VkFormat format, std::uint32_t width, std::uint32_t height,
+                                            std::uint32_t level) {
+        VkDeviceSize levelWidth = std::max(width >> level, 1u);
+        VkDeviceSize levelHeight = std::max(height >> level, 1u);
+        if (BlockCompression::IsBlockCompressed(format)) {
+            // Partial blocks at the right and bottom edge still take a whole block.
+            return ((levelWidth + 3) / 4) * ((levelHeight + 3) / 4) * BlockCompression::GetBlockSize(format);
+        }
+        // Every uncompressed format the renderer uploads is 4 bytes per texel.
+        return levelWidth * levelHeight * 4;
     }
 
     void Utility::TransitionImageLayout(RendererContext ctx, VkImage image, VkImageLayout oldLayout,
@@ -6,18 +6,30 @@
 #include <glm/gtx/string_cast.hpp>
 #include "lights/PointLightShadowMap.h"
 #include "StaticMesh.h"
+#include "UniformRing.h"
+#include "SlotMap.h"
 
 namespace rn {
     PointLightShadowMap::PointLightShadowMap(RendererContext *ctx, rn::PointLightInfo lightInfo) : mCtx{ctx},
                                                                                                    mLightInfo{
                                                                                                            lightInfo},
-                                                                                                   mModelPushConstant{},
                                                                                                    mSampler{} {
-        CreateRenderPass();
+        mUseMultiview = mCtx->multiviewSupported;
+        CreateRenderPass(mRenderPass, 0);
         CreateFrameBuffersImagesAndImageViews();
         CreateDescriptors();
         CreateCommandBufferAndFences();
-        CreatePipeline();
+        CreatePipelineLayout();
+        // The per face path is always created so it can be used when multiview is unavailable.
+        CreatePipeline(mRenderPass, R"(D:\cProjects\SmallVkEngine\Shaders\cubeShadow.ver.spv)", mPipeline);
+        if (mUseMultiview) {
+            // One view per cube face.
+            CreateRenderPass(mMultiviewRenderPass, 0b111111);
+            CreateMultiviewFrameBuffer();
+            CreatePipeline(mMultiviewRenderPass,
+                           R"(D:\cProjects\SmallVkEngine\Shaders\cubeShadowMultiview.ver.spv)",
+                           mMultiviewPipeline);
+        }
         CreateSampler();
     }
 
@@ -26,21 +38,21 @@ namespace rn {
         for (int i = 0; i < 6; i++) {
             vkDestroyFramebuffer(mCtx->logicalDevice, mFrameBuffers[i], nullptr);
             vkDestroyImageView(mCtx->logicalDevice, mShadowRendingImageViews[i], nullptr);
-            vkFreeMemory(mCtx->logicalDevice, mShadowRenderingImageViewsMemory[i], nullptr);
+        }
+        if (mUseMultiview) {
+            vkDestroyFramebuffer(mCtx->logicalDevice, mMultiviewFrameBuffer, nullptr);
+            vkDestroyImageView(mCtx->logicalDevice, mMultiviewColorView, nullptr);
+            vkDestroyImageView(mCtx->logicalDevice, mMultiviewDepthView, nullptr);
+            vkDestroyPipeline(mCtx->logicalDevice, mMultiviewPipeline, nullptr);
+            vkDestroyRenderPass(mCtx->logicalDevice, mMultiviewRenderPass, nullptr);
         }
         vkDestroyImageView(mCtx->logicalDevice, mSamplerImageView, nullptr);
-        vkDestroyImage(mCtx->logicalDevice, mShadowImage, nullptr);
-        vkFreeMemory(mCtx->logicalDevice, mShadowImageMemory, nullptr);
+        Utility::DestroyImage(*mCtx, mShadowImage, mShadowImageMemory);
         vkDestroyImageView(mCtx->logicalDevice, mShadowImageDepthView, nullptr);
-        vkDestroyImage(mCtx->logicalDevice, mShadowImageDepth, nullptr);
-        vkFreeMemory(mCtx->logicalDevice, mShadowImageDepthMemory, nullptr);
+        Utility::DestroyImage(*mCtx, mShadowImageDepth, mShadowImageDepthMemory);
         vkDestroyDescriptorPool(mCtx->logicalDevice, mDescriptorPool, nullptr);
 
         vkDestroySampler(mCtx->logicalDevice, mSampler, nullptr);
-        vkDestroyBuffer(mCtx->logicalDevice, viewProjectionBuffer, nullptr);
-        vkFreeMemory(mCtx->logicalDevice, viewProjectionMemory, nullptr);
-        vkDestroyBuffer(mCtx->logicalDevice, mLightDataBuffer, nullptr);
-        vkFreeMemory(mCtx->logicalDevice, mLightDataMemory, nullptr);
         vkDestroyPipeline(mCtx->logicalDevice, mPipeline, nullptr);
         vkDestroyDescriptorSetLayout(mCtx->logicalDevice, mDescriptorSetLayout, nullptr);
         vkDestroyPipelineLayout(mCtx->logicalDevice, mPipelineLayout, nullptr);
@@ -51,21 +63,19 @@ namespace rn {
     void PointLightShadowMap::CreateFrameBuffersImagesAndImageViews() {
         mFrameBuffers.resize(6);
         mShadowRendingImageViews.resize(6);
-        mShadowRenderingImageViewsMemory.resize(6);
-        mShadowImage = Utility::CreateImage("Point Light Shadow Image", mCtx->physicalDevice, mCtx->logicalDevice,
+        mShadowImage = Utility::CreateImage("Point Light Shadow Image", *mCtx,
                                             SHADOW_MAP_SIZE, SHADOW_MAP_SIZE,
                                             VK_FORMAT_R32_SFLOAT,
                                             VK_IMAGE_TILING_OPTIMAL,
                                             VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
                                             VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
                                             mShadowImageMemory, 6, VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT);
-        mShadowImageDepth = Utility::CreateImage("Point Light Shadow Image View Depth", mCtx->physicalDevice,
-                                                 mCtx->logicalDevice,
+        mShadowImageDepth = Utility::CreateImage("Point Light Shadow Image View Depth", *mCtx,
                                                  SHADOW_MAP_SIZE, SHADOW_MAP_SIZE,
                                                  VK_FORMAT_D32_SFLOAT, VK_IMAGE_TILING_OPTIMAL,
                                                  VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
                                                  VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-                                                 mShadowImageDepthMemory);
+                                                 mShadowImageDepthMemory, mUseMultiview ? 6 : 1);
         Utility::CreateImageView(mCtx->logicalDevice, mShadowImageDepth, VK_FORMAT_D32_SFLOAT, mShadowImageDepthView,
                                  VK_IMAGE_ASPECT_DEPTH_BIT);
 
@@ -93,7 +103,31 @@ namespace rn {
                                  VK_IMAGE_ASPECT_COLOR_BIT, 0, 6, VK_IMAGE_VIEW_TYPE_CUBE);
     }
 
-    void PointLightShadowMap::CreateRenderPass() {
+    void PointLightShadowMap::CreateMultiviewFrameBuffer() {
+        // Multiview renders view i into layer i, so both attachments are viewed as six layer arrays.
+        Utility::CreateImageView(mCtx->logicalDevice, mShadowImage, VK_FORMAT_R32_SFLOAT, mMultiviewColorView,
+                                 VK_IMAGE_ASPECT_COLOR_BIT, 0, 6, VK_IMAGE_VIEW_TYPE_2D_ARRAY);
+        Utility::CreateImageView(mCtx->logicalDevice, mShadowImageDepth, VK_FORMAT_D32_SFLOAT, mMultiviewDepthView,
+                                 VK_IMAGE_ASPECT_DEPTH_BIT, 0, 6, VK_IMAGE_VIEW_TYPE_2D_ARRAY);
+
+        List<VkImageView> attachments{mMultiviewColorView, mMultiviewDepthView};
+        VkFramebufferCreateInfo framebufferCreateInfo{};
+        framebufferCreateInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+        framebufferCreateInfo.height = SHADOW_MAP_SIZE;
+        framebufferCreateInfo.width = SHADOW_MAP_SIZE;
+        framebufferCreateInfo.flags = 0;
+        framebufferCreateInfo.attachmentCount = attachments.size();
+        framebufferCreateInfo.pAttachments = attachments.data();
+        framebufferCreateInfo.renderPass = mMultiviewRenderPass;
+        // Must be one for a multiview render pass, the layers come from the view mask.
+        framebufferCreateInfo.layers = 1;
+
+        Utility::CheckVulkanError(
+                vkCreateFramebuffer(mCtx->logicalDevice, &framebufferCreateInfo, nullptr, &mMultiviewFrameBuffer),
+                "Failed to create the multiview frame buffer for the point lights");
+    }
+
+    void PointLightShadowMap::CreateRenderPass(VkRenderPass &renderPass, std::uint32_t viewMask) {
         VkAttachmentDescription colorAttachmentDescription{};
         colorAttachmentDescription.format = VK_FORMAT_R32_SFLOAT;
         colorAttachmentDescription.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
@@ -128,22 +162,60 @@ namespace rn {
         subpassDescription.pColorAttachments = &colorAttachmentReference;
         subpassDescription.pDepthStencilAttachment = &depthAttachmentRef;
 
+        // The cube image is shared by all frames in flight, wait for the previous frame to finish sampling it
+        VkSubpassDependency dependency{};
+        dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
+        dependency.dstSubpass = 0;
+        dependency.srcStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+        dependency.dstStageMask =
+                VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
+        dependency.srcAccessMask = 0;
+        dependency.dstAccessMask =
+                VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+
         List<VkAttachmentDescription> attachments{colorAttachmentDescription, depthAttachmentDescription};
         VkRenderPassCreateInfo renderPassCreateInfo{};
         renderPassCreateInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
         renderPassCreateInfo.subpassCount = 1;
         renderPassCreateInfo.pSubpasses = &subpassDescription;
+        renderPassCreateInfo.dependencyCount = 1;
+        renderPassCreateInfo.pDependencies = &dependency;
         renderPassCreateInfo.attachmentCount = attachments.size();
         renderPassCreateInfo.pAttachments = attachments.data();
         renderPassCreateInfo.flags = 0;
 
-        Utility::CheckVulkanError(vkCreateRenderPass(mCtx->logicalDevice, &renderPassCreateInfo, nullptr, &mRenderPass),
+        // A non zero view mask broadcasts every draw of the subpass to each view set in the mask.
+        VkRenderPassMultiviewCreateInfoKHR multiviewCreateInfo{};
+        multiviewCreateInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_MULTIVIEW_CREATE_INFO_KHR;
+        multiviewCreateInfo.subpassCount = 1;
+        multiviewCreateInfo.pViewMasks = &viewMask;
+        multiviewCreateInfo.correlationMaskCount = 1;
+        multiviewCreateInfo.pCorrelationMasks = &viewMask;
+        if (viewMask != 0) {
+            renderPassCreateInfo.pNext = &multiviewCreateInfo;
+        }
+
+        Utility::CheckVulkanError(vkCreateRenderPass(mCtx->logicalDevice, &renderPassCreateInfo, nullptr, &renderPass),
                                   "Failed to create the render pass for the point lights");
     }
 
-    void PointLightShadowMap::CreatePipeline() {
-        VkShaderModule vertexShaderModule = Utility::CreateShaderModule(mCtx->logicalDevice,
-                                                                        R"(D:\cProjects\SmallVkEngine\Shaders\cubeShadow.ver.spv)");
+    void PointLightShadowMap::CreatePipelineLayout() {
+        // The models come from the instance buffer of the frame, set 1.
+        std::array<VkDescriptorSetLayout, 2> setLayouts{mDescriptorSetLayout, mCtx->instanceBuffer->GetLayout()};
+
+        VkPipelineLayoutCreateInfo layoutCreateInfo{};
+        layoutCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        layoutCreateInfo.setLayoutCount = setLayouts.size();
+        layoutCreateInfo.pSetLayouts = setLayouts.data();
+
+        Utility::CheckVulkanError(
+                vkCreatePipelineLayout(mCtx->logicalDevice, &layoutCreateInfo, nullptr, &mPipelineLayout),
+                "Failed to create the layout for the shadow pipeline");
+    }
+
+    void PointLightShadowMap::CreatePipeline(VkRenderPass renderPass, const char *vertexShaderFile,
+                                             VkPipeline &pipeline) {
+        VkShaderModule vertexShaderModule = Utility::CreateShaderModule(mCtx->logicalDevice, vertexShaderFile);
         VkShaderModule fragShaderModule = Utility::CreateShaderModule(mCtx->logicalDevice,
                                                                       R"(D:\cProjects\SmallVkEngine\Shaders\cubeShadow.frag.spv)");
 
@@ -175,24 +247,9 @@ namespace rn {
         viewportStateCreateInfo.scissorCount = 1;
         viewportStateCreateInfo.pScissors = &mScissors;   // dynamic but set default
 
-        // vertex input: position only (match your Vertex struct)
-        VkVertexInputBindingDescription bindingDescription{};
-        bindingDescription.binding = 0;
-        bindingDescription.stride = sizeof(Vertex);
-        bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
-
-        VkVertexInputAttributeDescription positionAttribute{};
-        positionAttribute.location = 0;
-        positionAttribute.binding = 0;
-        positionAttribute.format = VK_FORMAT_R32G32B32_SFLOAT;
-        positionAttribute.offset = offsetof(Vertex, pos);
-
-        VkPipelineVertexInputStateCreateInfo vertexInputStateCreateInfo{};
-        vertexInputStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-        vertexInputStateCreateInfo.vertexBindingDescriptionCount = 1;
-        vertexInputStateCreateInfo.pVertexBindingDescriptions = &bindingDescription;
-        vertexInputStateCreateInfo.vertexAttributeDescriptionCount = 1;
-        vertexInputStateCreateInfo.pVertexAttributeDescriptions = &positionAttribute;
+        // vertex input: only the position stream of the geometry arena
+        VertexInputDescription vertexInput = GeometryArena::DescribeVertexInput(VERTEX_ATTRIBUTE_POSITION);
+        VkPipelineVertexInputStateCreateInfo vertexInputStateCreateInfo = vertexInput.GetCreateInfo();
 
         // input assembly
         VkPipelineInputAssemblyStateCreateInfo inputAssemblyStateCreateInfo{};
@@ -247,22 +304,6 @@ namespace rn {
         colorBlendStateCreateInfo.attachmentCount = 1;
         colorBlendStateCreateInfo.pAttachments = &cb;
 
-        // push constants: model matrix
-        mModelPushConstant.size = sizeof(glm::mat4);
-        mModelPushConstant.offset = 0;
-        mModelPushConstant.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
-
-        VkPipelineLayoutCreateInfo layoutCreateInfo{};
-        layoutCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-        layoutCreateInfo.setLayoutCount = 1;
-        layoutCreateInfo.pSetLayouts = &mDescriptorSetLayout;
-        layoutCreateInfo.pushConstantRangeCount = 1;
-        layoutCreateInfo.pPushConstantRanges = &mModelPushConstant;
-
-        Utility::CheckVulkanError(
-                vkCreatePipelineLayout(mCtx->logicalDevice, &layoutCreateInfo, nullptr, &mPipelineLayout),
-                "Failed to create the layout for the shadow pipeline");
-
         // Assemble pipeline create info
         VkGraphicsPipelineCreateInfo pipelineCreateInfo{};
         pipelineCreateInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
@@ -276,12 +317,12 @@ namespace rn {
         pipelineCreateInfo.pDepthStencilState = &depthStencilStateCreateInfo;
         pipelineCreateInfo.pDynamicState = &dynamicState;
         pipelineCreateInfo.layout = mPipelineLayout;
-        pipelineCreateInfo.renderPass = mRenderPass;
+        pipelineCreateInfo.renderPass = renderPass;
         pipelineCreateInfo.subpass = 0;
         pipelineCreateInfo.pColorBlendState = &colorBlendStateCreateInfo;
 
         Utility::CheckVulkanError(vkCreateGraphicsPipelines(mCtx->logicalDevice, VK_NULL_HANDLE, 1, &pipelineCreateInfo,
-                                                            nullptr, &mPipeline),
+                                                            nullptr, &pipeline),
                                   "Failed to create the pipeline for the shadow map");
 
         vkDestroyShaderModule(mCtx->logicalDevice, vertexShaderModule, nullptr);
@@ -289,24 +330,18 @@ namespace rn {
     }
 
     void PointLightShadowMap::CreateDescriptors() {
-        Utility::CreateBuffer(*mCtx, viewProjectionBuffer, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, viewProjectionMemory,
-                              (VK_MEMORY_PROPERTY_HOST_COHERENT_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT),
-                              sizeof(ViewProjection), "Point Light view Projection Buffer");
-        Utility::CreateBuffer(*mCtx, mLightDataBuffer, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, mLightDataMemory,
-                              (VK_MEMORY_PROPERTY_HOST_COHERENT_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT),
-                              sizeof(LightData), "Point Light Data Buffer");
         // Creating the DescriptorSet Layout;
         VkDescriptorSetLayoutBinding viewProjectionBinding{};
         viewProjectionBinding.binding = 0;
         viewProjectionBinding.descriptorCount = 1;
         viewProjectionBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
-        viewProjectionBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        viewProjectionBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
 
         VkDescriptorSetLayoutBinding lightDataBinding{};
         lightDataBinding.binding = 1;
         lightDataBinding.descriptorCount = 1;
         lightDataBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
-        lightDataBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        lightDataBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
 
         List<VkDescriptorSetLayoutBinding> bindings{viewProjectionBinding, lightDataBinding};
         VkDescriptorSetLayoutCreateInfo layoutCreateInfo{};
@@ -319,18 +354,19 @@ namespace rn {
                                                               &mDescriptorSetLayout),
                                   "Failed to create the layout for the view projection in the point lights");
         // Creating the descriptor set pool
+        // One set for the per face path and one for the multiview path.
         VkDescriptorPoolSize viewProjectionPoolSize{};
-        viewProjectionPoolSize.descriptorCount = 1;
-        viewProjectionPoolSize.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        viewProjectionPoolSize.descriptorCount = 2;
+        viewProjectionPoolSize.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
 
         VkDescriptorPoolSize lightDataPoolSize{};
-        lightDataPoolSize.descriptorCount = 1;
-        lightDataPoolSize.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        lightDataPoolSize.descriptorCount = 2;
+        lightDataPoolSize.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
 
         List<VkDescriptorPoolSize> poolSizes{viewProjectionPoolSize, lightDataPoolSize};
         VkDescriptorPoolCreateInfo viewProjectionPoolCreateInfo{};
         viewProjectionPoolCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-        viewProjectionPoolCreateInfo.maxSets = 1;
+        viewProjectionPoolCreateInfo.maxSets = 2;
         viewProjectionPoolCreateInfo.poolSizeCount = poolSizes.size();
         viewProjectionPoolCreateInfo.pPoolSizes = poolSizes.data();
         viewProjectionPoolCreateInfo.flags = 0;
@@ -346,17 +382,18 @@ namespace rn {
         allocateInfo.descriptorSetCount = 1;
 
         vkAllocateDescriptorSets(mCtx->logicalDevice, &allocateInfo, &viewProjectionDescriptorSet);
+        vkAllocateDescriptorSets(mCtx->logicalDevice, &allocateInfo, &mMultiviewDescriptorSet);
 
         // Writing the descriptor set;
         VkDescriptorBufferInfo bufferInfo{};
         bufferInfo.offset = 0;
         bufferInfo.range = sizeof(ViewProjection);
-        bufferInfo.buffer = viewProjectionBuffer;
+        bufferInfo.buffer = mCtx->uniformRing->GetBuffer();
 
         VkWriteDescriptorSet writeInfo{};
         writeInfo.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
         writeInfo.descriptorCount = 1;
-        writeInfo.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        writeInfo.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
         writeInfo.dstArrayElement = 0;
         writeInfo.dstBinding = 0;
         writeInfo.dstSet = viewProjectionDescriptorSet;
@@ -365,30 +402,44 @@ namespace rn {
         VkDescriptorBufferInfo lightDataBufferInfo{};
         lightDataBufferInfo.offset = 0;
         lightDataBufferInfo.range = sizeof(LightData);
-        lightDataBufferInfo.buffer = mLightDataBuffer;
+        lightDataBufferInfo.buffer = mCtx->uniformRing->GetBuffer();
 
         VkWriteDescriptorSet lightDataWriteInfo{};
         lightDataWriteInfo.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
         lightDataWriteInfo.descriptorCount = 1;
-        lightDataWriteInfo.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        lightDataWriteInfo.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
         lightDataWriteInfo.dstArrayElement = 0;
         lightDataWriteInfo.dstBinding = 1;
         lightDataWriteInfo.dstSet = viewProjectionDescriptorSet;
         lightDataWriteInfo.pBufferInfo = &lightDataBufferInfo;
 
-        List<VkWriteDescriptorSet> writes{writeInfo, lightDataWriteInfo};
+        // Same layout, but the multiview vertex shader reads all six face views at once.
+        VkDescriptorBufferInfo cubeBufferInfo = bufferInfo;
+        cubeBufferInfo.range = sizeof(PointLightViewProjection);
+
+        VkWriteDescriptorSet cubeWriteInfo = writeInfo;
+        cubeWriteInfo.dstSet = mMultiviewDescriptorSet;
+        cubeWriteInfo.pBufferInfo = &cubeBufferInfo;
+
+        VkWriteDescriptorSet cubeLightDataWriteInfo = lightDataWriteInfo;
+        cubeLightDataWriteInfo.dstSet = mMultiviewDescriptorSet;
+
+        List<VkWriteDescriptorSet> writes{writeInfo, lightDataWriteInfo, cubeWriteInfo, cubeLightDataWriteInfo};
 
         vkUpdateDescriptorSets(mCtx->logicalDevice, writes.size(), writes.data(), 0, nullptr);
     }
 
-    void PointLightShadowMap::UpdateDescriptorSet(const ViewProjection &viewProjection) {
-        void *data;
-        vkMapMemory(mCtx->logicalDevice, viewProjectionMemory, 0, sizeof(ViewProjection), 0, &data);
-        memcpy(data, &viewProjection, sizeof(ViewProjection));
-        vkUnmapMemory(mCtx->logicalDevice, viewProjectionMemory);
-        vkMapMemory(mCtx->logicalDevice, mLightDataMemory, 0, sizeof(LightData), 0, &data);
-        memcpy(data, &mLightData, sizeof(LightData));
-        vkUnmapMemory(mCtx->logicalDevice, mLightDataMemory);
+    void PointLightShadowMap::UpdateFaceUniforms() {
+        ComputePointLightViewProjection();
+        if (mUseMultiview) {
+            mCubeViewProjectionOffset = mCtx->uniformRing->Push(mViewProjection);
+        } else {
+            for (size_t i = 0; i < mFaceViewProjectionOffsets.size(); i++) {
+                mFaceViewProjectionOffsets[i] = mCtx->uniformRing->Push(
+                        ViewProjection{mViewProjection.projection, mViewProjection.view[i]});
+            }
+        }
+        mLightDataOffset = mCtx->uniformRing->Push(mLightData);
     }
 
     void PointLightShadowMap::CreateCommandBufferAndFences() {
@@ -408,8 +459,91 @@ namespace rn {
 //                "Failed  to create the render shadow scene fence for the point lights");
     }
 
+    std::uint32_t PointLightShadowMap::CollectShadowCasters() {
+        for (List<const StaticMesh *> &meshes: mFaceMeshes) {
+            meshes.clear();
+        }
+        if (mUseMultiview) {
+            // Every draw goes to all six views, so objects can only be skipped when they are out of the light range.
+            for (const StaticMesh *mesh: *mCtx->GetSceneMeshes()) {
+                if (IsInShadowRange(GetWorldBoundingSphere(mesh))) {
+                    mFaceMeshes[0].push_back(mesh);
+                }
+            }
+            return static_cast<std::uint32_t>(mFaceMeshes[0].size());
+        }
+
+        std::uint32_t instanceCount = 0;
+        for (const StaticMesh *mesh: *mCtx->GetSceneMeshes()) {
+            glm::vec4 worldSphere = GetWorldBoundingSphere(mesh);
+            // Culling the light range once, the per face test only needs the world space sphere.
+            if (!IsInShadowRange(worldSphere)) {
+                continue;
+            }
+            for (int i = 0; i < 6; i++) {
+                if (IsVisibleToFace(worldSphere, i)) {
+                    mFaceMeshes[i].push_back(mesh);
+                    instanceCount++;
+                }
+            }
+        }
+        return instanceCount;
+    }
+
     void PointLightShadowMap::BeginPointShadowFrame(VkCommandBuffer commandBuffer) {
-        ComputePointLightViewProjection();
+        if (mUseMultiview) {
+            RecordSinglePassShadowFrame(commandBuffer);
+        } else {
+            RecordPerFaceShadowFrame(commandBuffer);
+        }
+    }
+
+    void PointLightShadowMap::SetViewportAndScissor(VkCommandBuffer commandBuffer) {
+        VkViewport viewport{};
+        viewport.x = 0.0f;
+        viewport.y = 0.0f;
+        viewport.width = (float) SHADOW_MAP_SIZE;
+        viewport.height = (float) SHADOW_MAP_SIZE;
+        viewport.minDepth = 0.0f;
+        viewport.maxDepth = 1.0f;
+
+        VkRect2D scissor{};
+        scissor.offset = {0, 0};
+        scissor.extent = {SHADOW_MAP_SIZE, SHADOW_MAP_SIZE};
+        vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+        vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+        vkCmdSetDepthBias(commandBuffer, 1.25f, 0.0f, 1.75f);
+    }
+
+    void PointLightShadowMap::RecordSinglePassShadowFrame(VkCommandBuffer commandBuffer) {
+        VkRenderPassBeginInfo beginInfo{};
+        beginInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+        beginInfo.renderPass = mMultiviewRenderPass;
+        beginInfo.framebuffer = mMultiviewFrameBuffer;
+        std::array<VkClearValue, 2> clearValue{};
+        clearValue[0].color = {1.0, 1.0, 1.0, 1.0};
+        clearValue[1].depthStencil.depth = 1.0;
+        beginInfo.clearValueCount = clearValue.size();
+        beginInfo.pClearValues = clearValue.data();
+        beginInfo.renderArea.offset = {0, 0};
+        beginInfo.renderArea.extent = {SHADOW_MAP_SIZE,
+                                       SHADOW_MAP_SIZE};
+        vkCmdBeginRenderPass(commandBuffer, &beginInfo, VK_SUBPASS_CONTENTS_INLINE);
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, mMultiviewPipeline);
+        SetViewportAndScissor(commandBuffer);
+
+        std::array<std::uint32_t, 2> dynamicOffsets{mCubeViewProjectionOffset, mLightDataOffset};
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, mPipelineLayout, 0, 1,
+                                &mMultiviewDescriptorSet, dynamicOffsets.size(),
+                                dynamicOffsets.data());
+        BindInstancesAndGeometry(commandBuffer);
+
+        mCtx->instanceBuffer->BuildRuns(mFaceMeshes[0], mInstanceRuns, SHADOW_LOD_BIAS);
+        InstanceBuffer::DrawRuns(commandBuffer, mInstanceRuns);
+        vkCmdEndRenderPass(commandBuffer);
+    }
+
+    void PointLightShadowMap::RecordPerFaceShadowFrame(VkCommandBuffer commandBuffer) {
         for (int i = 0; i < 6; i++) {
             VkRenderPassBeginInfo beginInfo{};
             beginInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
@@ -425,41 +559,63 @@ namespace rn {
                                            SHADOW_MAP_SIZE};
             vkCmdBeginRenderPass(commandBuffer, &beginInfo, VK_SUBPASS_CONTENTS_INLINE);
             vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, mPipeline);
+            SetViewportAndScissor(commandBuffer);
 
-            VkViewport viewport{};
-            viewport.x = 0.0f;
-            viewport.y = 0.0f;
-            viewport.width = (float) SHADOW_MAP_SIZE;
-            viewport.height = (float) SHADOW_MAP_SIZE;
-            viewport.minDepth = 0.0f;
-            viewport.maxDepth = 1.0f;
-
-            VkRect2D scissor{};
-            scissor.offset = {0, 0};
-            scissor.extent = {SHADOW_MAP_SIZE, SHADOW_MAP_SIZE};
-            vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
-            vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
-            vkCmdSetDepthBias(commandBuffer, 1.25f, 0.0f, 1.75f);
-            UpdateDescriptorSet({mViewProjection.projection, mViewProjection.view[i]});
+            std::array<std::uint32_t, 2> dynamicOffsets{mFaceViewProjectionOffsets[i], mLightDataOffset};
             vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, mPipelineLayout, 0, 1,
-                                    &viewProjectionDescriptorSet, 0,
-                                    nullptr);
+                                    &viewProjectionDescriptorSet, dynamicOffsets.size(),
+                                    dynamicOffsets.data());
+            BindInstancesAndGeometry(commandBuffer);
+
+            // Each face writes the instances of its visible objects, the copies of a geometry stay one draw.
+            mCtx->instanceBuffer->BuildRuns(mFaceMeshes[i], mInstanceRuns, SHADOW_LOD_BIAS);
+            InstanceBuffer::DrawRuns(commandBuffer, mInstanceRuns);
+            vkCmdEndRenderPass(commandBuffer);
+        }
+    }
 
-            Map<std::string, StaticMesh *, std::hash<std::string>>::iterator iter = mCtx->GetSceneObjectMap()->begin();
-            while (iter != mCtx->GetSceneObjectMap()->end()) {
+    void PointLightShadowMap::BindInstancesAndGeometry(VkCommandBuffer commandBuffer) {
+        VkDescriptorSet instanceSet = mCtx->instanceBuffer->GetDescriptorSet();
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, mPipelineLayout, 1, 1, &instanceSet,
+                                0, nullptr);
+        // Every mesh lives in the geometry arena, so its vertex buffers are bound once per render pass, the runs
+        // bind the index buffer of their type.
+        mCtx->geometryArena->BindVertexBuffers(commandBuffer, VERTEX_ATTRIBUTE_POSITION);
+    }
 
-                vkCmdPushConstants(commandBuffer, mPipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(glm::mat4),
-                                   &iter->second->GetModelMatrix());
+    glm::vec4 PointLightShadowMap::GetWorldBoundingSphere(const StaticMesh *mesh) {
+        const glm::mat4 &model = mesh->GetModelMatrix();
+        const glm::vec4 &localSphere = mesh->GetBoundingSphere();
+        glm::vec3 center = model * glm::vec4{glm::vec3(localSphere), 1.0f};
+        // Largest axis scale so the sphere still bounds the mesh under non uniform scaling.
+        float scale = std::max({glm::length(glm::vec3(model[0])), glm::length(glm::vec3(model[1])),
+                                glm::length(glm::vec3(model[2]))});
+        return {center, localSphere.w * scale};
+    }
 
-                VkBuffer vertexBuffer = iter->second->GetVertexBuffer();
-                VkDeviceSize offset = {};
-                vkCmdBindVertexBuffers(commandBuffer, 0, 1, &vertexBuffer, &offset);
-                vkCmdBindIndexBuffer(commandBuffer, iter->second->GetIndexBuffer(), offset, VK_INDEX_TYPE_UINT32);
-                vkCmdDrawIndexed(commandBuffer, iter->second->GetStaticMeshIndicesCount(), 1, 0, 0, 0);
-                iter++;
+    bool PointLightShadowMap::IsInShadowRange(const glm::vec4 &worldSphere) const {
+        return glm::length(glm::vec3(worldSphere) - glm::vec3(mLightInfo.position)) - worldSphere.w <
+               mLightData.farPlane;
+    }
+
+    bool PointLightShadowMap::IsVisibleToFace(const glm::vec4 &worldSphere, int face) const {
+        // Faces follow the cube map order +X, -X, +Y, -Y, +Z, -Z.
+        glm::vec3 toCenter = glm::vec3(worldSphere) - glm::vec3(mLightInfo.position);
+        int axis = face / 2;
+        float forward = (face % 2 == 0) ? toCenter[axis] : -toCenter[axis];
+        float radius = worldSphere.w;
+        if (forward + radius < 0.0f || forward - radius > mLightData.farPlane) {
+            return false;
+        }
+        // The side planes of a 90 degree frustum are at 45 degrees, so the sphere is outside of one of them when
+        // its sideways distance exceeds the forward distance by more than radius * sqrt(2).
+        float sideRadius = radius * glm::root_two<float>();
+        for (int other = 0; other < 3; other++) {
+            if (other != axis && std::abs(toCenter[other]) - forward > sideRadius) {
+                return false;
             }
-            vkCmdEndRenderPass(commandBuffer);
         }
+        return true;
     }
 
     void PointLightShadowMap::EndFrame(VkCommandBuffer commandBuffer) {
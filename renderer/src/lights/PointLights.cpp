@@ -4,153 +4,134 @@
 #include "lights/PointLights.h"
 #include "lights/PointLightShadowMap.h"
 #include "StaticMesh.h"
+#include "FrameSubmission.h"
+#include "UniformRing.h"
+#include "JobSystem.h"
+#include "ThreadCommandPools.h"
 
 namespace rn {
     std::uint32_t PointLights::mCurrentLightSizeCount = 0;
     struct PointLightUBO PointLights::mPointLightUBO{};
+    SlotMap<std::uint32_t, PointLights> PointLights::mLightSlots = {};
     RendererContext *PointLights::mCtx = nullptr;
     List<class PointLightShadowMap *> PointLights::mPointLightShadowMaps = {};
     List<VkDescriptorSet> PointLights::mPointLightShadowDescriptorSets = {};
-    List<VkCommandBuffer> PointLights::mShadowCommandBuffer = {};
-    VkFence PointLights::renderShadowSceneFence = {};
+    List<bool> PointLights::mStaleShadowDescriptorSets = {};
     VkSampler  PointLights::mDummyShadowSampler{};
     VkImageView PointLights::mDummyShadowImageview{};
-    List<std::thread> PointLights::mShadowMapThreads{};
 
     PointLights::PointLights(rn::RendererContext *ctx) {
         if (ctx == nullptr) {
             LOG_ERROR("Failed to get the renderer context for the point lights");
             std::exit(EXIT_FAILURE);
         }
-        VkCommandBuffer commandBuffer{};
-        mShadowCommandBuffer = {MAX_POINT_LIGHTS, commandBuffer};
         mCtx = ctx;
         ctx->AddPointLight = &PointLights::AddPointLight;
         ctx->UpdateLightInfoPosition = &PointLights::UpdateLightInfoPosition;
 
-        CreatePointLightBuffers();
         BindPointLightDescriptors();
-        CreateShadowMapSemaphoreAndAllocateCommandbuffer();
+        mShadowCommandPools = new ThreadCommandPools{mCtx, VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+                                                     mCtx->jobSystem->GetSlotCount()};
         CreateDummyShadowBindingContext();
-        BindPointLightShadowDescriptors();
+        AllocatePointLightShadowDescriptors();
+        for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+            WritePointLightShadowDescriptors(i);
+        }
 
     }
 
     PointLights::~PointLights() {
-        for (int i = 0; i < mCtx->swapChainImageCount; i++) {
-            vkDestroyBuffer(mCtx->logicalDevice, mPointLightsBuffer[i], nullptr);
-            vkFreeMemory(mCtx->logicalDevice, mPointLightsMemory[i], nullptr);
-        }
         vkDestroySampler(mCtx->logicalDevice, mDummyShadowSampler, nullptr);
         vkDestroyImageView(mCtx->logicalDevice, mDummyShadowImageview, nullptr);
-        vkDestroyImage(mCtx->logicalDevice, mDummyShadowImage, nullptr);
-        vkFreeMemory(mCtx->logicalDevice, mDummyImageMemory, nullptr);
+        Utility::DestroyImage(*mCtx, mDummyShadowImage, mDummyImageMemory);
 
-        vkDestroyFence(mCtx->logicalDevice, renderShadowSceneFence, nullptr);
-        vkDestroySemaphore(mCtx->logicalDevice, mPointLightShadowMapSemaphore, nullptr);
         for (const PointLightShadowMap *shadowMap: mPointLightShadowMaps) {
             delete shadowMap;
         }
-        for (int i = 0; i < MAX_POINT_LIGHTS; i++) {
-            vkDestroyCommandPool(mCtx->logicalDevice, mThreadedCommandPools[i], nullptr);
-        }
-    }
-
-    void PointLights::CreatePointLightBuffers() {
-        VkDeviceSize bufferSize = sizeof(PointLightUBO);
-        mPointLightsBuffer.resize(mCtx->swapChainImageCount);
-        mPointLightsMemory.resize(mCtx->swapChainImageCount);
-        for (int i = 0; i < mCtx->swapChainImageCount; i++) {
-            Utility::CreateBuffer(*mCtx, mPointLightsBuffer[i], (VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT),
-                                  mPointLightsMemory[i],
-                                  (VK_MEMORY_PROPERTY_HOST_COHERENT_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT),
-                                  bufferSize,
-                                  "Point Lights Buffer");
-        }
+        delete mShadowCommandPools;
     }
 
     void PointLights::BindPointLightDescriptors() {
-        mPointLightDescriptorSets.resize(mCtx->swapChainImageCount);
-        List<VkDescriptorSetLayout> layouts(mCtx->swapChainImageCount, mCtx->pointLightLayout);
-
         VkDescriptorSetAllocateInfo allocateInfo{};
         allocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-        allocateInfo.descriptorSetCount = mCtx->swapChainImageCount;
+        allocateInfo.descriptorSetCount = 1;
         allocateInfo.descriptorPool = mCtx->pointLightDescriptorPool;
-        allocateInfo.pSetLayouts = layouts.data();
+        allocateInfo.pSetLayouts = &mCtx->pointLightLayout;
         Utility::CheckVulkanError(
-                vkAllocateDescriptorSets(mCtx->logicalDevice, &allocateInfo, mPointLightDescriptorSets.data()),
+                vkAllocateDescriptorSets(mCtx->logicalDevice, &allocateInfo, &mPointLightDescriptorSet),
                 "Failed to allocate the descriptor sets for the point lights");
-        for (int i = 0; i < mCtx->swapChainImageCount; i++) {
-            VkDescriptorBufferInfo bufferInfo{};
-            bufferInfo.offset = 0;
-            bufferInfo.range = sizeof(PointLightUBO);
-            bufferInfo.buffer = mPointLightsBuffer[i];
-
-            VkWriteDescriptorSet writeInfo{};
-            writeInfo.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-            writeInfo.dstBinding = 0;
-            writeInfo.dstArrayElement = 0;
-            writeInfo.descriptorCount = 1;
-            writeInfo.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-            writeInfo.dstSet = mPointLightDescriptorSets[i];
-            writeInfo.pBufferInfo = &bufferInfo;
 
-            vkUpdateDescriptorSets(mCtx->logicalDevice, 1, &writeInfo, 0, nullptr);
-        }
+        VkDescriptorBufferInfo bufferInfo{};
+        bufferInfo.offset = 0;
+        bufferInfo.range = sizeof(PointLightUBO);
+        bufferInfo.buffer = mCtx->uniformRing->GetBuffer();
+
+        VkWriteDescriptorSet writeInfo{};
+        writeInfo.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        writeInfo.dstBinding = 0;
+        writeInfo.dstArrayElement = 0;
+        writeInfo.descriptorCount = 1;
+        writeInfo.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+        writeInfo.dstSet = mPointLightDescriptorSet;
+        writeInfo.pBufferInfo = &bufferInfo;
+
+        vkUpdateDescriptorSets(mCtx->logicalDevice, 1, &writeInfo, 0, nullptr);
     }
 
-    void PointLights::BindPointLightShadowDescriptors() {
+    void PointLights::AllocatePointLightShadowDescriptors() {
         vkResetDescriptorPool(mCtx->logicalDevice, mCtx->pointLightShadowPool, 0);
-        mPointLightShadowDescriptorSets.resize(mCtx->swapChainImageCount);
-        List<VkDescriptorSetLayout> layouts(mCtx->swapChainImageCount, mCtx->pointLightShadowLayout);
+        mPointLightShadowDescriptorSets.resize(MAX_FRAMES_IN_FLIGHT);
+        mStaleShadowDescriptorSets.assign(MAX_FRAMES_IN_FLIGHT, false);
+        List<VkDescriptorSetLayout> layouts(MAX_FRAMES_IN_FLIGHT, mCtx->pointLightShadowLayout);
 
         VkDescriptorSetAllocateInfo allocateInfo{};
         allocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-        allocateInfo.descriptorSetCount = mCtx->swapChainImageCount;
+        allocateInfo.descriptorSetCount = MAX_FRAMES_IN_FLIGHT;
         allocateInfo.pSetLayouts = layouts.data();
         allocateInfo.descriptorPool = mCtx->pointLightShadowPool;
 
         vkAllocateDescriptorSets(mCtx->logicalDevice, &allocateInfo, mPointLightShadowDescriptorSets.data());
-        for (int i = 0; i < mCtx->swapChainImageCount; i++) {
-            List<VkDescriptorImageInfo> imageInfos(MAX_POINT_LIGHTS);
-            for (uint32_t j = 0; j < mCurrentLightSizeCount; j++) {
-                imageInfos[j].sampler = mPointLightShadowMaps[j]->GetSampler();
-                imageInfos[j].imageView = mPointLightShadowMaps[j]->GetCubeImageView();
-                imageInfos[j].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-            }
-
-            for (uint32_t j = mCurrentLightSizeCount; j < MAX_POINT_LIGHTS; j++) {
-                // just adding the image view for the first light as this function is called only if at least one light is there
-                imageInfos[j].sampler = mDummyShadowSampler;
-                imageInfos[j].imageView = mDummyShadowImageview;
-                imageInfos[j].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-            }
+    }
 
-            VkWriteDescriptorSet write{};
-            write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-            write.dstSet = mPointLightShadowDescriptorSets[i];
-            write.dstBinding = 0;
-            write.dstArrayElement = 0;
-            write.descriptorCount = MAX_POINT_LIGHTS;
-            write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-            write.pImageInfo = imageInfos.data();
+    void PointLights::WritePointLightShadowDescriptors(size_t frameIndex) {
+        List<VkDescriptorImageInfo> imageInfos(MAX_POINT_LIGHTS);
+        for (uint32_t j = 0; j < mCurrentLightSizeCount; j++) {
+            imageInfos[j].sampler = mPointLightShadowMaps[j]->GetSampler();
+            imageInfos[j].imageView = mPointLightShadowMaps[j]->GetCubeImageView();
+            imageInfos[j].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        }
 
-            vkUpdateDescriptorSets(mCtx->logicalDevice, 1, &write, 0, nullptr);
+        for (uint32_t j = mCurrentLightSizeCount; j < MAX_POINT_LIGHTS; j++) {
+            // just adding the image view for the first light as this function is called only if at least one light is there
+            imageInfos[j].sampler = mDummyShadowSampler;
+            imageInfos[j].imageView = mDummyShadowImageview;
+            imageInfos[j].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
         }
+
+        VkWriteDescriptorSet write{};
+        write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        write.dstSet = mPointLightShadowDescriptorSets[frameIndex];
+        write.dstBinding = 0;
+        write.dstArrayElement = 0;
+        write.descriptorCount = MAX_POINT_LIGHTS;
+        write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        write.pImageInfo = imageInfos.data();
+
+        vkUpdateDescriptorSets(mCtx->logicalDevice, 1, &write, 0, nullptr);
+        mStaleShadowDescriptorSets[frameIndex] = false;
     }
 
-    void PointLights::UpdatePointLightBuffers(size_t currentImageIndex) {
-        void *data;
-        vkMapMemory(mCtx->logicalDevice, mPointLightsMemory[currentImageIndex], 0, sizeof(PointLightUBO), 0, &data);
-        memcpy(data, &mPointLightUBO, sizeof(PointLightUBO));
-        vkUnmapMemory(mCtx->logicalDevice, mPointLightsMemory[currentImageIndex]);
+    void PointLights::UpdatePointLightBuffers() {
+        mPointLightUniformOffset = mCtx->uniformRing->Push(mPointLightUBO);
+        for (size_t i = 0; i < mPointLightShadowMaps.size(); i++) {
+            mPointLightShadowMaps[i]->UpdateLightInfoInShadowMap(mPointLightUBO.infos[i]);
+            mPointLightShadowMaps[i]->UpdateFaceUniforms();
+        }
     }
 
-    std::uint32_t PointLights::AddPointLight(const PointLightInfo &info) {
-        // This will return the index for the light added not the size;
-        if (mCurrentLightSizeCount > MAX_POINT_LIGHTS) {
-            return -1;
+    LightHandle PointLights::AddPointLight(const PointLightInfo &info) {
+        if (mCurrentLightSizeCount >= MAX_POINT_LIGHTS) {
+            return {};
         }
         uint32_t indexToAdd = mCurrentLightSizeCount;
         mPointLightUBO.infos[indexToAdd] = info;
@@ -159,102 +140,68 @@ namespace rn {
 
         PointLightShadowMap *shadowMap = new PointLightShadowMap(mCtx, info);
         mPointLightShadowMaps.push_back(shadowMap);
-        BindPointLightShadowDescriptors();
+        // A frame in flight may still read the shadow descriptor sets, every set is rewritten when its frame begins.
+        mStaleShadowDescriptorSets.assign(MAX_FRAMES_IN_FLIGHT, true);
 
-        return indexToAdd;
+        return mLightSlots.Insert(indexToAdd);
     }
 
-    void PointLights::UpdateLightInfoPosition(const glm::vec4 &position, std::uint32_t lightId) {
-        mPointLightUBO.infos[lightId].position = position;
+    void PointLights::UpdateLightInfoPosition(const glm::vec4 &position, LightHandle light) {
+        const std::uint32_t *lightIndex = mLightSlots.Get(light);
+        if (lightIndex == nullptr) {
+            return;
+        }
+        mPointLightUBO.infos[*lightIndex].position = position;
     }
 
-    void PointLights::RenderPointLightShadowScene() {
-        List<VkCommandBuffer> activeCommandBuffer{};
-        vkWaitForFences(mCtx->logicalDevice, 1, &renderShadowSceneFence, VK_TRUE, UINT64_MAX);
-        vkResetFences(mCtx->logicalDevice, 1, &renderShadowSceneFence);
+    void PointLights::RenderPointLightShadowScene(size_t currentFrameIndex) {
+        // No fence wait here, the frame's in flight fence in Graphics already guarantees that the command buffers
+        // of this frame have finished executing, so the pools can be recycled as a whole.
+        mShadowCommandPools->Reset(currentFrameIndex);
+        // Same guarantee for the shadow descriptor set of this frame, the main pass binds it after this.
+        if (mStaleShadowDescriptorSets[currentFrameIndex]) {
+            WritePointLightShadowDescriptors(currentFrameIndex);
+        }
 
+        // The culling runs first, the instance buffer can only grow while no job allocates from it.
+        mShadowInstanceCounts.resize(mPointLightShadowMaps.size());
+        for (size_t i = 0; i < mPointLightShadowMaps.size(); i++) {
+            mCtx->jobSystem->Submit([this, i](std::uint32_t) -> void {
+                mShadowInstanceCounts[i] = mPointLightShadowMaps[i]->CollectShadowCasters();
+            });
+        }
+        mCtx->jobSystem->Wait();
+        std::uint32_t instanceCount = 0;
+        for (std::uint32_t count: mShadowInstanceCounts) {
+            instanceCount += count;
+        }
+        mCtx->instanceBuffer->Reserve(instanceCount);
 
-        for (int i = 0; i < mPointLightShadowMaps.size(); i++) {
-            mShadowMapThreads.emplace_back([&, i]() -> void {
-                vkResetCommandBuffer(mShadowCommandBuffer[i], 0);
+        mRecordedShadowCommandBuffers.resize(mPointLightShadowMaps.size());
+        for (size_t i = 0; i < mPointLightShadowMaps.size(); i++) {
+            mCtx->jobSystem->Submit([this, i, currentFrameIndex](std::uint32_t slot) -> void {
+                VkCommandBuffer commandBuffer = mShadowCommandPools->Acquire(currentFrameIndex, slot);
                 VkCommandBufferBeginInfo commandBufferBeginInfo{};
                 commandBufferBeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
                 commandBufferBeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
 
-                vkBeginCommandBuffer(mShadowCommandBuffer[i], &commandBufferBeginInfo);
-                mPointLightShadowMaps[i]->UpdateLightInfoInShadowMap(mPointLightUBO.infos[i]);
-                mPointLightShadowMaps[i]->BeginPointShadowFrame(mShadowCommandBuffer[i]);
-                mPointLightShadowMaps[i]->EndFrame(mShadowCommandBuffer[i]);
-                vkEndCommandBuffer(mShadowCommandBuffer[i]);
-                {
-                    std::lock_guard<std::mutex> lockGuard{mutex_};
-                    activeCommandBuffer.emplace_back(mShadowCommandBuffer[i]);
-                }
+                vkBeginCommandBuffer(commandBuffer, &commandBufferBeginInfo);
+                mPointLightShadowMaps[i]->BeginPointShadowFrame(commandBuffer);
+                mPointLightShadowMaps[i]->EndFrame(commandBuffer);
+                vkEndCommandBuffer(commandBuffer);
+                // Every job owns its own entry, so the submission order stays the light order.
+                mRecordedShadowCommandBuffers[i] = commandBuffer;
             });
         }
+        mCtx->jobSystem->Wait();
 
-        for (auto &thread: mShadowMapThreads) {
-            if (thread.joinable()) {
-                thread.join();
-            }
-        }
-
-        VkSubmitInfo submitInfo{};
-        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-        submitInfo.signalSemaphoreCount = 1;
-        submitInfo.pSignalSemaphores = &mPointLightShadowMapSemaphore;
-        submitInfo.commandBufferCount = activeCommandBuffer.size();
-        submitInfo.pCommandBuffers = activeCommandBuffer.data();
-
-        vkQueueSubmit(mCtx->graphicsQueue, 1, &submitInfo, renderShadowSceneFence);
-
-    }
-
-    void PointLights::CreateShadowMapSemaphoreAndAllocateCommandbuffer() {
-        VkSemaphoreCreateInfo semaphoreCreateInfo{};
-        semaphoreCreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+        // Each shadow map ends with a barrier to the fragment shader, so no semaphore is needed before the main pass.
+        mCtx->frameSubmission->AddCommandBuffers(mRecordedShadowCommandBuffers);
 
-        Utility::CheckVulkanError(
-                vkCreateSemaphore(mCtx->logicalDevice, &semaphoreCreateInfo, nullptr, &mPointLightShadowMapSemaphore),
-                "Failed to create the semaphore for the point light shadows");
-        VkFenceCreateInfo fenceCreateInfo{};
-        fenceCreateInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-        fenceCreateInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
-        Utility::CheckVulkanError(
-                vkCreateFence(mCtx->logicalDevice, &fenceCreateInfo, nullptr, &renderShadowSceneFence),
-                "Failed  to create the render shadow scene fence for the point lights");
-
-        VkCommandPool pool{};
-        mThreadedCommandPools = {MAX_POINT_LIGHTS, pool};
-        // Creating the command Pool For Each Thread;
-        VkCommandPoolCreateInfo commandPoolCreateInfo{};
-        commandPoolCreateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
-        commandPoolCreateInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
-        commandPoolCreateInfo.queueFamilyIndex = mCtx->graphicsQueueIndex;
-        for (int i = 0; i < MAX_POINT_LIGHTS; i++) {
-            Utility::CheckVulkanError(
-                    vkCreateCommandPool(mCtx->logicalDevice, &commandPoolCreateInfo, nullptr,
-                                        &mThreadedCommandPools[i]),
-                    "Failed to create the threaded command pool for point light shadows");
-        }
-
-        // Allocating the command buffer;
-
-        for (int i = 0; i < MAX_POINT_LIGHTS; i++) {
-            VkCommandBufferAllocateInfo allocateInfo{};
-            allocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-            allocateInfo.commandBufferCount = 1;
-            allocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-            allocateInfo.commandPool = mThreadedCommandPools[i];
-
-            Utility::CheckVulkanError(
-                    vkAllocateCommandBuffers(mCtx->logicalDevice, &allocateInfo, &mShadowCommandBuffer[i]),
-                    "Failed to allocate the command buffer for the point light shadows");
-        }
     }
 
     void PointLights::CreateDummyShadowBindingContext() {
-        mDummyShadowImage = Utility::CreateImage("Point Light Shadow Image", mCtx->physicalDevice, mCtx->logicalDevice,
+        mDummyShadowImage = Utility::CreateImage("Point Light Shadow Image", *mCtx,
                                                  SHADOW_MAP_SIZE, SHADOW_MAP_SIZE,
                                                  VK_FORMAT_R32_SFLOAT,
                                                  VK_IMAGE_TILING_OPTIMAL,
@@ -4,16 +4,13 @@
 #include "lights/ShadowMap.h"
 #include "lights/OmniDirectionalLight.h"
 #include "StaticMesh.h"
+#include "FrameSubmission.h"
+#include "UniformRing.h"
 
 namespace rn {
     ShadowMap::ShadowMap(rn::RendererContext *ctx, rn::OmniDirectionalLight *light, int width, int height,
-                         Map<std::string, StaticMesh *, std::hash<std::string>> *objectMap) : mCtx{ctx},
-                                                                                              mDirectionalLight{
-                                                                                                      light},
-                                                                                              mWidth{width},
-                                                                                              mHeight{height},
-                                                                                              mObjectMap(
-                                                                                                      objectMap) {
+                         MeshRegistry *meshes) : mCtx{ctx}, mDirectionalLight{light}, mWidth{width},
+                                                 mHeight{height}, mMeshes(meshes) {
 
     }
 
@@ -30,15 +27,11 @@ namespace rn {
     }
 
     ShadowMap::~ShadowMap() {
-        vkDestroySemaphore(mCtx->logicalDevice, mShadowMapSemaphore, nullptr);
         vkDestroySemaphore(mCtx->logicalDevice, mGetNextImageSemaphore, nullptr);
         vkDestroyFence(mCtx->logicalDevice, mPresentationFinishFence, nullptr);
         vkDestroyFramebuffer(mCtx->logicalDevice, mShadowFrameBuffer, nullptr);
-        vkDestroyBuffer(mCtx->logicalDevice, mViewProjectionBuffer, nullptr);
-        vkFreeMemory(mCtx->logicalDevice, mViewProjectionMemory, nullptr);
         vkDestroyImageView(mCtx->logicalDevice, mSceneImageview, nullptr);
-        vkDestroyImage(mCtx->logicalDevice, mSceneImage, nullptr);
-        vkFreeMemory(mCtx->logicalDevice, mSceneImageMemory, nullptr);
+        Utility::DestroyImage(*mCtx, mSceneImage, mSceneImageMemory);
         vkDestroySampler(mCtx->logicalDevice, mShadowSampler, nullptr);
         vkDestroyDescriptorSetLayout(mCtx->logicalDevice, mShadowDescriptorLayout, nullptr);
         vkDestroyDescriptorPool(mCtx->logicalDevice, mShadowDescriptorPool, nullptr);
@@ -81,24 +74,9 @@ namespace rn {
         viewportStateCreateInfo.scissorCount = 1;
         viewportStateCreateInfo.pScissors = &mScissors;   // dynamic but set default
 
-        // vertex input: position only (match your Vertex struct)
-        VkVertexInputBindingDescription bindingDescription{};
-        bindingDescription.binding = 0;
-        bindingDescription.stride = sizeof(Vertex);
-        bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
-
-        VkVertexInputAttributeDescription positionAttribute{};
-        positionAttribute.location = 0;
-        positionAttribute.binding = 0;
-        positionAttribute.format = VK_FORMAT_R32G32B32_SFLOAT;
-        positionAttribute.offset = offsetof(Vertex, pos);
-
-        VkPipelineVertexInputStateCreateInfo vertexInputStateCreateInfo{};
-        vertexInputStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-        vertexInputStateCreateInfo.vertexBindingDescriptionCount = 1;
-        vertexInputStateCreateInfo.pVertexBindingDescriptions = &bindingDescription;
-        vertexInputStateCreateInfo.vertexAttributeDescriptionCount = 1;
-        vertexInputStateCreateInfo.pVertexAttributeDescriptions = &positionAttribute;
+        // vertex input: only the position stream of the geometry arena
+        VertexInputDescription vertexInput = GeometryArena::DescribeVertexInput(VERTEX_ATTRIBUTE_POSITION);
+        VkPipelineVertexInputStateCreateInfo vertexInputStateCreateInfo = vertexInput.GetCreateInfo();
 
         // input assembly
         VkPipelineInputAssemblyStateCreateInfo inputAssemblyStateCreateInfo{};
@@ -158,17 +136,13 @@ namespace rn {
         // descriptor set layout must be created before layout
         CreateDescriptorSetLayout();
 
-        // push constants: model matrix
-        mModelPushConstant.size = sizeof(glm::mat4);
-        mModelPushConstant.offset = 0;
-        mModelPushConstant.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+        // The models come from the instance buffer of the frame, set 1.
+        std::array<VkDescriptorSetLayout, 2> setLayouts{mShadowDescriptorLayout, mCtx->instanceBuffer->GetLayout()};
 
         VkPipelineLayoutCreateInfo layoutCreateInfo{};
         layoutCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-        layoutCreateInfo.setLayoutCount = 1;
-        layoutCreateInfo.pSetLayouts = &mShadowDescriptorLayout;
-        layoutCreateInfo.pushConstantRangeCount = 1;
-        layoutCreateInfo.pPushConstantRanges = &mModelPushConstant;
+        layoutCreateInfo.setLayoutCount = setLayouts.size();
+        layoutCreateInfo.pSetLayouts = setLayouts.data();
 
         Utility::CheckVulkanError(
                 vkCreatePipelineLayout(mCtx->logicalDevice, &layoutCreateInfo, nullptr, &mShadowPipelineLayout),
@@ -236,6 +210,24 @@ namespace rn {
 //        subpassDescription.colorAttachmentCount = 1;
         subpassDescription.pDepthStencilAttachment = &shadowImageRef;
 
+        // The shadow image is shared by all frames in flight, wait for the previous frame to finish sampling it
+        List<VkSubpassDependency> dependencies(2);
+        dependencies[0].srcSubpass = VK_SUBPASS_EXTERNAL;
+        dependencies[0].dstSubpass = 0;
+        dependencies[0].srcStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+        dependencies[0].dstStageMask =
+                VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+        dependencies[0].srcAccessMask = 0;
+        dependencies[0].dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+
+        // The main pass is in the same submission, so the depth writes are made visible to its fragment shader here
+        dependencies[1].srcSubpass = 0;
+        dependencies[1].dstSubpass = VK_SUBPASS_EXTERNAL;
+        dependencies[1].srcStageMask = VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+        dependencies[1].dstStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+        dependencies[1].srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+        dependencies[1].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
         List<VkAttachmentDescription> attachments{shadowImageDescription};
         VkRenderPassCreateInfo renderPassCreateInfo{};
         renderPassCreateInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
@@ -243,6 +235,8 @@ namespace rn {
         renderPassCreateInfo.pAttachments = attachments.data();
         renderPassCreateInfo.subpassCount = 1;
         renderPassCreateInfo.pSubpasses = &subpassDescription;
+        renderPassCreateInfo.dependencyCount = dependencies.size();
+        renderPassCreateInfo.pDependencies = dependencies.data();
 
         Utility::CheckVulkanError(
                 vkCreateRenderPass(mCtx->logicalDevice, &renderPassCreateInfo, nullptr, &mShadowRenderPass),
@@ -250,7 +244,7 @@ namespace rn {
     }
 
     void ShadowMap::CreateFrameBuffers() {
-        mSceneImage = Utility::CreateImage("Shadow Map Image", mCtx->physicalDevice, mCtx->logicalDevice,
+        mSceneImage = Utility::CreateImage("Shadow Map Image", *mCtx,
                                            SHADOW_MAP_SIZE,
                                            SHADOW_MAP_SIZE,
                                            VK_FORMAT_D32_SFLOAT, VK_IMAGE_TILING_OPTIMAL,
@@ -279,7 +273,7 @@ namespace rn {
     void ShadowMap::CreateDebugDisplayFrameBuffers() {
         mShadowDebugFrameBuffers.resize(mCtx->swapChainImageCount);
 
-        mSceneImage = Utility::CreateImage("Shadow Map Image", mCtx->physicalDevice, mCtx->logicalDevice,
+        mSceneImage = Utility::CreateImage("Shadow Map Image", *mCtx,
                                            SHADOW_MAP_SIZE,
                                            SHADOW_MAP_SIZE,
                                            VK_FORMAT_D32_SFLOAT, VK_IMAGE_TILING_OPTIMAL,
@@ -313,7 +307,7 @@ namespace rn {
     void ShadowMap::CreateDescriptorSetLayout() {
         VkDescriptorSetLayoutBinding viewProjectionBinding{};
         viewProjectionBinding.binding = 0;
-        viewProjectionBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        viewProjectionBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
         viewProjectionBinding.descriptorCount = 1;
         viewProjectionBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
         viewProjectionBinding.pImmutableSamplers = nullptr;
@@ -342,7 +336,7 @@ namespace rn {
         // Creating the descriptor set pool;
         VkDescriptorPoolSize viewProjectionPoolSize{};
         viewProjectionPoolSize.descriptorCount = 1;
-        viewProjectionPoolSize.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        viewProjectionPoolSize.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
 
 //        VkDescriptorPoolSize samplerPoolSize{};
 //        samplerPoolSize.descriptorCount = 1;
@@ -373,10 +367,12 @@ namespace rn {
         VkCommandBufferAllocateInfo allocateInfo{};
         allocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
         allocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-        allocateInfo.commandBufferCount = 1;
+        allocateInfo.commandBufferCount = MAX_FRAMES_IN_FLIGHT;
         allocateInfo.commandPool = mCtx->commandPool;
-        Utility::CheckVulkanError(vkAllocateCommandBuffers(mCtx->logicalDevice, &allocateInfo, &mShadowCommandBuffer),
-                                  "Failed to allocate the command Buffer for the shadow Maps");
+        mShadowCommandBuffers.resize(MAX_FRAMES_IN_FLIGHT);
+        Utility::CheckVulkanError(
+                vkAllocateCommandBuffers(mCtx->logicalDevice, &allocateInfo, mShadowCommandBuffers.data()),
+                "Failed to allocate the command Buffer for the shadow Maps");
 
     }
 
@@ -384,9 +380,6 @@ namespace rn {
         VkSemaphoreCreateInfo semaphoreCreateInfo{};
         semaphoreCreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
 
-        Utility::CheckVulkanError(
-                vkCreateSemaphore(mCtx->logicalDevice, &semaphoreCreateInfo, nullptr, &mShadowMapSemaphore),
-                "Failed to create the semaphore for the shadow map");
         vkCreateSemaphore(mCtx->logicalDevice, &semaphoreCreateInfo, nullptr, &mGetNextImageSemaphore);
         VkFenceCreateInfo fenceCreateInfo{};
         fenceCreateInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
@@ -394,16 +387,17 @@ namespace rn {
         vkCreateFence(mCtx->logicalDevice, &fenceCreateInfo, nullptr, &mPresentationFinishFence);
     }
 
-    void ShadowMap::BeginShadowFrame() {
+    void ShadowMap::BeginShadowFrame(size_t currentFrameIndex) {
 //        vkWaitForFences(mCtx->logicalDevice, 1, &mPresentationFinishFence, true, UINT64_MAX);
 //        vkResetFences(mCtx->logicalDevice, 1, &mPresentationFinishFence);
 //        vkAcquireNextImageKHR(mCtx->logicalDevice, mCtx->swapchain, UINT64_MAX, mGetNextImageSemaphore, nullptr,
 //                              &mCurrentImageIndex);
 
-        vkResetCommandBuffer(mShadowCommandBuffer, 0);
+        VkCommandBuffer commandBuffer = mShadowCommandBuffers[currentFrameIndex];
+        vkResetCommandBuffer(commandBuffer, 0);
         VkCommandBufferBeginInfo beginInfo{};
         beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-        vkBeginCommandBuffer(mShadowCommandBuffer, &beginInfo);
+        vkBeginCommandBuffer(commandBuffer, &beginInfo);
 
         VkRenderPassBeginInfo renderPassBeginInfo{};
         renderPassBeginInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
@@ -417,8 +411,8 @@ namespace rn {
         renderPassBeginInfo.pClearValues = clearValue.data();
         renderPassBeginInfo.clearValueCount = clearValue.size();
         renderPassBeginInfo.renderPass = mShadowRenderPass;
-        vkCmdBeginRenderPass(mShadowCommandBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
-        vkCmdBindPipeline(mShadowCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, mShadowPipeline);
+        vkCmdBeginRenderPass(commandBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, mShadowPipeline);
 
         VkViewport viewport{};
         viewport.x = 0.0f;
@@ -432,42 +426,35 @@ namespace rn {
         scissor.offset = {0, 0};
         scissor.extent = {SHADOW_MAP_SIZE, SHADOW_MAP_SIZE};
 
-        vkCmdSetViewport(mShadowCommandBuffer, 0, 1, &viewport);
-        vkCmdSetScissor(mShadowCommandBuffer, 0, 1, &scissor);
-        vkCmdSetDepthBias(mShadowCommandBuffer, 1.25f, 0.0f, 1.75f);
-
-        // Create The Draw Call
-        Map<std::string, StaticMesh *, std::hash<std::string>>::iterator iter = mObjectMap->begin();
-        while (iter != mObjectMap->end()) {
-//            for (Vertex &vert: (*iter).second->GetVertexList()) {
-//                glm::vec4 gl_pos = mDirectionalLight->GetLightViewProjection().projection *
-//                                   mDirectionalLight->GetLightViewProjection().view * iter->second->GetModelMatrix() *
-//                                   glm::vec4{vert.pos, 1};
-//                glm::vec3 ndc = glm::vec3(gl_pos) / gl_pos.w;
-//                LOG_INFO("NDC X {}", ndc.x);
-//
-//            }
-            VkBuffer vertBuffer = iter->second->GetVertexBuffer();
-            VkBuffer indexBuffer = iter->second->GetIndexBuffer();
-
-            VkDeviceSize offset = {0};
-            vkCmdBindVertexBuffers(mShadowCommandBuffer, 0, 1, &vertBuffer, &offset);
-            vkCmdBindIndexBuffer(mShadowCommandBuffer, indexBuffer, 0, VK_INDEX_TYPE_UINT32);
-            UpdateViewProjectionMatrix(mDirectionalLight->GetLightViewProjection());
-            vkCmdPushConstants(mShadowCommandBuffer, mShadowPipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0,
-                               sizeof(glm::mat4), &(iter->second->GetModelMatrix()));
-            vkCmdBindDescriptorSets(mShadowCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, mShadowPipelineLayout, 0, 1,
-                                    &mShadowDescriptorSet, 0,
-                                    nullptr);
-            vkCmdDrawIndexed(mShadowCommandBuffer, iter->second->GetStaticMeshIndicesCount(), 1, 0, 0, 0);
-            iter++;
+        vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+        vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+        vkCmdSetDepthBias(commandBuffer, 1.25f, 0.0f, 1.75f);
+        // The light view projection is the same for every object, the models come from the instance buffer.
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, mShadowPipelineLayout, 0, 1,
+                                &mShadowDescriptorSet, 1,
+                                &mViewProjectionOffset);
+
+        // Create The Draw Calls, one instanced draw per geometry.
+        if (mMeshes->Empty()) {
+            return;
         }
-
-
+        mInstanceMeshes.assign(mMeshes->begin(), mMeshes->end());
+        // Recorded on the render thread before any job of the frame, so the buffer can grow here.
+        mCtx->instanceBuffer->Reserve(static_cast<std::uint32_t>(mInstanceMeshes.size()));
+        mCtx->instanceBuffer->BuildRuns(mInstanceMeshes, mInstanceRuns, SHADOW_LOD_BIAS);
+        VkDescriptorSet instanceSet = mCtx->instanceBuffer->GetDescriptorSet();
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, mShadowPipelineLayout, 1, 1,
+                                &instanceSet, 0, nullptr);
+
+        // Every mesh lives in the geometry arena, so its vertex buffers are bound once, the runs bind the index
+        // buffer of their type.
+        mCtx->geometryArena->BindVertexBuffers(commandBuffer, VERTEX_ATTRIBUTE_POSITION);
+        InstanceBuffer::DrawRuns(commandBuffer, mInstanceRuns);
     }
 
-    void ShadowMap::EndShadowFrame() {
-        vkCmdEndRenderPass(mShadowCommandBuffer);
+    void ShadowMap::EndShadowFrame(size_t currentFrameIndex) {
+        VkCommandBuffer commandBuffer = mShadowCommandBuffers[currentFrameIndex];
+        vkCmdEndRenderPass(commandBuffer);
         //  Updating the image layout
 //        VkImageMemoryBarrier barrier{};
 //        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
@@ -490,22 +477,10 @@ namespace rn {
 //                1, &barrier
 //        );
 
-        vkEndCommandBuffer(mShadowCommandBuffer);
-
-        // Setting the command buffer to the graphics queue;
-        //VkPipelineStageFlags stageFlags = VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
-        VkPipelineStageFlags stageFlags = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-        VkSubmitInfo submitInfo{};
-        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-        submitInfo.commandBufferCount = 1;
-        submitInfo.pCommandBuffers = &mShadowCommandBuffer;
-//        submitInfo.waitSemaphoreCount = 1;
-//        submitInfo.pWaitSemaphores = &mGetNextImageSemaphore;
-        submitInfo.signalSemaphoreCount = 1;
-        submitInfo.pSignalSemaphores = &mShadowMapSemaphore;
-        submitInfo.pWaitDstStageMask = &stageFlags;
+        vkEndCommandBuffer(commandBuffer);
 
-        vkQueueSubmit(mCtx->graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE);
+        // Submitted by Graphics together with the rest of the frame, ahead of the main pass;
+        mCtx->frameSubmission->AddCommandBuffer(commandBuffer);
 
 
 //        VkPresentInfoKHR presentInfoKhr{};
@@ -523,19 +498,16 @@ namespace rn {
     }
 
     void ShadowMap::WriteViewProjectionDescriptor() {
-        std::string bufferName = "Shadow Buffer name";
-        Utility::CreateBuffer(*mCtx, mViewProjectionBuffer, (VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT), mViewProjectionMemory,
-                              (VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT),
-                              sizeof(ViewProjection), bufferName);
+        // The set points into the uniform ring, the actual matrix is selected with the dynamic offset at bind time
         VkDescriptorBufferInfo bufferInfo{};
         bufferInfo.offset = 0;
         bufferInfo.range = sizeof(ViewProjection);
-        bufferInfo.buffer = mViewProjectionBuffer;
+        bufferInfo.buffer = mCtx->uniformRing->GetBuffer();
 
         VkWriteDescriptorSet writeSet{};
         writeSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
         writeSet.descriptorCount = 1;
-        writeSet.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        writeSet.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
         writeSet.dstSet = mShadowDescriptorSet;
         writeSet.dstBinding = 0;
         writeSet.pBufferInfo = &bufferInfo;
@@ -544,11 +516,7 @@ namespace rn {
     }
 
     void ShadowMap::UpdateViewProjectionMatrix(const ViewProjection &viewProjection) {
-        void *data;
-        vkMapMemory(mCtx->logicalDevice, mViewProjectionMemory, 0, sizeof(ViewProjection), 0, &data);
-        memcpy(data, &viewProjection, sizeof(ViewProjection));
-        vkUnmapMemory(mCtx->logicalDevice, mViewProjectionMemory);
-
+        mViewProjectionOffset = mCtx->uniformRing->Push(viewProjection);
     }
 
     void ShadowMap::CreateSampler() {
@@ -588,8 +556,9 @@ namespace rn {
     }
 
     void ShadowMap::CreateDebugTransitions() {
+        VkCommandBuffer commandBuffer = mShadowCommandBuffers[0];
         VkCommandBufferBeginInfo beginInfo{};
-        vkBeginCommandBuffer(mShadowCommandBuffer, &beginInfo);
+        vkBeginCommandBuffer(commandBuffer, &beginInfo);
 
         VkImageMemoryBarrier imageMemoryBarrier{};
         imageMemoryBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
@@ -606,7 +575,7 @@ namespace rn {
         imageMemoryBarrier.subresourceRange.baseArrayLayer = 0;
         imageMemoryBarrier.subresourceRange.levelCount = 1;
 
-        vkCmdPipelineBarrier(mShadowCommandBuffer, VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
                              VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0,
                              0, nullptr, 0, nullptr,
                              1, &imageMemoryBarrier);
@@ -621,26 +590,27 @@ namespace rn {
         region.imageOffset = {0, 0, 0};
         region.imageExtent = {mCtx->windowExtents.width, mCtx->windowExtents.height, 1};
 
-        vkCmdCopyImageToBuffer(mShadowCommandBuffer,
+        vkCmdCopyImageToBuffer(commandBuffer,
                                mSceneImage,
                                VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
                                mDebugBuffer,
                                1, &region);
-        vkEndCommandBuffer(mShadowCommandBuffer);
+        vkEndCommandBuffer(commandBuffer);
         VkSubmitInfo submitInfo{};
         submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
         submitInfo.commandBufferCount = 1;
-        submitInfo.pCommandBuffers = &mShadowCommandBuffer;
+        submitInfo.pCommandBuffers = &commandBuffer;
 
-        vkQueueSubmit(mCtx->graphicsQueue, 1, &submitInfo, nullptr);
-        vkQueueWaitIdle(mCtx->graphicsQueue);
+        {
+            std::lock_guard<std::mutex> queueGuard{*mCtx->graphicsQueueMutex};
+            vkQueueSubmit(mCtx->graphicsQueue, 1, &submitInfo, nullptr);
+            vkQueueWaitIdle(mCtx->graphicsQueue);
+        }
         WriteDebugBufferToImage();
     }
 
     void ShadowMap::WriteDebugBufferToImage() {
-        void *data;
-        vkMapMemory(mCtx->logicalDevice, mDebugBufferMemory, 0, mWidth * mHeight * sizeof(float), 0, &data);
-        float *depthValues = reinterpret_cast<float *>(data);
+        float *depthValues = reinterpret_cast<float *>(mDebugBufferMemory.mappedData);
 
         for (uint32_t y = 0; y < mHeight; y++) {
             for (uint32_t x = 0; x < mWidth; x++) {
@@ -652,14 +622,11 @@ namespace rn {
             }
             printf("\n");
         }
-
-        vkUnmapMemory(mCtx->logicalDevice, mDebugBufferMemory);
     }
 
     void ShadowMap::ReCreateResourcesForWindowResize() {
         vkDestroyImageView(mCtx->logicalDevice, mSceneImageview, nullptr);
-        vkDestroyImage(mCtx->logicalDevice, mSceneImage, nullptr);
-        vkFreeMemory(mCtx->logicalDevice, mSceneImageMemory, nullptr);
+        Utility::DestroyImage(*mCtx, mSceneImage, mSceneImageMemory);
         vkDestroySampler(mCtx->logicalDevice, mShadowSampler, nullptr);
         vkDestroyFramebuffer(mCtx->logicalDevice, mShadowFrameBuffer, nullptr);
         CreateFrameBuffers();
@@ -0,0 +1,88 @@
+//
+// Created by ghima on 22-10-2025.
+//
+#include "Utility.h"
+#include "BlockCompression.h"
+#include "CookedTexture.h"
+#include "stb_image_resize2.h"
+
+// Offline texture cooker, writes the mip chain of an image block compressed into a cooked texture file that the
+// renderer uploads without decoding anything.
+// Usage : TextureCooker <bc1|bc3|bc5|bc7|rgba8> <source image> [cooked file]
+// bc1 is opaque color, bc3 color with alpha, bc5 two channel data like normal maps and bc7 high quality color.
+int main(int argc, char **argv) {
+    if (argc < 3) {
+        LOG_ERROR("Usage : TextureCooker <bc1|bc3|bc5|bc7|rgba8> <source image> [cooked file]");
+        return EXIT_FAILURE;
+    }
+    const rn::Map<std::string, VkFormat, std::hash<std::string>> formats = {
+            {"bc1",   VK_FORMAT_BC1_RGB_SRGB_BLOCK},
+            {"bc3",   VK_FORMAT_BC3_SRGB_BLOCK},
+            {"bc5",   VK_FORMAT_BC5_UNORM_BLOCK},
+            {"bc7",   VK_FORMAT_BC7_SRGB_BLOCK},
+            {"rgba8", VK_FORMAT_R8G8B8A8_SRGB},
+    };
+    auto formatIter = formats.find(argv[1]);
+    if (formatIter == formats.end()) {
+        LOG_ERROR("Unknown texture format {}", argv[1]);
+        return EXIT_FAILURE;
+    }
+    VkFormat format = formatIter->second;
+    std::string sourceFileName{argv[2]};
+    std::string cookedFileName = argc > 3 ? std::string{argv[3]} : sourceFileName + rn::COOKED_TEXTURE_EXTENSION;
+
+    std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+    int width, height, channels;
+    stbi_uc *imageData = stbi_load(sourceFileName.c_str(), &width, &height, &channels, STBI_rgb_alpha);
+    if (imageData == nullptr) {
+        LOG_ERROR("Failed to load the source image {}", sourceFileName);
+        return EXIT_FAILURE;
+    }
+    std::uint32_t levelCount = rn::Utility::GetMipLevelCount(width, height);
+    // BC5 holds data, not color, so its levels are filtered without the sRGB conversion.
+    bool srgb = format != VK_FORMAT_BC5_UNORM_BLOCK;
+
+    rn::List<rn::List<std::uint8_t>> levels(levelCount);
+    rn::List<std::uint8_t> previous(imageData, imageData + static_cast<size_t>(width) * height * 4);
+    rn::List<std::uint8_t> current{};
+    stbi_image_free(imageData);
+    VkDeviceSize sourceBytes = 0;
+    for (std::uint32_t level = 0; level < levelCount; level++) {
+        std::uint32_t levelWidth = std::max(static_cast<std::uint32_t>(width) >> level, 1u);
+        std::uint32_t levelHeight = std::max(static_cast<std::uint32_t>(height) >> level, 1u);
+        if (level > 0) {
+            std::uint32_t previousWidth = std::max(static_cast<std::uint32_t>(width) >> (level - 1), 1u);
+            std::uint32_t previousHeight = std::max(static_cast<std::uint32_t>(height) >> (level - 1), 1u);
+            current.resize(static_cast<size_t>(levelWidth) * levelHeight * 4);
+            if (srgb) {
+                stbir_resize_uint8_srgb(previous.data(), previousWidth, previousHeight, 0, current.data(), levelWidth,
+                                        levelHeight, 0, STBIR_RGBA);
+            } else {
+                stbir_resize_uint8_linear(previous.data(), previousWidth, previousHeight, 0, current.data(),
+                                          levelWidth, levelHeight, 0, STBIR_RGBA);
+            }
+            previous.swap(current);
+        }
+        sourceBytes += previous.size();
+        if (rn::BlockCompression::IsBlockCompressed(format)) {
+            levels[level].resize(rn::Utility::GetImageLevelSize(format, width, height, level));
+            rn::BlockCompression::CompressLevel(format, previous.data(), levelWidth, levelHeight,
+                                                levels[level].data());
+        } else {
+            levels[level] = previous;
+        }
+    }
+    if (!rn::CookedTexture::Write(cookedFileName, format, width, height, levels)) {
+        return EXIT_FAILURE;
+    }
+
+    VkDeviceSize cookedBytes = 0;
+    for (const rn::List<std::uint8_t> &level: levels) {
+        cookedBytes += level.size();
+    }
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+    LOG_INFO("Cooked {} : {}x{}, {} levels, {:.2f} MB as RGBA8, {:.2f} MB as {}, {:.1f} ms", cookedFileName, width,
+             height, levelCount, sourceBytes / (1024.0 * 1024.0), cookedBytes / (1024.0 * 1024.0), argv[1],
+             elapsed.count());
+    return EXIT_SUCCESS;
+}